@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+// Timings of the animation code paths whose speed a change claims, printed
+// for a person to compare. Not registered with CTest, run it by hand from a
+// release build.
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Model/AnimationBatch.h"
+#include "Model/Bone.h"
+#include "SwingClip.h"
+
+using namespace std;
+using namespace model;
+
+namespace {
+constexpr int kBoneCount = 64;
+constexpr int kKeyCount = 240;
+
+double Milliseconds(chrono::steady_clock::duration time) {
+  return chrono::duration<double, milli>(time).count();
+}
+
+// Animators that start at different times, like a crowd.
+vector<unique_ptr<Animator>> MakeCrowd(
+    const shared_ptr<const Animation>& clip, int count) {
+  vector<unique_ptr<Animator>> crowd;
+  for (int i = 0; i < count; ++i) {
+    crowd.push_back(make_unique<Animator>(clip));
+    crowd.back()->UpdateAnimation(i * 0.013);
+  }
+  return crowd;
+}
+
+// Parallel updates at 1, 100 and 1000 instances against a serial loop.
+bool BenchmarkCrowd() {
+  const int kFrames = 20;
+  auto clip = MakeSwingClip(kBoneCount, kKeyCount, 0.0f);
+  cout << "Crowd update, " << JobSystem::GetInstance().GetWorkerCount()
+       << " workers" << endl;
+  bool matches = true;
+  for (int count : {1, 100, 1000}) {
+    auto serial = MakeCrowd(clip, count);
+    auto parallel = MakeCrowd(clip, count);
+    vector<Animator*> animators;
+    for (const auto& animator : parallel) {
+      animators.push_back(animator.get());
+    }
+
+    auto start = chrono::steady_clock::now();
+    for (int frame = 0; frame < kFrames; ++frame) {
+      for (auto& animator : serial) {
+        animator->UpdateAnimation(0.016);
+      }
+    }
+    auto serial_time = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    for (int frame = 0; frame < kFrames; ++frame) {
+      AnimationBatch::Update(animators, 0.016);
+    }
+    auto parallel_time = chrono::steady_clock::now() - start;
+
+    for (int i = 0; i < count; ++i) {
+      matches &= serial[i]->GetFinalBoneMatrices() ==
+                 parallel[i]->GetFinalBoneMatrices();
+    }
+    cout << "  " << count << " instances, per frame: serial "
+         << Milliseconds(serial_time) / kFrames << " ms, parallel "
+         << Milliseconds(parallel_time) / kFrames << " ms" << endl;
+  }
+  return matches;
+}
+
+// The lookup Bone used before it cached cursors.
+int LinearIndex(const vector<Bone::KeyPosition>& keys, double time) {
+  for (int index = 0; index < static_cast<int>(keys.size()) - 1; ++index) {
+    if (time < keys[index + 1].time_stamp) {
+      return index;
+    }
+  }
+  return static_cast<int>(keys.size()) - 2;
+}
+
+// Sequential playback of a long clip, key cursors against a linear scan.
+bool BenchmarkLongClip() {
+  const int kLongKeyCount = 4000;
+  const int kSamples = 20000;
+  vector<Bone::KeyPosition> positions;
+  vector<Bone::KeyRotation> rotations;
+  vector<Bone::KeyScale> scales;
+  for (int i = 0; i < kLongKeyCount; ++i) {
+    positions.push_back({glm::vec3(static_cast<float>(i), 0.0f, 0.0f),
+                         static_cast<double>(i)});
+    rotations.push_back({glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                         static_cast<double>(i)});
+    scales.push_back({glm::vec3(1.0f), static_cast<double>(i)});
+  }
+  // Keeps every key, so key indices match the source keys.
+  KeyframeCompression::Settings keep_all_keys;
+  keep_all_keys.position_tolerance = -1.0f;
+  keep_all_keys.rotation_tolerance = -1.0f;
+  keep_all_keys.scale_tolerance = -1.0f;
+  Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  const double step = (kLongKeyCount - 1.0) / kSamples;
+
+  Bone::Cursor cursor;
+  long long cursor_sum = 0;
+  auto start = chrono::steady_clock::now();
+  for (int i = 0; i < kSamples; ++i) {
+    cursor_sum += bone.GetPositionsIndex(i * step, cursor);
+  }
+  auto cursor_time = chrono::steady_clock::now() - start;
+
+  long long linear_sum = 0;
+  start = chrono::steady_clock::now();
+  for (int i = 0; i < kSamples; ++i) {
+    linear_sum += LinearIndex(positions, i * step);
+  }
+  auto linear_time = chrono::steady_clock::now() - start;
+
+  cout << "Key lookup, " << kSamples << " samples of " << kLongKeyCount
+       << " keys: cursor " << Milliseconds(cursor_time)
+       << " ms, linear scan " << Milliseconds(linear_time) << " ms" << endl;
+  return cursor_sum == linear_sum;
+}
+}  // namespace
+
+int main() {
+  bool matches = BenchmarkCrowd();
+  matches &= BenchmarkLongClip();
+  if (!matches) {
+    cerr << "The timed code paths disagree, the timings are void." << endl;
+    return 1;
+  }
+  return 0;
+}
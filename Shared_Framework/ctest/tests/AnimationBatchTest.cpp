@@ -0,0 +1,92 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/AnimationBatch.h"
+#include "SwingClip.h"
+
+using namespace std;
+using namespace model;
+
+class AnimationBatchTest : public ::testing::Test {
+ protected:
+  static constexpr int kBoneCount = 64;
+  static constexpr int kKeyCount = 240;
+
+  shared_ptr<const Animation> clip;
+
+  void SetUp() override {
+    clip = MakeSwingClip(kBoneCount, kKeyCount, 0.0f);
+  }
+
+  // Animators that start at different times, like a crowd.
+  vector<unique_ptr<Animator>> MakeCrowd(int count) {
+    vector<unique_ptr<Animator>> crowd;
+    for (int i = 0; i < count; ++i) {
+      crowd.push_back(make_unique<Animator>(clip));
+      crowd.back()->UpdateAnimation(i * 0.013);
+    }
+    return crowd;
+  }
+
+  static vector<Animator*> Pointers(const vector<unique_ptr<Animator>>& crowd) {
+    vector<Animator*> pointers;
+    for (const auto& animator : crowd) {
+      pointers.push_back(animator.get());
+    }
+    return pointers;
+  }
+};
+
+// The batch writes the same palettes as the animators hold
+TEST_F(AnimationBatchTest, WritesPalettes) {
+  auto crowd = MakeCrowd(37);
+  auto animators = Pointers(crowd);
+  vector<glm::uint32> offsets;
+  EXPECT_EQ(AnimationBatch::GetPaletteOffsets(animators, offsets),
+            37u * kBoneCount);
+  vector<glm::mat4> palettes(37 * kBoneCount);
+
+  AnimationBatch::Update(animators, 0.016, offsets,
+                         reinterpret_cast<glm::vec4*>(palettes.data()),
+                         PaletteFormat::kMatrix4x4, 4);
+  for (size_t i = 0; i < crowd.size(); ++i) {
+    const auto& matrices = crowd[i]->GetFinalBoneMatrices();
+    for (size_t bone = 0; bone < matrices.size(); ++bone) {
+      EXPECT_EQ(palettes[offsets[i] + bone], matrices[bone]);
+    }
+  }
+}
+
+// Parallel updates of a crowd match a serial loop over the same animators
+TEST_F(AnimationBatchTest, ParallelUpdatesMatchSerial) {
+  auto serial = MakeCrowd(100);
+  auto parallel = MakeCrowd(100);
+  auto animators = Pointers(parallel);
+  for (int frame = 0; frame < 20; ++frame) {
+    for (auto& animator : serial) {
+      animator->UpdateAnimation(0.016);
+    }
+    AnimationBatch::Update(animators, 0.016);
+  }
+  for (size_t i = 0; i < serial.size(); ++i) {
+    EXPECT_EQ(serial[i]->GetFinalBoneMatrices(),
+              parallel[i]->GetFinalBoneMatrices());
+  }
+}
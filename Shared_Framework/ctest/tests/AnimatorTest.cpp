@@ -0,0 +1,320 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/AnimationBatch.h"
+#include "Model/Animator.h"
+#include "Model/ModelException.h"
+#include "SwingClip.h"
+
+using namespace std;
+using namespace model;
+
+class AnimatorTest : public ::testing::Test {
+ protected:
+  static constexpr int kBoneCount = 64;
+  static constexpr int kKeyCount = 240;
+
+  shared_ptr<const Animation> clip;
+
+  void SetUp() override {
+    clip = MakeSwingClip(kBoneCount, kKeyCount, 0.0f);
+  }
+
+  // A clip on the same skeleton, swinging out of phase with the first.
+  static shared_ptr<const Animation> MakeOtherClip() {
+    return MakeSwingClip(kBoneCount, kKeyCount, 1.0f);
+  }
+};
+
+// 3x4 matrices and dual quaternions move a point like the full matrix
+TEST_F(AnimatorTest, CompactPalettesMatchMatrices) {
+  const glm::vec3 point(0.3f, -0.7f, 1.1f);
+  vector<glm::vec4> rows(kBoneCount * 3);
+  vector<glm::vec4> dual_quaternions(kBoneCount * 2);
+  for (double time : {0.0, 0.013, 0.026}) {
+    Animator animator(clip);
+    animator.UpdateAnimation(time);
+    animator.WritePalette(rows.data(), PaletteFormat::kMatrix3x4);
+    animator.WritePalette(dual_quaternions.data(),
+                          PaletteFormat::kDualQuaternion);
+    const auto& matrices = animator.GetFinalBoneMatrices();
+    for (int bone = 0; bone < kBoneCount; ++bone) {
+      glm::vec3 expected = matrices[bone] * glm::vec4(point, 1.0f);
+      // The same arithmetic as animation_model_3x4.vert.
+      const glm::vec4* row = &rows[bone * 3];
+      glm::vec4 local(point, 1.0f);
+      glm::vec3 from_rows(glm::dot(row[0], local), glm::dot(row[1], local),
+                          glm::dot(row[2], local));
+      // The same arithmetic as animation_model_dq.vert.
+      glm::vec4 real = dual_quaternions[bone * 2];
+      glm::vec4 dual = dual_quaternions[bone * 2 + 1];
+      glm::vec3 axis(real);
+      glm::vec3 translation =
+          2.0f * (real.w * glm::vec3(dual) - dual.w * axis +
+                  glm::cross(axis, glm::vec3(dual)));
+      glm::vec3 from_dual_quaternion =
+          point +
+          2.0f * glm::cross(axis, glm::cross(axis, point) + real.w * point) +
+          translation;
+      for (int axis_index = 0; axis_index < 3; ++axis_index) {
+        float tolerance = 1e-4f * (1.0f + abs(expected[axis_index]));
+        EXPECT_NEAR(from_rows[axis_index], expected[axis_index], tolerance);
+        EXPECT_NEAR(from_dual_quaternion[axis_index], expected[axis_index],
+                    tolerance);
+      }
+    }
+  }
+}
+
+// Hidden animators keep time, reduced rates and leaf skips sample less
+TEST_F(AnimatorTest, LevelOfDetailSamplesLess) {
+  Animator reference(clip);
+  Animator hidden(clip);
+  Animator reduced(clip);
+  Animator leafless(clip);
+  AnimationLod lod;
+  lod.visible = false;
+  hidden.SetLod(lod);
+  lod = AnimationLod();
+  lod.update_interval = 2;
+  reduced.SetLod(lod);
+  lod = AnimationLod();
+  lod.skipped_leaf_levels = 1;
+  leafless.SetLod(lod);
+
+  vector<Animator*> animators{&reference, &hidden, &reduced, &leafless};
+  glm::uint32 reduced_samples = 0;
+  for (int frame = 0; frame < 10; ++frame) {
+    AnimationBatch::Update(animators, 0.016);
+    EXPECT_EQ(reference.GetEvaluatedBoneCount(), kBoneCount);
+    EXPECT_EQ(hidden.GetEvaluatedBoneCount(), 0u);
+    reduced_samples += reduced.GetEvaluatedBoneCount();
+  }
+  // The first update samples, then every second one.
+  EXPECT_EQ(reduced_samples, 5u * kBoneCount + kBoneCount);
+  // Half the nodes of the binary tree are leaves.
+  EXPECT_EQ(leafless.GetEvaluatedBoneCount(), kBoneCount / 2u);
+  EXPECT_EQ(AnimationBatch::GetEvaluatedBoneCount(animators),
+            kBoneCount + kBoneCount / 2u + reduced.GetEvaluatedBoneCount());
+
+  // Shown again, the hidden animator samples at the time it kept.
+  hidden.SetLod(AnimationLod());
+  reference.UpdateAnimation(0.016);
+  hidden.UpdateAnimation(0.016);
+  EXPECT_EQ(hidden.GetFinalBoneMatrices(), reference.GetFinalBoneMatrices());
+
+  AnimationLodPolicy policy;
+  EXPECT_EQ(policy.Select(5.0f, true).update_interval, 1u);
+  EXPECT_EQ(policy.Select(15.0f, true).update_interval, 2u);
+  EXPECT_EQ(policy.Select(100.0f, true).update_interval,
+            policy.max_update_interval);
+  EXPECT_EQ(policy.Select(100.0f, true).skipped_leaf_levels,
+            policy.skipped_leaf_levels);
+  EXPECT_FALSE(policy.Select(1.0f, false).visible);
+}
+
+// Updates between two samples blend the local transforms: every bone stays
+// rigid and the root lies between the two sampled poses
+TEST_F(AnimatorTest, ReducedRateStaysRigid) {
+  Animator reference(clip);
+  Animator reduced(clip);
+  AnimationLod lod;
+  lod.update_interval = 2;
+  reduced.SetLod(lod);
+  reference.UpdateAnimation(0.5);
+  reduced.UpdateAnimation(0.5);
+  const vector<glm::mat4> start = reference.GetFinalBoneMatrices();
+  EXPECT_EQ(reduced.GetFinalBoneMatrices(), start);
+
+  reference.UpdateAnimation(0.5);
+  reduced.UpdateAnimation(0.5);
+  const vector<glm::mat4> target = reference.GetFinalBoneMatrices();
+  const vector<glm::mat4> between = reduced.GetFinalBoneMatrices();
+  for (const auto& matrix : between) {
+    glm::mat3 rotation(matrix);
+    for (int axis = 0; axis < 3; ++axis) {
+      EXPECT_NEAR(glm::length(rotation[axis]), 1.0f, 1e-4f);
+      EXPECT_NEAR(glm::dot(rotation[axis], rotation[(axis + 1) % 3]), 0.0f,
+                  1e-4f);
+    }
+  }
+  // The root has no parent, its transform is the blend itself.
+  auto angle = [](const glm::mat4& a, const glm::mat4& b) {
+    float cosine = abs(glm::dot(glm::quat_cast(glm::mat3(a)),
+                                glm::quat_cast(glm::mat3(b))));
+    return 2.0f * acos(min(cosine, 1.0f));
+  };
+  const float arc = angle(start[0], target[0]);
+  EXPECT_GT(arc, 0.1f);
+  EXPECT_LT(angle(start[0], between[0]), arc);
+  EXPECT_LT(angle(between[0], target[0]), arc);
+  EXPECT_NEAR(angle(start[0], between[0]) + angle(between[0], target[0]),
+              arc, 1e-3f);
+  EXPECT_LT(glm::distance(glm::vec3(between[0][3]),
+                          0.5f * glm::vec3(start[0][3] + target[0][3])),
+            1e-4f);
+
+  // The next update reaches the target, one interval behind.
+  reduced.UpdateAnimation(0.5);
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(reduced.GetFinalBoneMatrices()[bone],
+                            target[bone]),
+              1e-4f);
+  }
+}
+
+// A cross fade starts at the old clip and ends at the new one
+TEST_F(AnimatorTest, CrossFadeReachesNewClip) {
+  auto other = MakeOtherClip();
+  Animator animator(clip);
+  Animator old_clip(clip);
+  Animator new_clip(other);
+  animator.UpdateAnimation(0.1);
+  old_clip.UpdateAnimation(0.1);
+
+  animator.CrossFade(other, 0.5);
+  animator.UpdateAnimation(0.0);
+  old_clip.UpdateAnimation(0.0);
+  EXPECT_TRUE(animator.IsFading());
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            old_clip.GetFinalBoneMatrices()[bone]),
+              1e-4f);
+  }
+
+  animator.UpdateAnimation(0.6);
+  new_clip.UpdateAnimation(0.6);
+  EXPECT_FALSE(animator.IsFading());
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            new_clip.GetFinalBoneMatrices()[bone]),
+              1e-4f);
+  }
+}
+
+// A fade started during a fade starts from the pose on screen
+TEST_F(AnimatorTest, CrossFadeDuringFadeKeepsPose) {
+  Animator animator(clip);
+  animator.UpdateAnimation(0.1);
+  animator.CrossFade(MakeOtherClip(), 0.5);
+  animator.UpdateAnimation(0.2);
+  const vector<glm::mat4> shown = animator.GetFinalBoneMatrices();
+
+  auto third = MakeSwingClip(kBoneCount, kKeyCount, 2.0f);
+  animator.CrossFade(third, 0.5);
+  animator.UpdateAnimation(0.0);
+  EXPECT_TRUE(animator.IsFading());
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            shown[bone]),
+              1e-4f);
+  }
+
+  Animator new_clip(third);
+  animator.UpdateAnimation(0.6);
+  new_clip.UpdateAnimation(0.6);
+  EXPECT_FALSE(animator.IsFading());
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            new_clip.GetFinalBoneMatrices()[bone]),
+              1e-4f);
+  }
+}
+
+// A clip with as many nodes but another hierarchy is not blended
+TEST_F(AnimatorTest, OtherHierarchyIsNotBlended) {
+  auto other = MakeSwingClip(kBoneCount, kKeyCount, 1.0f, 3);
+  EXPECT_FALSE(other->SharesSkeleton(*clip));
+  EXPECT_TRUE(MakeOtherClip()->SharesSkeleton(*clip));
+
+  Animator animator(clip);
+  AnimationLayer layer;
+  layer.animation = other;
+  EXPECT_THROW(animator.AddLayer(layer), ModelException);
+  animator.CrossFade(other, 0.5);
+  EXPECT_FALSE(animator.IsFading());
+  EXPECT_EQ(animator.GetAnimation(), other);
+}
+
+// A masked layer only moves the nodes below its mask
+TEST_F(AnimatorTest, MaskedLayerKeepsOtherNodes) {
+  auto other = MakeOtherClip();
+  Animator animator(clip);
+  Animator base(clip);
+  Animator layer_clip(other);
+  AnimationLayer layer;
+  layer.animation = other;
+  layer.mask = clip->GetNodeMask("bone1");
+  auto index = animator.AddLayer(layer);
+  animator.UpdateAnimation(0.2);
+  base.UpdateAnimation(0.2);
+  layer_clip.UpdateAnimation(0.2);
+
+  const auto& skeleton = clip->GetSkeleton();
+  const auto& blended = animator.GetFinalBoneMatrices();
+  for (size_t i = 0; i < skeleton.size(); ++i) {
+    if (layer.mask[i] == 0.0f) {
+      EXPECT_LT(MaxDifference(blended[skeleton[i].bone_id],
+                              base.GetFinalBoneMatrices()[skeleton[i].bone_id]),
+                1e-4f);
+    }
+  }
+  // bone1 takes its local transform from the layer, under the base bone0.
+  const auto& layer_bones = layer_clip.GetFinalBoneMatrices();
+  glm::mat4 expected = base.GetFinalBoneMatrices()[0] *
+                       glm::inverse(layer_bones[0]) * layer_bones[1];
+  EXPECT_LT(MaxDifference(blended[1], expected), 1e-4f);
+
+  // A layer without weight leaves the base pose.
+  animator.SetLayerWeight(index, 0.0f);
+  animator.UpdateAnimation(0.1);
+  base.UpdateAnimation(0.1);
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            base.GetFinalBoneMatrices()[bone]),
+              1e-4f);
+  }
+
+  layer.mask.pop_back();
+  EXPECT_THROW(animator.AddLayer(layer), ModelException);
+}
+
+// An additive clip at its reference frame adds nothing
+TEST_F(AnimatorTest, AdditiveLayerAddsDifference) {
+  Animator animator(clip);
+  Animator base(clip);
+  AnimationLayer layer;
+  layer.animation = MakeOtherClip();
+  layer.blend = LayerBlend::kAdditive;
+  animator.AddLayer(layer);
+  animator.UpdateAnimation(0.0);
+  base.UpdateAnimation(0.0);
+  for (int bone = 0; bone < kBoneCount; ++bone) {
+    EXPECT_LT(MaxDifference(animator.GetFinalBoneMatrices()[bone],
+                            base.GetFinalBoneMatrices()[bone]),
+              1e-4f);
+  }
+
+  // Later frames do add their difference.
+  animator.UpdateAnimation(0.3);
+  base.UpdateAnimation(0.3);
+  EXPECT_GT(MaxDifference(animator.GetFinalBoneMatrices()[kBoneCount - 1],
+                          base.GetFinalBoneMatrices()[kBoneCount - 1]),
+            1e-3f);
+}
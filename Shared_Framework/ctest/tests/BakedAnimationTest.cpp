@@ -0,0 +1,63 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/Animator.h"
+#include "Model/BakedAnimation.h"
+#include "SwingClip.h"
+
+using namespace std;
+using namespace model;
+
+class BakedAnimationTest : public ::testing::Test {
+ protected:
+  static constexpr int kBoneCount = 64;
+  static constexpr int kKeyCount = 240;
+
+  shared_ptr<const Animation> clip;
+
+  void SetUp() override {
+    clip = MakeSwingClip(kBoneCount, kKeyCount, 0.0f);
+  }
+};
+
+// Every baked frame holds the pose of the clip at that frame's time
+TEST_F(BakedAnimationTest, BakesWholeLoop) {
+  vector<glm::vec4> texels;
+  glm::float32 frame_rate = 0.0f;
+  glm::uint32 frames = BakedAnimation::Bake(clip, 24.0f, texels, frame_rate);
+  const double seconds = clip->GetDuration() / clip->GetTicksPerSecond();
+  EXPECT_EQ(frames, static_cast<glm::uint32>(round(seconds * 24.0)));
+  EXPECT_NEAR(frames / frame_rate, seconds, 1e-4);
+  const size_t row = kBoneCount * BakedAnimation::kTexelsPerBone;
+  ASSERT_EQ(texels.size(), frames * row);
+
+  vector<glm::vec4> expected(row);
+  for (glm::uint32 frame : {0u, 1u, frames / 2, frames - 1}) {
+    Animator animator(clip);
+    animator.UpdateAnimation(frame / static_cast<double>(frame_rate));
+    animator.WritePalette(expected.data(), PaletteFormat::kMatrix3x4);
+    for (size_t texel = 0; texel < row; ++texel) {
+      for (int component = 0; component < 4; ++component) {
+        EXPECT_NEAR(texels[frame * row + texel][component],
+                    expected[texel][component], 1e-3f);
+      }
+    }
+  }
+}
@@ -0,0 +1,124 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/Bone.h"
+
+using namespace std;
+using namespace model;
+
+class BoneTest : public ::testing::Test {
+ protected:
+  static constexpr int kKeyCount = 4000;
+
+  vector<Bone::KeyPosition> positions;
+  vector<Bone::KeyRotation> rotations;
+  vector<Bone::KeyScale> scales;
+  // Keeps every key, so key indices match the source keys.
+  KeyframeCompression::Settings keep_all_keys;
+  // Largest error of a position quantized over the range of the track.
+  const float quantization_error = (kKeyCount - 1) / 65535.0f;
+
+  // One key per tick, moving one unit along X per tick.
+  void SetUp() override {
+    keep_all_keys.position_tolerance = -1.0f;
+    keep_all_keys.rotation_tolerance = -1.0f;
+    keep_all_keys.scale_tolerance = -1.0f;
+    for (int i = 0; i < kKeyCount; ++i) {
+      positions.push_back({glm::vec3(static_cast<float>(i), 0.0f, 0.0f),
+                           static_cast<double>(i)});
+      rotations.push_back({glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                           static_cast<double>(i)});
+      scales.push_back({glm::vec3(1.0f), static_cast<double>(i)});
+    }
+  }
+
+  // The lookup Bone used before it cached cursors.
+  static int LinearIndex(const vector<Bone::KeyPosition>& keys, double time) {
+    for (int index = 0; index < static_cast<int>(keys.size()) - 1; ++index) {
+      if (time < keys[index + 1].time_stamp) {
+        return index;
+      }
+    }
+    return static_cast<int>(keys.size()) - 2;
+  }
+};
+
+// Interpolates between the two keys around the time
+TEST_F(BoneTest, InterpolatesBetweenKeys) {
+  Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  Bone::Cursor cursor;
+  EXPECT_NEAR(bone.Sample(10.25, cursor)[3].x, 10.25f, quantization_error);
+  EXPECT_NEAR(bone.Sample(10.75, cursor)[3].x, 10.75f, quantization_error);
+}
+
+// Times outside the track clamp to the first and last key
+TEST_F(BoneTest, ClampsOutsideTheTrack) {
+  Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  Bone::Cursor cursor;
+  EXPECT_NEAR(bone.Sample(-5.0, cursor)[3].x, 0.0f, quantization_error);
+  EXPECT_NEAR(bone.Sample(kKeyCount + 5.0, cursor)[3].x, kKeyCount - 1.0f,
+              quantization_error);
+  EXPECT_EQ(bone.GetPositionsIndex(kKeyCount + 5.0, cursor), kKeyCount - 2);
+}
+
+// Forward playback, seeks and loops all agree with a linear scan
+TEST_F(BoneTest, CursorMatchesLinearScan) {
+  Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  vector<double> times;
+  for (double time = 0.0; time < kKeyCount; time += 0.3) {
+    times.push_back(time);
+  }
+  // A loop back to the start and a few seeks in both directions.
+  times.insert(times.end(), {0.5, 2500.2, 12.0, 3998.9, 1.0, 1.0, 1.5});
+  Bone::Cursor cursor;
+  for (double time : times) {
+    EXPECT_EQ(bone.GetPositionsIndex(time, cursor),
+              LinearIndex(positions, time))
+        << "time " << time;
+  }
+}
+
+// Sequential playback of a long clip agrees with a linear scan
+TEST_F(BoneTest, LongClipMatchesLinearScan) {
+  Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  const int kSamples = 20000;
+  const double step = (kKeyCount - 1.0) / kSamples;
+
+  Bone::Cursor cursor;
+  long long cursor_sum = 0;
+  long long linear_sum = 0;
+  for (int i = 0; i < kSamples; ++i) {
+    cursor_sum += bone.GetPositionsIndex(i * step, cursor);
+    linear_sum += LinearIndex(positions, i * step);
+  }
+  EXPECT_EQ(cursor_sum, linear_sum);
+}
+
+// Two players of one bone keep separate cursors and see their own time
+TEST_F(BoneTest, SharedBoneKeepsPlayersApart) {
+  const Bone bone("bone", 0, positions, rotations, scales, keep_all_keys);
+  Bone::Cursor first;
+  Bone::Cursor second;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_NEAR(bone.Sample(i + 0.5, first)[3].x, i + 0.5f,
+                quantization_error);
+    EXPECT_NEAR(bone.Sample(3000.0 - i, second)[3].x, 3000.0f - i,
+                quantization_error);
+  }
+}
@@ -0,0 +1,60 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "FrameArena.h"
+
+using namespace std;
+
+class FrameArenaTest : public ::testing::Test {
+ protected:
+  FrameArena& arena = FrameArena::GetInstance();
+
+  void SetUp() override {
+    arena.Reset();
+  }
+};
+
+// Allocations keep the requested alignment
+TEST_F(FrameArenaTest, AlignsAllocations) {
+  for (size_t alignment : {1u, 4u, 16u, 64u, 256u}) {
+    arena.Allocate(3, 1);
+    auto address = reinterpret_cast<uintptr_t>(arena.Allocate(8, alignment));
+    EXPECT_EQ(address % alignment, 0u) << "alignment " << alignment;
+  }
+  EXPECT_EQ(arena.GetFrameStats().allocation_count, 10u);
+}
+
+// A frame larger than the buffer uses the heap once, then fits
+TEST_F(FrameArenaTest, GrowsToThePeakFrame) {
+  const size_t count = FrameArena::kDefaultCapacity / sizeof(float) + 1000;
+  for (int frame = 0; frame < 2; ++frame) {
+    FrameVector<float> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      values.push_back(static_cast<float>(i));
+    }
+    EXPECT_EQ(values[count - 1], static_cast<float>(count - 1));
+    arena.Reset();
+    EXPECT_EQ(arena.GetLastFrameStats().heap_allocation_count,
+              frame == 0 ? 1u : 0u);
+  }
+  EXPECT_GE(arena.GetCapacity(), count * sizeof(float));
+  EXPECT_EQ(arena.GetFrameStats().used_bytes, 0u);
+}
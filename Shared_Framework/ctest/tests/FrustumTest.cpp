@@ -0,0 +1,88 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Camera.h"
+#include "Frustum.h"
+
+using namespace std;
+
+class FrustumTest : public ::testing::Test {
+ protected:
+  Frustum frustum;
+
+  // A camera at the origin looking down -Z with a 90 degree field of view.
+  void SetUp() override {
+    glm::mat4 projection =
+        glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    frustum.Update(projection);
+  }
+};
+
+// Test spheres inside, outside and straddling the planes
+TEST_F(FrustumTest, IntersectsSphere) {
+  EXPECT_TRUE(frustum.IntersectsSphere(glm::vec3(0.0f, 0.0f, -10.0f), 1.0f));
+  EXPECT_FALSE(frustum.IntersectsSphere(glm::vec3(0.0f, 0.0f, 10.0f), 1.0f));
+  EXPECT_FALSE(
+      frustum.IntersectsSphere(glm::vec3(0.0f, 0.0f, -200.0f), 1.0f));
+  EXPECT_FALSE(frustum.IntersectsSphere(glm::vec3(30.0f, 0.0f, -10.0f), 1.0f));
+  // Crosses the right plane
+  EXPECT_TRUE(frustum.IntersectsSphere(glm::vec3(11.0f, 0.0f, -10.0f), 1.0f));
+}
+
+// Test boxes against the planes
+TEST_F(FrustumTest, IntersectsBox) {
+  EXPECT_TRUE(frustum.IntersectsBox(glm::vec3(-1.0f, -1.0f, -11.0f),
+                                    glm::vec3(1.0f, 1.0f, -9.0f)));
+  EXPECT_FALSE(frustum.IntersectsBox(glm::vec3(-1.0f, -1.0f, 9.0f),
+                                     glm::vec3(1.0f, 1.0f, 11.0f)));
+}
+
+// The batch test must agree with the single sphere test, including the tail
+// that does not fill a whole SIMD batch
+TEST_F(FrustumTest, CullSpheresMatchesSingleTest) {
+  vector<glm::vec4> spheres;
+  for (int i = 0; i < 23; ++i) {
+    spheres.emplace_back(static_cast<float>(i * 3 - 30), 0.0f,
+                         static_cast<float>(-i * 2), 0.5f + i * 0.1f);
+  }
+  vector<glm::uint8> visible(spheres.size(), 2);
+  size_t count =
+      frustum.CullSpheres(spheres.data(), spheres.size(), visible.data());
+
+  size_t expected_count = 0;
+  for (size_t i = 0; i < spheres.size(); ++i) {
+    bool expected =
+        frustum.IntersectsSphere(glm::vec3(spheres[i]), spheres[i].w);
+    EXPECT_EQ(visible[i], expected ? 1 : 0) << "sphere " << i;
+    expected_count += expected ? 1 : 0;
+  }
+  EXPECT_EQ(count, expected_count);
+  EXPECT_GT(count, 0u);
+  EXPECT_LT(count, spheres.size());
+}
+
+// The camera frustum follows the camera position and orientation
+TEST_F(FrustumTest, CameraFrustum) {
+  Camera camera(glm::vec3(0.0f, 0.0f, 50.0f));
+  Frustum camera_frustum = camera.GetFrustum(800.0f, 600.0f);
+  glm::vec3 ahead = camera.GetPosition() + camera.GetFront() * 10.0f;
+  glm::vec3 behind = camera.GetPosition() - camera.GetFront() * 10.0f;
+  EXPECT_TRUE(camera_frustum.IntersectsSphere(ahead, 1.0f));
+  EXPECT_FALSE(camera_frustum.IntersectsSphere(behind, 1.0f));
+}
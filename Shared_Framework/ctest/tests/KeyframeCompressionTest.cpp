@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/KeyframeCompression.h"
+
+using namespace std;
+using namespace model;
+
+class KeyframeCompressionTest : public ::testing::Test {
+ protected:
+  vector<glm::float64> times;
+
+  void SetUp() override {
+    for (int i = 0; i < 200; ++i) {
+      times.push_back(static_cast<double>(i));
+    }
+  }
+
+  // Rotation angle between two quaternions. acos of their dot product has
+  // no precision left for small angles, atan2 of the chords does.
+  static double Angle(const glm::quat& a, const glm::quat& b) {
+    glm::dvec4 u(a.x, a.y, a.z, a.w);
+    glm::dvec4 v(b.x, b.y, b.z, b.w);
+    if (glm::dot(u, v) < 0.0) {
+      v = -v;
+    }
+    return 4.0 * atan2(glm::length(u - v), glm::length(u + v));
+  }
+};
+
+// Smallest three keeps rotations within a fraction of a milliradian
+TEST_F(KeyframeCompressionTest, PackRotationRoundTrip) {
+  for (int i = 0; i < 500; ++i) {
+    glm::vec3 axis = glm::normalize(
+        glm::vec3(sin(i * 1.3f), cos(i * 0.7f), sin(i * 2.1f) + 0.1f));
+    glm::quat rotation = glm::angleAxis(i * 0.037f - 9.0f, axis);
+    glm::quat unpacked = KeyframeCompression::UnpackRotation(
+        KeyframeCompression::PackRotation(rotation));
+    EXPECT_NEAR(glm::length(unpacked), 1.0f, 1e-4f);
+    EXPECT_LT(Angle(rotation, unpacked), 2e-4f) << "rotation " << i;
+  }
+}
+
+// A straight line reduces to its end points, a constant track to one key
+TEST_F(KeyframeCompressionTest, ReducesRedundantKeys) {
+  vector<glm::vec3> line;
+  vector<glm::vec3> constant;
+  for (double time : times) {
+    line.emplace_back(time * 0.5, 1.0, -time);
+    constant.emplace_back(1.0f);
+  }
+  auto line_track = KeyframeCompression::CompressVectors(times, line, 1e-3f);
+  EXPECT_EQ(line_track.times.size(), 2u);
+  auto constant_track =
+      KeyframeCompression::CompressVectors(times, constant, 1e-3f);
+  ASSERT_EQ(constant_track.times.size(), 1u);
+  glm::uint32 cursor = 0;
+  glm::vec3 value =
+      KeyframeCompression::Sample(constant_track, 57.0, cursor);
+  EXPECT_FLOAT_EQ(value.x, 1.0f);
+}
+
+// Curved tracks keep enough keys to stay within the tolerance
+TEST_F(KeyframeCompressionTest, ErrorStaysWithinTolerance) {
+  vector<glm::vec3> positions;
+  vector<glm::quat> rotations;
+  for (double time : times) {
+    positions.emplace_back(sin(time * 0.1) * 2.0, cos(time * 0.05), 0.0);
+    rotations.push_back(
+        glm::angleAxis(static_cast<float>(sin(time * 0.07)),
+                       glm::vec3(0.0f, 1.0f, 0.0f)));
+  }
+  const float tolerance = 1e-3f;
+  KeyframeCompression::Report report;
+  float position_error = -1.0f;
+  float rotation_error = -1.0f;
+  KeyframeCompression::CompressVectors(times, positions, tolerance, &report,
+                                       &position_error);
+  KeyframeCompression::CompressRotations(times, rotations, tolerance, &report,
+                                         &rotation_error);
+
+  // Quantization adds at most half a step on top of the reduction error.
+  EXPECT_LE(position_error, tolerance + 4.0f / 65535.0f);
+  EXPECT_LE(rotation_error, tolerance + 2e-4f);
+  EXPECT_EQ(report.source_keys, 2 * times.size());
+  EXPECT_LT(report.stored_keys, report.source_keys);
+  EXPECT_GT(report.GetRatio(), 2.0f);
+}
+
+// The cursor lookup clamps outside the track and agrees with a search
+TEST_F(KeyframeCompressionTest, FindKey) {
+  vector<glm::float32> key_times = {0.0f, 1.0f, 4.0f, 9.0f};
+  glm::uint32 cursor = 0;
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, -1.0, cursor), 0u);
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, 0.5, cursor), 0u);
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, 2.0, cursor), 1u);
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, 8.0, cursor), 2u);
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, 20.0, cursor), 2u);
+  EXPECT_EQ(KeyframeCompression::FindKey(key_times, 1.0, cursor), 1u);
+}
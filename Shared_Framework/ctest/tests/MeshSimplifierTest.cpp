@@ -0,0 +1,113 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "gtest/gtest.h"
+#include "Model/LevelOfDetail.h"
+#include "Model/MeshSimplifier.h"
+
+using namespace std;
+using namespace model;
+
+class MeshSimplifierTest : public ::testing::Test {
+ protected:
+  vector<meshdata::Vertex> vertices;
+  vector<glm::uint32> indices;
+
+  // Builds a flat grid of size x size quads in the XZ plane.
+  void SetUp() override {
+    const int size = 20;
+    for (int z = 0; z <= size; ++z) {
+      for (int x = 0; x <= size; ++x) {
+        meshdata::Vertex vertex{};
+        vertex.position = glm::vec3(x, 0.0f, z);
+        vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        vertex.tex_coords = glm::vec2(x, z) / static_cast<float>(size);
+        vertices.push_back(vertex);
+      }
+    }
+    for (int z = 0; z < size; ++z) {
+      for (int x = 0; x < size; ++x) {
+        glm::uint32 i = z * (size + 1) + x;
+        indices.insert(indices.end(), {i, i + size + 1, i + 1, i + 1,
+                                       i + size + 1, i + size + 2});
+      }
+    }
+  }
+};
+
+// A flat grid can be reduced without any error
+TEST_F(MeshSimplifierTest, SimplifyFlatGrid) {
+  glm::float32 error = -1.0f;
+  auto result =
+      MeshSimplifier::Simplify(vertices, indices, indices.size() / 4, 0.01f,
+                               &error);
+  EXPECT_EQ(result.size() % 3, 0u);
+  EXPECT_LE(result.size(), indices.size() / 4);
+  EXPECT_GT(result.size(), 0u);
+  EXPECT_FLOAT_EQ(error, 0.0f);
+  for (auto index : result) {
+    EXPECT_LT(index, vertices.size());
+  }
+}
+
+// Border vertices are locked, so the outline of the grid is preserved
+TEST_F(MeshSimplifierTest, BorderIsPreserved) {
+  auto result =
+      MeshSimplifier::Simplify(vertices, indices, 0, 1.0f);
+  glm::float32 area = 0.0f;
+  for (size_t i = 0; i < result.size(); i += 3) {
+    glm::vec3 a = vertices[result[i]].position;
+    glm::vec3 b = vertices[result[i + 1]].position;
+    glm::vec3 c = vertices[result[i + 2]].position;
+    area += glm::length(glm::cross(b - a, c - a)) * 0.5f;
+  }
+  EXPECT_NEAR(area, 400.0f, 1e-3f);
+}
+
+// Each generated level is smaller than the previous one
+TEST_F(MeshSimplifierTest, GenerateLods) {
+  vector<vector<glm::uint32>> lods;
+  vector<glm::float32> errors;
+  MeshSimplifier::GenerateLods(vertices, indices, 4, 0.5f, 0.05f, lods,
+                               errors);
+  ASSERT_FALSE(lods.empty());
+  EXPECT_LE(lods.size(), 3u);
+  EXPECT_EQ(lods.size(), errors.size());
+  size_t previous = indices.size();
+  for (const auto& lod : lods) {
+    EXPECT_LT(lod.size(), previous);
+    previous = lod.size();
+  }
+}
+
+// Level selection only switches once the size has left the hysteresis band
+TEST(LodSettingsTest, SelectLevelWithHysteresis) {
+  LodSettings settings;
+  settings.full_detail_pixels = 256.0f;
+  settings.hysteresis = 0.1f;
+
+  EXPECT_EQ(settings.SelectLevel(0, 4, 300.0f), 0u);
+  // Just below the threshold, still inside the band
+  EXPECT_EQ(settings.SelectLevel(0, 4, 250.0f), 0u);
+  EXPECT_EQ(settings.SelectLevel(0, 4, 200.0f), 1u);
+  // Just above the threshold, still inside the band
+  EXPECT_EQ(settings.SelectLevel(1, 4, 260.0f), 1u);
+  EXPECT_EQ(settings.SelectLevel(1, 4, 300.0f), 0u);
+  // Never goes past the coarsest level
+  EXPECT_EQ(settings.SelectLevel(0, 4, 1.0f), 3u);
+  // A mesh without simplified levels always uses level 0
+  EXPECT_EQ(settings.SelectLevel(0, 1, 1.0f), 0u);
+}
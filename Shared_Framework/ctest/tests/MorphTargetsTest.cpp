@@ -0,0 +1,78 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/MorphTargets.h"
+
+using namespace std;
+using namespace model;
+
+// Morph targets keep only the vertices they move and blend back to the
+// shapes within the quantization step
+TEST(MorphTargetsTest, SparseMorphTargetsMatchShapes) {
+  const size_t kVertexCount = 1000;
+  vector<meshdata::Vertex> vertices(kVertexCount);
+  for (size_t i = 0; i < kVertexCount; ++i) {
+    vertices[i].position = glm::vec3(sin(i * 0.3f), cos(i * 0.7f), i * 0.01f);
+    vertices[i].normal = glm::vec3(0.0f, 0.0f, 1.0f);
+  }
+  // A smile moving the first 50 vertices, a blink moving the next 20 and
+  // their normals.
+  vector<MorphTargets::Target> targets(2);
+  targets[0].name = "smile";
+  targets[1].name = "blink";
+  for (auto& target : targets) {
+    for (const auto& vertex : vertices) {
+      target.positions.push_back(vertex.position);
+      target.normals.push_back(vertex.normal);
+    }
+  }
+  for (size_t i = 0; i < 50; ++i) {
+    targets[0].positions[i] += glm::vec3(0.02f * i, 0.0f, -0.1f);
+  }
+  for (size_t i = 50; i < 70; ++i) {
+    targets[1].positions[i].y -= 0.3f;
+    targets[1].normals[i] = glm::vec3(0.0f, 1.0f, 0.0f);
+  }
+
+  auto data = MorphTargets::Compress(vertices, targets);
+  EXPECT_EQ(data.row_starts.size(), kVertexCount + 1);
+  EXPECT_EQ(data.GetEntryCount(), 70u);
+  EXPECT_LT(data.GetByteSize(),
+            2 * kVertexCount * sizeof(glm::vec3) * targets.size());
+
+  vector<glm::float32> weights{0.75f, 0.5f};
+  auto blended = vertices;
+  data.Apply(weights, blended);
+  for (size_t i = 0; i < kVertexCount; ++i) {
+    glm::vec3 expected = vertices[i].position;
+    glm::vec3 expected_normal = vertices[i].normal;
+    for (size_t t = 0; t < targets.size(); ++t) {
+      expected += weights[t] * (targets[t].positions[i] - vertices[i].position);
+      expected_normal +=
+          weights[t] * (targets[t].normals[i] - vertices[i].normal);
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+      EXPECT_NEAR(blended[i].position[axis], expected[axis],
+                  data.position_scale);
+      EXPECT_NEAR(blended[i].normal[axis], expected_normal[axis],
+                  data.normal_scale);
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "glm/gtc/matrix_transform.hpp"
+#include "RenderQueue.h"
+
+using namespace std;
+
+class RenderQueueTest : public ::testing::Test {
+ protected:
+  RenderQueue queue;
+  // Stand-ins for two materials, only their addresses are used.
+  const int first_material = 0;
+  const int second_material = 0;
+
+  // The camera at the origin looking down -Z, far plane at 100.
+  void SetUp() override {
+    queue.Begin(glm::mat4(1.0f), 100.0f);
+  }
+
+  // A model matrix placing the item at a distance in front of the camera.
+  static glm::mat4 At(float distance) {
+    return glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance));
+  }
+
+  static vector<glm::uint32> StableOrder(const vector<glm::uint64>& keys) {
+    vector<glm::uint32> order(keys.size());
+    iota(order.begin(), order.end(), 0u);
+    stable_sort(order.begin(), order.end(),
+                [&keys](glm::uint32 a, glm::uint32 b) {
+                  return keys[a] < keys[b];
+                });
+    return order;
+  }
+};
+
+// The radix sort orders like a stable sort, ties keep submission order
+TEST_F(RenderQueueTest, RadixSortMatchesStableSort) {
+  mt19937_64 random(42);
+  vector<glm::uint64> keys(5000);
+  for (auto& key : keys) {
+    key = random();
+  }
+  // Few distinct keys sharing their high bytes, so passes are skipped and
+  // ties are common.
+  for (size_t i = 0; i < keys.size(); i += 3) {
+    keys[i] = 0xabcd000000000000ull | (random() & 0x3f);
+  }
+  vector<glm::uint32> order;
+  vector<glm::uint32> scratch;
+  RenderQueue::RadixSort(keys, order, scratch);
+  EXPECT_EQ(order, StableOrder(keys));
+
+  for (size_t count : {0u, 1u}) {
+    keys.resize(count, 7u);
+    RenderQueue::RadixSort(keys, order, scratch);
+    EXPECT_EQ(order, StableOrder(keys));
+  }
+}
+
+// Opaque items sort by state first, then front to back
+TEST_F(RenderQueueTest, OpaqueSortsByStateThenFrontToBack) {
+  const auto pass = RenderQueue::Pass::kOpaque;
+  EXPECT_LT(queue.MakeKey(pass, 1, &first_material, 1, At(10.0f)),
+            queue.MakeKey(pass, 1, &first_material, 1, At(20.0f)));
+  // A far item of the first program before a near one of the second.
+  EXPECT_LT(queue.MakeKey(pass, 1, &first_material, 1, At(90.0f)),
+            queue.MakeKey(pass, 2, &first_material, 1, At(1.0f)));
+  EXPECT_LT(queue.MakeKey(pass, 1, &first_material, 1, At(90.0f)),
+            queue.MakeKey(pass, 1, &second_material, 1, At(1.0f)));
+  EXPECT_LT(queue.MakeKey(pass, 1, &first_material, 1, At(90.0f)),
+            queue.MakeKey(pass, 1, &first_material, 2, At(1.0f)));
+  // Items behind the camera or past the far plane clamp.
+  EXPECT_EQ(queue.MakeKey(pass, 1, nullptr, 1, At(-5.0f)),
+            queue.MakeKey(pass, 1, nullptr, 1, At(0.0f)));
+  EXPECT_EQ(queue.MakeKey(pass, 1, nullptr, 1, At(500.0f)),
+            queue.MakeKey(pass, 1, nullptr, 1, At(100.0f)));
+}
+
+// Blended items come after every opaque item, back to front
+TEST_F(RenderQueueTest, BlendedSortsBackToFrontAfterOpaque) {
+  const auto opaque = RenderQueue::Pass::kOpaque;
+  const auto blended = RenderQueue::Pass::kBlended;
+  EXPECT_LT(queue.MakeKey(opaque, 4095, &second_material, 4095, At(100.0f)),
+            queue.MakeKey(blended, 1, &first_material, 1, At(0.0f)));
+  EXPECT_LT(queue.MakeKey(blended, 1, &first_material, 1, At(20.0f)),
+            queue.MakeKey(blended, 1, &first_material, 1, At(10.0f)));
+  // Depth wins over state.
+  EXPECT_LT(queue.MakeKey(blended, 2, &second_material, 2, At(20.0f)),
+            queue.MakeKey(blended, 1, &first_material, 1, At(10.0f)));
+}
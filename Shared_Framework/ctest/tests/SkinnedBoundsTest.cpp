@@ -0,0 +1,85 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "Model/Animator.h"
+#include "Model/BoundingVolume.h"
+#include "SwingClip.h"
+
+using namespace std;
+using namespace model;
+
+class SkinnedBoundsTest : public ::testing::Test {
+ protected:
+  static constexpr int kBoneCount = 64;
+  static constexpr int kKeyCount = 240;
+
+  shared_ptr<const Animation> clip;
+
+  void SetUp() override {
+    clip = MakeSwingClip(kBoneCount, kKeyCount, 0.0f);
+  }
+};
+
+// The posed box holds every vertex skinned with the pose, not just the
+// bind pose
+TEST_F(SkinnedBoundsTest, PosedBoundsHoldSkinnedVertices) {
+  vector<meshdata::Vertex> vertices(500);
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    auto& vertex = vertices[i];
+    vertex.position = glm::vec3(sin(i * 0.7f), cos(i * 1.3f), sin(i * 2.1f));
+    for (int k = 0; k < meshdata::kMaxBoneInfluence; ++k) {
+      vertex.bone_ids[k] = -1;
+      vertex.weights[k] = 0.0f;
+    }
+    if (i % 10 != 0) {
+      vertex.bone_ids[0] = static_cast<int>(i % kBoneCount);
+      vertex.bone_ids[1] = static_cast<int>((i * 7) % kBoneCount);
+      vertex.weights[0] = 0.25f + 0.5f * (i % 3) / 2.0f;
+      vertex.weights[1] = 1.0f - vertex.weights[0];
+    }
+  }
+  SkinnedBounds bounds = SkinnedBounds::FromVertices(vertices);
+  AxisAlignedBox bind_box = AxisAlignedBox::FromVertices(vertices);
+
+  Animator animator(clip);
+  bool left_bind_box = false;
+  for (int frame = 0; frame < 30; ++frame) {
+    animator.UpdateAnimation(0.1);
+    const auto& matrices = animator.GetFinalBoneMatrices();
+    AxisAlignedBox posed = bounds.Pose(matrices);
+    for (const auto& vertex : vertices) {
+      glm::vec4 skinned(vertex.position, 1.0f);
+      if (vertex.bone_ids[0] >= 0) {
+        skinned = glm::vec4(0.0f);
+        for (int k = 0; k < 2; ++k) {
+          skinned += vertex.weights[k] * (matrices[vertex.bone_ids[k]] *
+                                          glm::vec4(vertex.position, 1.0f));
+        }
+      }
+      for (int axis = 0; axis < 3; ++axis) {
+        EXPECT_GE(skinned[axis], posed.min[axis] - 1e-4f);
+        EXPECT_LE(skinned[axis], posed.max[axis] + 1e-4f);
+        left_bind_box |= skinned[axis] > bind_box.max[axis];
+      }
+    }
+  }
+  // The bind pose box alone would have culled a visible limb.
+  EXPECT_TRUE(left_bind_box);
+}
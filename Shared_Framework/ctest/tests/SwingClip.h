@@ -0,0 +1,93 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_SWINGCLIP_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_SWINGCLIP_H_
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Model/Animation.h"
+
+/**
+ * Builds a clip on a tree of bones, every one swinging around its own axis.
+ * The phase shifts the swing; clips of other phases share the skeleton.
+ * @param bone_count The number of bones.
+ * @param key_count The number of keys per channel, one per tick.
+ * @param phase The phase of the swing.
+ * @param branching The number of children per bone, 2 for a binary tree.
+ * @return The clip, at 30 ticks per second.
+ */
+inline std::shared_ptr<const model::Animation> MakeSwingClip(
+    int bone_count, int key_count, float phase, int branching = 2) {
+  using model::Animation;
+  using model::Bone;
+  std::vector<Animation::AssimpNodeData> nodes(bone_count);
+  std::map<std::string, model::BoneInfo> bone_info_map;
+  std::vector<Bone> channels;
+  for (int i = 0; i < bone_count; ++i) {
+    std::string name = "bone" + std::to_string(i);
+    nodes[i].name = name;
+    nodes[i].transformation = glm::mat4(1.0f);
+    bone_info_map[name] = {i, glm::mat4(1.0f)};
+
+    std::vector<Bone::KeyPosition> positions;
+    std::vector<Bone::KeyRotation> rotations;
+    std::vector<Bone::KeyScale> scales;
+    glm::vec3 axis =
+        glm::normalize(glm::vec3(std::sin(i), std::cos(i), 0.5f));
+    for (int key = 0; key < key_count; ++key) {
+      double time = static_cast<double>(key);
+      positions.push_back(
+          {glm::vec3(0.0f, 1.0f + 0.1f * std::sin(key * 0.1f), 0.0f), time});
+      rotations.push_back(
+          {glm::angleAxis(std::sin(key * 0.05f + i + phase), axis), time});
+      scales.push_back({glm::vec3(1.0f), time});
+    }
+    channels.emplace_back(name, i, positions, rotations, scales);
+  }
+  // Children are attached bottom up, so the copies are complete.
+  for (int i = bone_count - 1; i > 0; --i) {
+    auto& parent = nodes[(i - 1) / branching];
+    parent.children.insert(parent.children.begin(), nodes[i]);
+    parent.children_count = static_cast<glm::uint32>(parent.children.size());
+  }
+  return std::make_shared<Animation>("swing", key_count - 1.0, 30.0, nodes[0],
+                                     bone_info_map, std::move(channels));
+}
+
+/**
+ * Retrieves the largest difference between two matrices.
+ * @param a The first matrix.
+ * @param b The second matrix.
+ * @return The largest absolute difference of one element.
+ */
+inline float MaxDifference(const glm::mat4& a, const glm::mat4& b) {
+  float difference = 0.0f;
+  for (int column = 0; column < 4; ++column) {
+    for (int row = 0; row < 4; ++row) {
+      difference =
+          std::max(difference, std::abs(a[column][row] - b[column][row]));
+    }
+  }
+  return difference;
+}
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_SWINGCLIP_H_
@@ -123,6 +123,29 @@ class Buffers {
   template <typename T>
   void SetData(const std::vector<T>& data, GLenum usage);
 
+  /**
+   * Updates a subset of a buffer object's data store. In OpenGL4.5,
+   * glNamedBufferSubData is scheduled for binding first.
+   * @param offset Specifies the offset into the buffer object's data store 
+   * where data replacement will begin, measured in bytes.
+   * @param size Specifies the size in bytes of the data store region being 
+   * replaced.
+   * @param data Specifies a pointer to the new data that will be copied into 
+   * the data store.
+   */
+  void SetSubData(GLintptr offset, GLsizeiptr size, const void* data) const;
+
+  /**
+   * Reads back a subset of a buffer object's data store. Without OpenGL4.5
+   * the buffer must be bound.
+   * @param offset Specifies the offset into the buffer object's data store
+   * where reading will begin, measured in bytes.
+   * @param size Specifies the size in bytes of the data store region being
+   * read.
+   * @param data Specifies a pointer to the memory receiving the data.
+   */
+  void GetSubData(GLintptr offset, GLsizeiptr size, void* data) const;
+
   /**
    * Reset buffer data
    * @param n Specifies the number of buffer object names to be generated.
@@ -132,6 +155,8 @@ class Buffers {
 
   GLsizei GetN() const;
 
+  GLuint GetBufferId() const;
+
   bool IsEmpty() const;
   
   void GetBufferParameteriv(GLenum value,GLint* data);
@@ -21,6 +21,7 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include <string>
 #include "Core/MacroDefinition.h"
+#include "Frustum.h"
 
 /**
  * Default camera values
@@ -202,6 +203,14 @@ class Camera {
    */
   glm::mat4 GetProjectionMatrix(const float width, const float height) const;
 
+  /**
+   * Builds the view frustum of the camera in world space.
+   * @param width Viewport width.
+   * @param height Viewport height.
+   * @return The frustum of the current view and projection.
+   */
+  Frustum GetFrustum(const float width, const float height) const;
+
   /**
    * Reset the camera's properties.
    */
@@ -0,0 +1,156 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_FRAMEARENA_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_FRAMEARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * The FrameArena class hands out memory for data that only lives until the
+ * end of the frame, e.g. the matrices of a shadow pass. Allocating bumps an
+ * offset into one buffer, and OpenGLWindow::MainLoop resets the offset once
+ * the frame is presented, so nothing is freed one by one.
+ *
+ * A frame that outgrows the buffer falls back to heap blocks. The next
+ * Reset frees them and grows the buffer to the peak, so a steady frame
+ * makes no heap allocations at all. GetLastFrameStats tells whether it did.
+ *
+ * Usage example:
+ * @code
+ * FrameVector<glm::mat4> transforms;
+ * transforms.reserve(6);
+ * @endcode
+ *
+ * @note This class is not thread-safe. Only the render thread may allocate,
+ * and nothing allocated may be used after the frame ends.
+ */
+class FrameArena {
+ public:
+  // The buffer size before the first frame outgrows it.
+  static constexpr std::size_t kDefaultCapacity = 256 * 1024;
+
+  /**
+   * The allocations of one frame.
+   */
+  struct Stats {
+    std::size_t allocation_count = 0;
+    std::size_t used_bytes = 0;
+    // Allocations that did not fit the buffer and went to the heap.
+    std::size_t heap_allocation_count = 0;
+  };
+
+  /**
+   * Retrieves the singleton instance of FrameArena.
+   * @return The singleton instance of FrameArena.
+   */
+  static FrameArena& GetInstance();
+
+  FrameArena(const FrameArena&) = delete;
+
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  /**
+   * Allocates memory that stays valid until the next Reset.
+   * @param size The number of bytes.
+   * @param alignment The alignment, a power of two.
+   * @return The memory, never nullptr.
+   */
+  void* Allocate(std::size_t size,
+                 std::size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * Ends the frame: releases everything allocated since the last Reset and
+   * grows the buffer if the frame needed the heap.
+   */
+  void Reset();
+
+  /**
+   * Retrieves the allocations of the frame in progress.
+   * @return A const reference to the statistics.
+   */
+  const Stats& GetFrameStats() const;
+
+  /**
+   * Retrieves the allocations of the last finished frame.
+   * @return A const reference to the statistics.
+   */
+  const Stats& GetLastFrameStats() const;
+
+  /**
+   * Retrieves the size of the buffer.
+   * @return The capacity in bytes.
+   */
+  std::size_t GetCapacity() const;
+
+ private:
+  FrameArena();
+
+  std::unique_ptr<unsigned char[]> buffer_;
+  std::size_t capacity_ = 0;
+  std::size_t offset_ = 0;
+  // Blocks allocated once the buffer was full, freed by Reset.
+  std::vector<std::unique_ptr<unsigned char[]>> heap_blocks_;
+  std::size_t heap_bytes_ = 0;
+  Stats frame_stats_;
+  Stats last_frame_stats_;
+
+  static std::once_flag initialized_;
+  static FrameArena* instance_;
+};
+
+/**
+ * The FrameAllocator class lets standard containers take their memory from
+ * the FrameArena. Deallocating does nothing, the memory returns at the end
+ * of the frame.
+ * @tparam T The element type.
+ */
+template <typename T>
+class FrameAllocator {
+ public:
+  using value_type = T;
+
+  FrameAllocator() noexcept = default;
+
+  template <typename U>
+  FrameAllocator(const FrameAllocator<U>&) noexcept {}
+
+  T* allocate(std::size_t count) {
+    return static_cast<T*>(
+        FrameArena::GetInstance().Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) noexcept {}
+
+  template <typename U>
+  bool operator==(const FrameAllocator<U>&) const noexcept {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const FrameAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+// A vector that lives until the end of the frame.
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_FRAMEARENA_H_
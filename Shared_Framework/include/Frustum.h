@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_FRUSTUM_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_FRUSTUM_H_
+
+#include <cstddef>
+
+#include "glm/glm.hpp"
+
+/**
+ * The Frustum class holds the six clipping planes of a view volume and tests
+ * bounding volumes against them. The planes are extracted from a clip matrix
+ * (Gribb and Hartmann), so they live in whatever space the matrix maps from:
+ * a view-projection matrix gives world space planes, a model-view-projection
+ * matrix gives planes in the local space of the model.
+ *
+ * Usage example:
+ * @code
+ * Frustum frustum(projection * view);
+ * if (frustum.IntersectsSphere(center, radius)) {
+ *   // draw
+ * }
+ * @endcode
+ */
+class Frustum {
+ public:
+  enum Plane { kLeft = 0, kRight, kBottom, kTop, kNear, kFar, kPlaneCount };
+
+  /**
+   * Constructs a frustum that contains everything.
+   */
+  Frustum();
+
+  /**
+   * Constructs the frustum of a clip matrix.
+   * @param clip_matrix The matrix that maps into OpenGL clip space.
+   */
+  explicit Frustum(const glm::mat4& clip_matrix);
+
+  /**
+   * Rebuilds the planes from a clip matrix.
+   * @param clip_matrix The matrix that maps into OpenGL clip space.
+   */
+  void Update(const glm::mat4& clip_matrix);
+
+  /**
+   * Retrieves one of the normalized planes. The xyz components hold the
+   * inward facing normal and w the distance, so a point p is inside the
+   * plane when dot(xyz, p) + w >= 0.
+   * @param plane The plane to retrieve.
+   * @return The plane equation.
+   */
+  const glm::vec4& GetPlane(Plane plane) const;
+
+  /**
+   * Tests whether a sphere touches the frustum.
+   * @param center The center of the sphere.
+   * @param radius The radius of the sphere.
+   * @return False if the sphere is fully outside, true otherwise.
+   */
+  bool IntersectsSphere(const glm::vec3& center, glm::float32 radius) const;
+
+  /**
+   * Tests whether an axis aligned box touches the frustum.
+   * @param min The minimum corner of the box.
+   * @param max The maximum corner of the box.
+   * @return False if the box is fully outside, true otherwise.
+   */
+  bool IntersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+  /**
+   * Tests a batch of spheres against the frustum. Four spheres are tested at
+   * once with SSE when it is available.
+   * @param spheres The spheres to test, center in xyz and radius in w.
+   * @param count The number of spheres.
+   * @param visible Receives 1 for each sphere touching the frustum and 0 for
+   * each sphere fully outside it. Must hold count entries.
+   * @return The number of visible spheres.
+   */
+  std::size_t CullSpheres(const glm::vec4* spheres, std::size_t count,
+                          glm::uint8* visible) const;
+
+ private:
+  glm::vec4 planes_[kPlaneCount];
+};
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_FRUSTUM_H_
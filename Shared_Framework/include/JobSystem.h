@@ -0,0 +1,122 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_JOBSYSTEM_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_JOBSYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The JobSystem class owns a pool of worker threads, one less than the
+ * hardware threads, and splits loops across them. The calling thread works
+ * on the loop too and only returns once every chunk is done.
+ *
+ * Usage example:
+ * @code
+ * JobSystem::GetInstance().ParallelFor(
+ *     items.size(), 16, [&](std::size_t begin, std::size_t end) {
+ *       for (std::size_t i = begin; i < end; ++i) {
+ *         Process(items[i]);
+ *       }
+ *     });
+ * @endcode
+ *
+ * @note This class is thread-safe. Loops started from several threads run
+ * one after the other, and a loop started from inside a job runs on the
+ * calling thread alone. Jobs must not throw.
+ */
+class JobSystem {
+ public:
+  using Job = std::function<void(std::size_t begin, std::size_t end)>;
+
+  /**
+   * Retrieves the singleton instance of JobSystem.
+   * @return The singleton instance of JobSystem.
+   */
+  static JobSystem& GetInstance();
+
+  JobSystem(const JobSystem&) = delete;
+
+  JobSystem& operator=(const JobSystem&) = delete;
+
+  /**
+   * Runs a job over the range [0, count) in chunks of chunk_size indices,
+   * spread over the workers and the calling thread.
+   * @param count The number of indices.
+   * @param chunk_size The number of indices a thread takes at once.
+   * @param job Processes the indices [begin, end).
+   */
+  void ParallelFor(std::size_t count, std::size_t chunk_size, const Job& job);
+
+  /**
+   * Retrieves the number of worker threads, not counting the caller.
+   * @return The worker count.
+   */
+  std::size_t GetWorkerCount() const;
+
+  /**
+   * Stops and joins the workers.
+   */
+  ~JobSystem();
+
+ private:
+  // One ParallelFor call, living on the stack of its caller.
+  struct Batch {
+    const Job* job = nullptr;
+    std::size_t count = 0;
+    std::size_t chunk_size = 1;
+    std::size_t chunk_count = 0;
+    std::atomic<std::size_t> next_chunk{0};
+    // Workers still inside RunChunks, guarded by mutex_.
+    std::size_t users = 0;
+  };
+
+  JobSystem();
+
+  /**
+   * Waits for batches and helps with them until the system stops.
+   */
+  void WorkerLoop();
+
+  /**
+   * Claims and runs chunks of a batch until none is left.
+   * @param batch The batch to work on.
+   */
+  static void RunChunks(Batch& batch);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable work_done_;
+  Batch* batch_ = nullptr;
+  // Counts the batches started, so a worker joins each batch once.
+  std::size_t generation_ = 0;
+  bool stopping_ = false;
+  // Serializes ParallelFor calls from different threads.
+  std::mutex submit_mutex_;
+
+  static thread_local bool inside_job_;
+  static std::once_flag initialized_;
+  static JobSystem* instance_;
+};
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_JOBSYSTEM_H_
@@ -43,6 +43,16 @@
  */
 class LoadImage {
  public:
+  /**
+   * Pixels of an image decoded into system memory, waiting to be uploaded.
+   */
+  struct DecodedImage {
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    int nr_channels = 0;
+  };
+
   GLuint LoadTexture1D(const std::string& path, GLint wrap_mode = GL_REPEAT,
                        GLint mag_filter_mode = GL_LINEAR_MIPMAP_LINEAR,
                        GLint min_filter_mode = GL_LINEAR,
@@ -74,6 +84,37 @@ class LoadImage {
                                  GLint mag_filter_mode, GLint min_filter_mode,
                                  GLboolean gamma_correction = false);
 
+  /**
+   * Decodes a 2D image file without calling OpenGL, so it can run on a
+   * worker thread. Gamma correction is applied to the decoded pixels.
+   * @param path The full path to the file on the system
+   * @param gamma_correction Whether gamma correction is enabled or not.
+   * @return The decoded image. Its pixels are empty if decoding failed.
+   */
+  DecodedImage DecodeImage2D(const std::string& path,
+                             GLboolean gamma_correction = false);
+
+  /**
+   * Decodes a texture embedded in a model file without calling OpenGL.
+   * @param ai_texture The embedded texture.
+   * @param gamma_correction Whether gamma correction is enabled or not.
+   * @return The decoded image. Its pixels are empty if decoding failed.
+   */
+  DecodedImage DecodeImage2DFromAssimp(const aiTexture* ai_texture,
+                                       GLboolean gamma_correction = false);
+
+  /**
+   * Registers a decoded image as a mipmapped 2D texture. Must be called on
+   * the thread owning the OpenGL context.
+   * @param image The decoded image.
+   * @param wrap_mode The wrap mode of both texture coordinates.
+   * @param min_filter_mode The minifying filter.
+   * @param mag_filter_mode The magnifying filter.
+   * @return The OpenGL index of the texture, or 0 if the image is empty.
+   */
+  GLuint UploadTexture2D(const DecodedImage& image, GLint wrap_mode,
+                         GLint min_filter_mode, GLint mag_filter_mode);
+
   GLuint LoadTexture2DArray(const std::vector<std::string>& paths,
                             GLint wrapMode, GLint magFilterMode,
                             GLint minFilterMode,
@@ -19,6 +19,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -27,6 +28,7 @@
 
 #include "Bone.h"
 #include "BoneInfo.h"
+#include "ImportSession.h"
 #include "Model.h"
 
 #include "Core/MacroDefinition.h"
@@ -37,6 +39,10 @@ namespace model {
  * It contains information about bones, their transformations, and the duration 
  * of the animation. The class provides methods to retrieve information about 
  * bones and their transformations.
+ *
+ * An Animation only holds clip data; the time and pose of a character are
+ * kept by its Animator. Once loaded it is meant to be shared read only, e.g.
+ * as std::shared_ptr<const Animation>, by every character playing it.
  */
 class Animation {
  public:
@@ -55,6 +61,27 @@ class Animation {
     std::vector<AssimpNodeData> children;
   };
 
+  /**
+   * One node of the flattened hierarchy. Nodes are stored in depth first
+   * order, so a parent always comes before its children and a pose can be
+   * evaluated in a single pass.
+   */
+  struct SkeletonNode {
+    // The bind pose transformation relative to the parent.
+    glm::mat4 transformation;
+    // The offset matrix of the bone, if the node is one.
+    glm::mat4 offset;
+    // Index of the parent node, -1 for the root.
+    glm::int32 parent;
+    // Index into GetBones() of the animated channel, -1 if not animated.
+    glm::int32 channel;
+    // Index into the final bone matrices, -1 if no vertex uses the node.
+    glm::int32 bone_id;
+    // Levels below the node down to its deepest leaf, 0 for a leaf such as
+    // a finger tip.
+    glm::uint32 height;
+  };
+
   /**
    * Constructor for the Animation class. Loads the animation from the 
    * specified file path and associates it with a Model object.
@@ -65,6 +92,46 @@ class Animation {
    */
   Animation(const std::string& animation_path, Model* model);
 
+  /**
+   * Constructor for the Animation class. Reads one clip of an already parsed
+   * file, e.g. the file the Model was built from.
+   * @param session The parsed animation file.
+   * @param model The Model object associated with the animation.
+   * @param clip_index The index of the clip in the file.
+   * @param settings The tolerances the keys are compressed with.
+   * @note This constructor is not thread-safe. It should be called in a 
+   * thread-safe context, such as the main thread or after acquiring a lock.
+   */
+  Animation(const ImportSession& session, Model* model,
+            glm::uint32 clip_index = 0,
+            const KeyframeCompression::Settings& settings = {});
+
+  /**
+   * Constructor for the Animation class. Builds a clip from channels created
+   * in code, e.g. a procedural or retargeted animation.
+   * @param name The name of the clip.
+   * @param duration The duration of the clip in ticks.
+   * @param ticks_per_second The ticks per second of the clip.
+   * @param root_node The node hierarchy.
+   * @param bone_info_map The bones the vertices are skinned to, by node name.
+   * @param channels The animated channels, matched to the nodes by bone name.
+   */
+  Animation(std::string name, glm::float64 duration,
+            glm::float64 ticks_per_second, AssimpNodeData root_node,
+            std::map<std::string, BoneInfo> bone_info_map,
+            std::vector<Bone> channels);
+
+  /**
+   * Reads every clip of a parsed file.
+   * @param session The parsed animation file.
+   * @param model The Model object associated with the animations.
+   * @param settings The tolerances the keys are compressed with.
+   * @return One Animation per clip, in file order.
+   */
+  static std::vector<std::shared_ptr<Animation>> LoadAll(
+      const ImportSession& session, Model* model,
+      const KeyframeCompression::Settings& settings = {});
+
   /**
    * Destructor for the Animation class. Frees all allocated resources.
    * @note This destructor is not thread-safe. It should be called in a 
@@ -78,7 +145,7 @@ class Animation {
    * @return A pointer to the bone if found, nullptr otherwise.
    * @note This method is thread-safe and can be called from multiple threads.
    */
-  Bone* FindBone(const std::string& name);
+  const Bone* FindBone(const std::string& name) const;
 
   /**
    * Retrieves the duration of the animation.
@@ -138,15 +205,79 @@ class Animation {
 
   const std::vector<Bone>& GetBones() const;
 
+  /**
+   * Retrieves an animated channel for sampling.
+   * @param index The index of the channel in GetBones().
+   * @return A const reference to the channel.
+   */
+  const Bone& GetBone(glm::uint32 index) const;
+
+  /**
+   * Retrieves the flattened node hierarchy.
+   * @return A const reference to the nodes, parents first.
+   */
+  const std::vector<SkeletonNode>& GetSkeleton() const;
+
+  /**
+   * Builds a layer mask covering a node and every node below it, e.g. the
+   * spine for an upper body layer.
+   * @param node_name The name of the topmost node of the mask.
+   * @param weight The weight of the covered nodes.
+   * @return One weight per skeleton node, all zero if there is no such node.
+   */
+  std::vector<glm::float32> GetNodeMask(const std::string& node_name,
+                                        glm::float32 weight = 1.0f) const;
+
+  /**
+   * Checks if another clip animates the same skeleton: the same nodes in the
+   * same order, with the same parents and bones. Only such clips can be
+   * blended node by node.
+   * @param other The clip to compare with.
+   * @return True if the node layouts match.
+   */
+  bool SharesSkeleton(const Animation& other) const;
+
+  /**
+   * Retrieves the number of final bone matrices a pose of this animation
+   * fills.
+   * @return The bone count.
+   */
+  glm::uint32 GetBoneCount() const;
+
+  /**
+   * Retrieves the name of the clip.
+   * @return A const reference to the name.
+   */
+  const std::string& GetName() const;
+
+  /**
+   * Retrieves the size and accuracy of the compressed keys of all channels.
+   * @return A const reference to the compression report.
+   */
+  const KeyframeCompression::Report& GetCompressionReport() const;
+
  private:
   /**
    * Reads the missing bones from the animation and the associated Model.
    * @param animation The Assimp animation object.
    * @param model The associated Model object.
+   * @param settings The tolerances the keys are compressed with.
    * @note This method is not thread-safe and should be called in a thread-safe
    * context.
    */
-  void ReadMissingBones(const aiAnimation* animation, Model* model);
+  void ReadMissingBones(const aiAnimation* animation, Model* model,
+                        const KeyframeCompression::Settings& settings);
+
+  /**
+   * Reads one clip and the node hierarchy from a parsed file.
+   * @param session The parsed animation file.
+   * @param model The associated Model object.
+   * @param clip_index The index of the clip in the file.
+   * @param settings The tolerances the keys are compressed with.
+   */
+  void Load(const ImportSession& session, Model* model,
+            glm::uint32 clip_index,
+            const KeyframeCompression::Settings& settings);
 
   /**
    * Reads the hierarchy data from the Assimp node and populates the AssimpNodeData.
@@ -157,15 +288,41 @@ class Animation {
    */
   void ReadHierarchyData(AssimpNodeData& dest, const aiNode* src);
 
+  /**
+   * Flattens root_node_ into skeleton_. Called whenever the hierarchy or
+   * the bone information changes.
+   */
+  void RebuildSkeleton();
+
+  /**
+   * Flattens the hierarchy below a node into skeleton_, resolving the
+   * channel and bone of every node.
+   * @param node The node to append.
+   * @param parent The index of the parent node, -1 for the root.
+   * @param channels The index of each channel by node name.
+   */
+  void BuildSkeleton(const AssimpNodeData& node, glm::int32 parent,
+                     const std::map<std::string, glm::int32>& channels);
+
  private:
+  // The name of the clip in the file.
+  std::string name_;
   // The duration of the animation in seconds.
   glm::float64 duration_ = 0.0;
   //The ticks per second of the animation.
   glm::float64 ticks_per_second_ = 0.0;
   // The bones in the animation.
   std::vector<Bone> bones_;
+  // The compression of all channels in bones_.
+  KeyframeCompression::Report compression_report_;
   // The root node data of the animation hierarchy.
   AssimpNodeData root_node_;
+  // The hierarchy flattened for pose evaluation.
+  std::vector<SkeletonNode> skeleton_;
+  // The name of every node in skeleton_.
+  std::vector<std::string> node_names_;
+  // One past the largest bone id in skeleton_.
+  glm::uint32 bone_count_ = 0;
   // The bone information map.
   std::map<std::string, BoneInfo> bone_info_map_;
 };
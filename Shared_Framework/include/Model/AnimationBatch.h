@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONBATCH_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONBATCH_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Animator.h"
+
+namespace model {
+/**
+ * The AnimationBatch class updates many animators at once on the
+ * JobSystem. The animators are split into chunks, and each worker thread
+ * evaluates the poses of one chunk at a time. Animators are independent of
+ * each other, even when they play the same clip, so no locking is needed
+ * between them.
+ *
+ * The palettes of all animators can be written back to back into one
+ * buffer, e.g. a mapped GPU buffer, straight from the worker threads.
+ *
+ * Usage example:
+ * @code
+ * std::vector<glm::uint32> offsets;
+ * auto bones = AnimationBatch::GetPaletteOffsets(animators, offsets);
+ * palette.resize(bones * Animator::GetTexelsPerBone(format));
+ * AnimationBatch::Update(animators, delta_time, offsets, palette.data(),
+ *                        format);
+ * @endcode
+ */
+class AnimationBatch {
+ public:
+  // Animators a worker takes at once.
+  static constexpr glm::uint32 kDefaultChunkSize = 16;
+
+  /**
+   * Advances every animator in parallel.
+   * @param animators The animators to update. Null entries are skipped.
+   * @param delta_time The time passed since the last update.
+   * @param chunk_size The number of animators a worker takes at once.
+   */
+  static void Update(const std::vector<Animator*>& animators,
+                     glm::float64 delta_time,
+                     glm::uint32 chunk_size = kDefaultChunkSize);
+
+  /**
+   * Advances every animator in parallel and writes the palette of animator i
+   * to palettes + offsets[i] * Animator::GetTexelsPerBone(format).
+   * @param animators The animators to update. Null entries are skipped.
+   * @param delta_time The time passed since the last update.
+   * @param offsets The first bone of each palette, from GetPaletteOffsets.
+   * @param palettes Receives the bone transforms of all animators.
+   * @param format The layout of each bone transform.
+   * @param chunk_size The number of animators a worker takes at once.
+   */
+  static void Update(const std::vector<Animator*>& animators,
+                     glm::float64 delta_time,
+                     const std::vector<glm::uint32>& offsets,
+                     glm::vec4* palettes, PaletteFormat format,
+                     glm::uint32 chunk_size = kDefaultChunkSize);
+
+  /**
+   * Lays the palettes of the animators out back to back.
+   * @param animators The animators.
+   * @param offsets Receives the first bone of each palette.
+   * @return The number of bones of all palettes.
+   */
+  static glm::uint32 GetPaletteOffsets(const std::vector<Animator*>& animators,
+                                       std::vector<glm::uint32>& offsets);
+
+  /**
+   * Sums the animation channels the animators sampled in their last update,
+   * the work actually done after level of detail.
+   * @param animators The animators. Null entries are skipped.
+   * @return The number of bones evaluated.
+   */
+  static glm::uint64 GetEvaluatedBoneCount(
+      const std::vector<Animator*>& animators);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONBATCH_H_
@@ -0,0 +1,157 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONSET_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONSET_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Animation.h"
+#include "ImportSession.h"
+#include "KeyframeCompression.h"
+#include "Model.h"
+
+namespace model {
+/**
+ * The AnimationSet class indexes every animation clip of a file and decodes
+ * a clip into Bone channels only when it is first requested. A character
+ * file often carries dozens of clips of which a scene plays a few, so the
+ * keys of the others are never resampled or compressed.
+ *
+ * The set keeps the import alive, so switching to a clip that was not used
+ * yet reads it from the parsed scene instead of parsing the file again.
+ * ReleaseSource drops the scene once the needed clips are decoded.
+ *
+ * Usage example:
+ * @code
+ * auto session = std::make_shared<ImportSession>(path, flags);
+ * auto model = std::make_shared<Model>(*session, options);
+ * AnimationSet clips(session, model);
+ * animator.ResetAnimation(clips.Find("run"));
+ * @endcode
+ *
+ * @note Decoding extends the bone map of the model, so clips must be
+ * requested on the loading thread. The set does not keep the model alive;
+ * once the model is released, clips not decoded yet can no longer be.
+ */
+class AnimationSet {
+ public:
+  /**
+   * What is known about a clip without decoding it.
+   */
+  struct ClipInfo {
+    std::string name;
+    // The duration in ticks.
+    glm::float64 duration;
+    glm::float64 ticks_per_second;
+    // The number of animated nodes.
+    glm::uint32 channel_count;
+  };
+
+  /**
+   * Indexes the clips of a parsed file.
+   * @param session The parsed file. It is kept until ReleaseSource.
+   * @param model The Model object associated with the animations.
+   * @param settings The tolerances the keys are compressed with.
+   */
+  AnimationSet(std::shared_ptr<const ImportSession> session,
+               const std::shared_ptr<Model>& model,
+               const KeyframeCompression::Settings& settings = {});
+
+  AnimationSet(const AnimationSet&) = delete;
+
+  AnimationSet& operator=(const AnimationSet&) = delete;
+
+  /**
+   * Retrieves the number of clips in the file.
+   * @return The clip count.
+   */
+  glm::uint32 GetClipCount() const;
+
+  /**
+   * Retrieves the index entry of a clip.
+   * @param index The index of the clip in the file.
+   * @return A const reference to the entry.
+   */
+  const ClipInfo& GetClipInfo(glm::uint32 index) const;
+
+  /**
+   * Finds a clip by name.
+   * @param name The name of the clip.
+   * @return The index of the clip, or -1 if there is no such clip.
+   */
+  glm::int32 FindClip(const std::string& name) const;
+
+  /**
+   * Retrieves a clip, decoding it on the first request.
+   * @param index The index of the clip in the file.
+   * @return A shared pointer to the animation, or nullptr if the index is
+   * out of range or the clip needs decoding after the model was released.
+   */
+  std::shared_ptr<const Animation> Get(glm::uint32 index);
+
+  /**
+   * Retrieves a clip by name, decoding it on the first request.
+   * @param name The name of the clip.
+   * @return A shared pointer to the animation, or nullptr if there is no
+   * such clip or it needs decoding after the model was released.
+   */
+  std::shared_ptr<const Animation> Find(const std::string& name);
+
+  /**
+   * Checks whether a clip was decoded already.
+   * @param index The index of the clip in the file.
+   * @return True if the clip is decoded and held by the set.
+   */
+  bool IsDecoded(glm::uint32 index) const;
+
+  /**
+   * Retrieves the number of clips decoded and held by the set.
+   * @return The decoded clip count.
+   */
+  glm::uint32 GetDecodedCount() const;
+
+  /**
+   * Drops the parsed scene. Clips decoded later parse the file again.
+   */
+  void ReleaseSource();
+
+  /**
+   * Drops the decoded clips that nothing outside the set refers to. They
+   * are decoded again on their next request.
+   * @return The number of clips dropped.
+   */
+  std::size_t ReleaseUnused();
+
+ private:
+  std::shared_ptr<const ImportSession> session_;
+  std::string path_;
+  // Decoding writes into the model, it is locked for every decode.
+  std::weak_ptr<Model> model_;
+  KeyframeCompression::Settings settings_;
+  std::vector<ClipInfo> clips_;
+  // Null until the clip is requested.
+  std::vector<std::shared_ptr<const Animation>> decoded_;
+
+  mutable std::mutex set_mutex_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATIONSET_H_
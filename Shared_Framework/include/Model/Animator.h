@@ -18,18 +18,121 @@
 #define CMAKE_OPEN_INCLUDES_INCLUDE_ANIMATOR_H_
 
 #include <map>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "assimp/scene.h"
 #include "glm/glm.hpp"
 
 #include "Animation.h"
+#include "LocalPose.h"
 
 namespace model {
+/**
+ * How a palette stores one bone transform, in RGBA32F texels.
+ */
+enum class PaletteFormat : glm::uint8 {
+  // A column major mat4, four texels.
+  kMatrix4x4,
+  // The top three rows of the affine matrix, three texels. The last row of a
+  // bone matrix is always (0, 0, 0, 1).
+  kMatrix3x4,
+  // A unit dual quaternion, the rotation then the translation part, two
+  // texels. Blending dual quaternions keeps the volume around twisting
+  // joints, but any scale in the bone matrix is dropped.
+  kDualQuaternion
+};
+
+/**
+ * How much of its pose an Animator evaluates in an update, usually picked
+ * every frame by an AnimationLodPolicy.
+ */
+struct AnimationLod {
+  // The pose is sampled every update_interval updates and interpolated
+  // towards in between, one interval behind. 1 samples every update.
+  glm::uint32 update_interval = 1;
+  // Nodes up to this many levels above a leaf, e.g. fingers and face
+  // bones, keep their last sampled transform. 0 samples every node.
+  glm::uint32 skipped_leaf_levels = 0;
+  // An invisible animator only advances its clock. The pose is sampled
+  // again in the first update after it becomes visible.
+  bool visible = true;
+};
+
+/**
+ * Picks an AnimationLod from the distance of a character to the camera.
+ *
+ * Up to full_rate_distance every update is sampled. Past it the update
+ * interval doubles each time the distance doubles, up to
+ * max_update_interval. Past leaf_skip_distance the lowest
+ * skipped_leaf_levels levels of the skeleton are no longer sampled.
+ */
+struct AnimationLodPolicy {
+  // Distance up to which every update samples the pose.
+  glm::float32 full_rate_distance = 10.0f;
+  // The largest number of updates between two samples.
+  glm::uint32 max_update_interval = 4;
+  // Distance past which the leaf levels are skipped.
+  glm::float32 leaf_skip_distance = 15.0f;
+  // Leaf levels skipped past leaf_skip_distance.
+  glm::uint32 skipped_leaf_levels = 2;
+
+  /**
+   * Selects the level of detail of one character.
+   * @param distance The distance from the camera to the character.
+   * @param visible Whether the character is inside the view frustum.
+   * @return The level of detail to pass to Animator::SetLod.
+   */
+  AnimationLod Select(glm::float32 distance, bool visible) const;
+};
+
+/**
+ * How an AnimationLayer combines with the pose below it.
+ */
+enum class LayerBlend : glm::uint8 {
+  // Blends towards the layer pose by the layer weight.
+  kOverride,
+  // Adds the difference between the layer pose and the first frame of the
+  // layer clip, scaled by the layer weight.
+  kAdditive
+};
+
+/**
+ * A clip played on top of the main clip of an Animator, e.g. an upper body
+ * wave over a walk. The clip has to share the skeleton of the main clip.
+ */
+struct AnimationLayer {
+  std::shared_ptr<const Animation> animation;
+  LayerBlend blend = LayerBlend::kOverride;
+  glm::float32 weight = 1.0f;
+  // The weight of every skeleton node, e.g. from Animation::GetNodeMask.
+  // Empty applies the layer to every node.
+  std::vector<glm::float32> mask;
+};
+
 /**
  * The Animator class is responsible for updating and resetting the animation 
  * state of an Animation object. It calculates bone transformations based on 
  * the animation data and provides access to the final bone matrices.
+ *
+ * A pose is evaluated in a single loop over the animation's flattened
+ * skeleton. Parents come before their children, so each node only multiplies
+ * its local transform onto an already computed parent transform.
+ *
+ * The Animation is only read, so one clip can drive any number of
+ * animators. Each animator keeps just the playback time, one key cursor per
+ * channel and the pose matrices, a few KB for a typical skeleton.
+ *
+ * SetLod trades pose quality for time on distant or hidden characters:
+ * sampling at a reduced rate, skipping leaf bones, or only advancing the
+ * clock. GetEvaluatedBoneCount reports the channels sampled by the last
+ * update.
+ *
+ * CrossFade and AddLayer mix several clips of one skeleton. Every clip is
+ * then sampled into a LocalPose, the poses are blended node by node and the
+ * hierarchy is walked once for the result. A single clip keeps the direct
+ * matrix path.
  * 
  * Usage example:
  * @code
@@ -50,31 +153,118 @@ class Animator {
   /**
    * Constructor for the Animator class. Initializes the animator with an
    * Animation object.
-   * @param animation The Animation object to animate.
+   * @param animation The Animation object to animate. The animator takes
+   * ownership of it.
    */
   explicit Animator(Animation* animation);
 
+  /**
+   * Constructor for the Animator class. Initializes the animator with an
+   * Animation object that may be shared with other animators, e.g. by the
+   * ModelInstance objects of one model.
+   * @param animation The Animation object to animate.
+   */
+  explicit Animator(std::shared_ptr<const Animation> animation);
+
   /**
    * Updates the animation state based on the specified delta time.
    * @param delete_time The time difference since the last update.
    */
   void UpdateAnimation(glm::float64 delete_time);
 
+  /**
+   * Updates the animation state and writes the new bone transforms to a
+   * palette, e.g. a mapped GPU buffer. The palette is written front to back
+   * and never read.
+   * @param delete_time The time difference since the last update.
+   * @param palette Receives GetFinalBoneMatrices().size() *
+   * GetTexelsPerBone(format) texels.
+   * @param format The layout of each bone transform.
+   */
+  void UpdateAnimation(glm::float64 delete_time, glm::vec4* palette,
+                       PaletteFormat format);
+
+  /**
+   * Writes the current bone transforms to a palette.
+   * @param palette Receives GetFinalBoneMatrices().size() *
+   * GetTexelsPerBone(format) texels.
+   * @param format The layout of each bone transform.
+   */
+  void WritePalette(glm::vec4* palette, PaletteFormat format) const;
+
+  /**
+   * Retrieves the size of one bone transform in a palette.
+   * @param format The palette format.
+   * @return The number of RGBA32F texels per bone.
+   */
+  static glm::uint32 GetTexelsPerBone(PaletteFormat format);
+
+  /**
+   * Packs a bone matrix into the texels of a palette.
+   * @param matrix The affine bone matrix.
+   * @param format The palette format.
+   * @param texels Receives GetTexelsPerBone(format) texels.
+   */
+  static void PackBone(const glm::mat4& matrix, PaletteFormat format,
+                       glm::vec4* texels);
+
   /**
    * Resets the animation state to the beginning of the current Animation.
-   * @param p_animation The new Animation object to animate.
+   * @param p_animation The new Animation object to animate. The animator
+   * takes ownership of it.
    */
   void ResetAnimation(Animation* p_animation);
 
   /**
-   * Calculates the bone transformations for the specified node data and parent
-   * transform.
-   * @param node_data The AssimpNodeData representing the node to calculate the
-   * transform for.
-   * @param parent_transform The parent transform matrix.
+   * Resets the animation state to the beginning of a shared Animation.
+   * @param animation The new Animation object to animate.
    */
-  void CalculateBoneTransform(const Animation::AssimpNodeData& node_data,
-                              glm::mat4 parent_transform);
+  void ResetAnimation(std::shared_ptr<const Animation> animation);
+
+  /**
+   * Blends from the current clip to another one over a duration. The old
+   * clip keeps playing until the fade ends; during a fade, the fade starts
+   * from the current mix instead. Layers are kept.
+   * @param animation The clip to fade to. A clip with a different skeleton
+   * starts at once, like ResetAnimation.
+   * @param duration The length of the fade in seconds, 0 to switch at once.
+   */
+  void CrossFade(std::shared_ptr<const Animation> animation,
+                 glm::float64 duration);
+
+  /**
+   * Checks if a cross fade is in progress.
+   * @return True while the previous clip is still blended in.
+   */
+  bool IsFading() const;
+
+  /**
+   * Plays a clip on top of the main clip. Layers apply in the order they
+   * were added.
+   * @param layer The layer, its clip starts at the beginning.
+   * @return The index of the layer.
+   * @throws ModelException If the clip or mask does not fit the skeleton of
+   * the main clip.
+   */
+  glm::uint32 AddLayer(const AnimationLayer& layer);
+
+  /**
+   * Changes the weight of a layer, e.g. to fade it in or out.
+   * @param index The index returned by AddLayer.
+   * @param weight The new weight, 0 skips the layer.
+   */
+  void SetLayerWeight(glm::uint32 index, glm::float32 weight);
+
+  /**
+   * Retrieves the number of layers.
+   * @return The layer count.
+   */
+  glm::uint32 GetLayerCount() const;
+
+  /**
+   * Removes every layer.
+   */
+  void ClearLayers();
 
   /**
    * Retrieves the final bone matrices calculated by the animator.
@@ -82,31 +272,174 @@ class Animator {
    */
   const std::vector<glm::mat4>& GetFinalBoneMatrices() const;
 
-  ~Animator();
+  /**
+   * Sets how much of the pose the following updates evaluate.
+   * @param lod The level of detail.
+   */
+  void SetLod(const AnimationLod& lod);
+
+  /**
+   * Retrieves the level of detail set last.
+   * @return A const reference to the level of detail.
+   */
+  const AnimationLod& GetLod() const;
+
+  /**
+   * Retrieves the number of animation channels sampled by the last update.
+   * @return The bone count, 0 if the pose was only interpolated.
+   */
+  glm::uint32 GetEvaluatedBoneCount() const;
+
+  /**
+   * Retrieves the Animation object being animated.
+   * @return A shared pointer to the animation.
+   */
+  const std::shared_ptr<const Animation>& GetAnimation() const;
+
+  ~Animator() = default;
 
  private:
+  static constexpr glm::uint32 kNoTarget = 0xffffffffu;
+
+  /**
+   * A layer with its own clock and key cursors.
+   */
+  struct LayerPlayback {
+    AnimationLayer layer;
+    glm::float64 time = 0.0;
+    std::vector<Bone::Cursor> cursors;
+    // The last sample of the layer clip.
+    LocalPose pose;
+    // The first frame of an additive clip.
+    LocalPose reference;
+  };
+
   /**
    * Initializes the animator with the specified Animation object.
    * @param animation The Animation object to animate.
    */
-  void SetupAnimator(Animation* animation);
+  void SetupAnimator(std::shared_ptr<const Animation> animation);
+
+  /**
+   * Starts a clip of the current skeleton from the beginning, keeping the
+   * fade and the layers.
+   * @param animation The clip to play.
+   */
+  void StartClip(std::shared_ptr<const Animation> animation);
+
+  /**
+   * Advances a playback time by the time passed, wrapping at the end.
+   * @param animation The clip played.
+   * @param time The playback time in ticks.
+   * @param delta_time The time passed in seconds.
+   * @return The new playback time.
+   */
+  static glm::float64 AdvanceTime(const Animation& animation,
+                                  glm::float64 time, glm::float64 delta_time);
+
+  /**
+   * Samples the channels of a clip into a pose. Nodes without a channel and
+   * skipped leaves keep their previous transform.
+   * @param animation The clip to sample.
+   * @param time The playback time in ticks.
+   * @param cursors The key cursors of the clip.
+   * @param pose Receives the local transforms.
+   */
+  void SamplePose(const Animation& animation, glm::float64 time,
+                  std::vector<Bone::Cursor>& cursors, LocalPose& pose);
+
+  /**
+   * Evaluates the mix of the main clip, the fade and the layers into pose_.
+   */
+  void EvaluateLocalPose();
+
+  /**
+   * Walks the skeleton once, parents before children, to turn local
+   * transforms into bone matrices.
+   * @param pose The local transform of every node.
+   * @param bone_matrices Receives the bone matrices.
+   */
+  void ComposePose(const LocalPose& pose,
+                   std::vector<glm::mat4>& bone_matrices);
+
+  /**
+   * Evaluates the pose at current_time_ in one pass over the flattened
+   * skeleton, parents before children.
+   * @param bone_matrices Receives the bone matrices.
+   */
+  void CalculatePose(std::vector<glm::mat4>& bone_matrices);
+
+  /**
+   * Advances the pose one step from start_pose_ towards target_pose_,
+   * sampling a new target when the previous one was reached, and composes
+   * final_bone_matrices_ from it.
+   */
+  void InterpolatePose();
+
+  /**
+   * Retrieves the local transforms final_bone_matrices_ were last composed
+   * from.
+   * @param pose Receives the local transforms.
+   */
+  void CaptureShownPose(LocalPose& pose);
 
  private:
   // The final bone matrices calculated by the animator.
   std::vector<glm::mat4> final_bone_matrices_;
+  // Model space transform of every skeleton node, reused every update.
+  std::vector<glm::mat4> global_transforms_;
+  // The keys each channel of the animation used last.
+  std::vector<Bone::Cursor> cursors_;
+  // The local transform of every skeleton node, kept for skipped leaves.
+  std::vector<glm::mat4> local_transforms_;
+  // The local poses a reduced update rate interpolates between.
+  LocalPose start_pose_;
+  LocalPose target_pose_;
+
+  AnimationLod lod_;
+  // Updates since target_pose_ was sampled, kNoTarget when the
+  // next reduced rate update has to sample a new target.
+  glm::uint32 interpolation_step_ = kNoTarget;
+  // Set while invisible, the next visible update samples without blending.
+  bool pose_stale_ = true;
+  // Set when final_bone_matrices_ were composed from pose_, cleared when
+  // the direct path composed them from local_transforms_.
+  bool composed_from_pose_ = false;
+  glm::uint32 evaluated_bone_count_ = 0;
 
-  // The current Animation object being animated.
-  Animation* current_animation_;
+  // The current Animation object being animated, never modified.
+  std::shared_ptr<const Animation> current_animation_;
   // The current time in the animation.
   glm::float64 current_time_;
   // The delta time since the last update.
   glm::float64 delta_time_;
 
+  // The rest pose of the skeleton, where every clip pose starts.
+  LocalPose bind_pose_;
+  // The last sample of the current Animation.
+  LocalPose main_pose_;
+  // The mix of all clips, rebuilt every blended update.
+  LocalPose pose_;
+
+  // Set while a fade is in progress.
+  bool fading_ = false;
+  // The clip faded out of. nullptr when fade_pose_ is a frozen mix, left by
+  // a fade started during another one.
+  std::shared_ptr<const Animation> fade_animation_;
+  glm::float64 fade_time_ = 0.0;
+  std::vector<Bone::Cursor> fade_cursors_;
+  LocalPose fade_pose_;
+  // The length and progress of the fade in seconds.
+  glm::float64 fade_duration_ = 0.0;
+  glm::float64 fade_elapsed_ = 0.0;
+
+  std::vector<LayerPlayback> layers_;
+
   /**
-   * A recursive lock that prevents data from being accessed simultaneously in 
-   * multiple threads.
+   * A lock that prevents data from being accessed simultaneously in multiple
+   * threads.
    */
-  std::recursive_mutex bone_matrices_mutex_;
+  std::mutex bone_matrices_mutex_;
 };
 }  // namespace model
 
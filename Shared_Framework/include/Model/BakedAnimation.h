@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_BAKEDANIMATION_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_BAKEDANIMATION_H_
+
+#include <memory>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "Animation.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The BakedAnimation class samples an Animation at a fixed frame rate and
+ * stores every pose in a float texture, one row per frame and three RGBA32F
+ * texels per bone, the rows of the 3x4 bone matrix as written by
+ * PaletteFormat::kMatrix3x4.
+ *
+ * A skinning shader fetches the two frames around an instance's time and
+ * blends them, so any number of characters playing the clip are drawn with
+ * one instanced draw call and no animation work on the CPU. The instance
+ * time offset and playback speed come from the per instance parameters of
+ * an InstanceBuffer, see animation_model_baked.vert:
+ * @code
+ * layout (location = 11) in vec4 instance_animation;  // offset, speed
+ * uniform sampler2D baked_palette;
+ * uniform int baked_frame_count;
+ * uniform float baked_frame_rate;
+ * @endcode
+ *
+ * The frame rate is rounded so the clip length is a whole number of frames
+ * and the last frame blends back into the first one.
+ *
+ * Usage example:
+ * @code
+ * BakedAnimation baked(animation, 30.0f);
+ * instances.SetTransforms(transforms, parameters);
+ * shader.Use();
+ * baked.Bind(shader);
+ * shader.SetFloat("time", seconds);
+ * model->DrawInstanced(shader, instances, instances.GetCount());
+ * @endcode
+ */
+class BakedAnimation {
+ public:
+  // The texture unit of baked_palette, after the bone palette unit.
+  static constexpr GLuint kTextureUnit = 17;
+  // The texels of one bone in a frame.
+  static constexpr glm::uint32 kTexelsPerBone = 3;
+
+  /**
+   * Bakes an animation and uploads it to a texture.
+   * @param animation The animation to bake.
+   * @param frames_per_second The requested sampling rate.
+   */
+  BakedAnimation(std::shared_ptr<const Animation> animation,
+                 glm::float32 frames_per_second);
+
+  /**
+   * Deletes the texture.
+   */
+  ~BakedAnimation();
+
+  BakedAnimation(const BakedAnimation&) = delete;
+
+  BakedAnimation& operator=(const BakedAnimation&) = delete;
+
+  /**
+   * Samples an animation at a fixed rate on the CPU.
+   * @param animation The animation to bake.
+   * @param frames_per_second The requested sampling rate.
+   * @param texels Receives GetFrameCount() rows of bones * kTexelsPerBone
+   * texels.
+   * @param frame_rate Receives the sampling rate actually used.
+   * @return The number of frames baked.
+   */
+  static glm::uint32 Bake(const std::shared_ptr<const Animation>& animation,
+                          glm::float32 frames_per_second,
+                          std::vector<glm::vec4>& texels,
+                          glm::float32& frame_rate);
+
+  /**
+   * Binds the texture to kTextureUnit and sets the baked_palette,
+   * baked_frame_count and baked_frame_rate uniforms. The shader must be in
+   * use.
+   * @param shader The baked skinning shader.
+   */
+  void Bind(Shader& shader) const;
+
+  /**
+   * Retrieves the number of frames baked.
+   * @return The frame count, the height of the texture.
+   */
+  glm::uint32 GetFrameCount() const;
+
+  /**
+   * Retrieves the number of bones of every frame.
+   * @return The bone count.
+   */
+  glm::uint32 GetBoneCount() const;
+
+  /**
+   * Retrieves the sampling rate of the frames.
+   * @return The frames per second.
+   */
+  glm::float32 GetFrameRate() const;
+
+  /**
+   * Retrieves the OpenGL name of the texture.
+   * @return The texture id.
+   */
+  GLuint GetTextureId() const;
+
+ private:
+  GLuint texture_;
+  glm::uint32 frame_count_;
+  glm::uint32 bone_count_;
+  glm::float32 frame_rate_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_BAKEDANIMATION_H_
@@ -27,6 +27,7 @@
 #include "glm/gtx/quaternion.hpp"
 
 #include "AssimpGLMHelpers.h"
+#include "KeyframeCompression.h"
 
 #include "Core/MacroDefinition.h"
 
@@ -36,6 +37,16 @@ namespace model {
  * motion of each bone over time.This class is usually used in conjunction with 
  * the Animation class. This class is only responsible for storing data and 
  * computing data without the risk of memory leaks.
+ *
+ * A bone is immutable once loaded, so one clip can be shared by any number
+ * of characters. The playback state lives in a Cursor owned by the caller:
+ * it remembers the key each track used last. Playback moves forward a key
+ * or two per update, so the cursor is checked first and a binary search is
+ * only needed on seeks and loops. Times before the first key or after the
+ * last key are clamped to that key.
+ *
+ * The keys are compressed by KeyframeCompression when the bone is built and
+ * decoded while sampling, so the key indices refer to the kept keys.
  */
 class Bone {
  public:
@@ -63,26 +74,63 @@ class Bone {
     glm::float64 time_stamp;
   };
 
+  // The key each track of a bone used last, kept per playing instance.
+  struct Cursor {
+    glm::uint32 position = 0;
+    glm::uint32 rotation = 0;
+    glm::uint32 scale = 0;
+  };
+
  public:
-  explicit Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel);
+  explicit Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel,
+                const KeyframeCompression::Settings& settings = {});
 
   /**
-   * Updates the local transform of the bone based on the animation time.
-   * @param animation_time The current time of the animation.
+   * Constructs a bone from key tracks that are already converted. The keys of
+   * each track must be sorted by time stamp.
+   * @param bone_name The name of the bone.
+   * @param bone_id The ID of the bone.
+   * @param positions The key positions.
+   * @param rotations The key rotations.
+   * @param scales The key scales.
+   * @param settings The tolerances of the key reduction.
    */
-  void Update(glm::float64 animation_time);
+  Bone(std::string bone_name, int bone_id,
+       const std::vector<KeyPosition>& positions,
+       const std::vector<KeyRotation>& rotations,
+       const std::vector<KeyScale>& scales,
+       const KeyframeCompression::Settings& settings = {});
 
   /**
-   * Gets the local transformation matrix of the bone.
+   * Computes the local transform of the bone at the animation time.
+   * @param animation_time The current time of the animation.
+   * @param cursor The playback state of the caller, updated to the keys used.
    * @return The local transformation matrix.
    */
-  const glm::mat4& GetLocalTransform() const;
+  glm::mat4 Sample(glm::float64 animation_time, Cursor& cursor) const;
 
   /**
-   * Sets the local transformation matrix of the bone.
-   * @param local_transform The new local transformation matrix.
+   * Computes the local transform of the bone at the animation time as
+   * separate parts, which blend better than matrices.
+   * @param animation_time The current time of the animation.
+   * @param cursor The playback state of the caller, updated to the keys used.
+   * @param translation Receives the translation.
+   * @param rotation Receives the unit rotation quaternion.
+   * @param scale Receives the scale.
    */
-  void SetLocalTransform(const glm::mat4& local_transform);
+  void Sample(glm::float64 animation_time, Cursor& cursor,
+              glm::vec3& translation, glm::quat& rotation,
+              glm::vec3& scale) const;
+
+  /**
+   * Builds the matrix translate * rotate * scale.
+   * @param translation The translation.
+   * @param rotation The unit rotation quaternion.
+   * @param scale The scale.
+   * @return The local transformation matrix.
+   */
+  static glm::mat4 Compose(const glm::vec3& translation,
+                           const glm::quat& rotation, const glm::vec3& scale);
 
   /**
    * Gets the name of the bone.
@@ -109,65 +157,84 @@ class Bone {
   void SetId(glm::int32 id);
 
   /**
-   * Gets the index of the key position at a specific animation time.
+   * Gets the index of the key position at a specific animation time, i.e. the
+   * key the interpolation starts from.
    * @param animation_time The current time of the animation.
-   * @return The index of the key position.
+   * @param cursor The playback state of the caller.
+   * @return The index of the key position, clamped to the track.
    */
-  glm::int32 GetPositionsIndex(glm::float64 animation_time);
+  glm::int32 GetPositionsIndex(glm::float64 animation_time,
+                               Cursor& cursor) const;
 
   /**
    * Gets the index of the key rotation at a specific animation time.
    * @param animation_time The current time of the animation.
-   * @return The index of the key rotation.
+   * @param cursor The playback state of the caller.
+   * @return The index of the key rotation, clamped to the track.
    */
-  glm::int32 GetRotationIndex(glm::float64 animation_time);
+  glm::int32 GetRotationIndex(glm::float64 animation_time,
+                              Cursor& cursor) const;
 
   /**
    * Gets the index of the key scale at a specific animation time.
    * @param animation_time The current time of the animation.
-   * @return The index of the key scale.
+   * @param cursor The playback state of the caller.
+   * @return The index of the key scale, clamped to the track.
    */
-  glm::int32 GetScaleIndex(glm::float64 animation_time);
+  glm::int32 GetScaleIndex(glm::float64 animation_time, Cursor& cursor) const;
+
+  /**
+   * Retrieves the size and accuracy of the compressed keys.
+   * @return A const reference to the compression report.
+   */
+  const KeyframeCompression::Report& GetCompressionReport() const;
 
  private:
   /**
-   * Calculates the scale factor for interpolation.
-   * @param last_time_stamp The time stamp of the previous key frame.
-   * @param next_time_stamp The time stamp of the next key frame.
-   * @param animation_time The current time of the animation.
-   * @return The scale factor for interpolation.
+   * Compresses the source keys into the tracks of the bone.
+   * @param positions The key positions.
+   * @param rotations The key rotations.
+   * @param scales The key scales.
+   * @param settings The tolerances of the key reduction.
    */
-  glm::float64 GetScaleFactor(glm::float64 last_time_stamp,
-                              glm::float64 next_time_stamp,
-                              glm::float64 animation_time);
+  void Compress(const std::vector<KeyPosition>& positions,
+                const std::vector<KeyRotation>& rotations,
+                const std::vector<KeyScale>& scales,
+                const KeyframeCompression::Settings& settings);
 
   /**
    * Interpolates the position of the bone based on the animation time.
    * @param animation_time The current time of the animation.
-   * @return The interpolated position matrix.
+   * @param cursor The playback state of the caller.
+   * @return The interpolated position.
    */
-  glm::mat4 InterpolatePosition(glm::float64 animation_time);
+  glm::vec3 InterpolatePosition(glm::float64 animation_time,
+                                Cursor& cursor) const;
 
   /**
    * Interpolates the rotation of the bone based on the animation time.
    * @param animation_time The current time of the animation.
-   * @return The interpolated rotation matrix.
+   * @param cursor The playback state of the caller.
+   * @return The interpolated unit quaternion.
    */
-  glm::mat4 InterpolateRotation(glm::float64 animation_time);
+  glm::quat InterpolateRotation(glm::float64 animation_time,
+                                Cursor& cursor) const;
 
   /**
    * Interpolates the scale of the bone based on the animation time.
    * @param animation_time The current time of the animation.
-   * @return The interpolated scale matrix.
+   * @param cursor The playback state of the caller.
+   * @return The interpolated scale.
    */
-  glm::mat4 InterpolateScale(glm::float64 animation_time);
+  glm::vec3 InterpolateScale(glm::float64 animation_time,
+                             Cursor& cursor) const;
 
  private:
-  std::vector<KeyPosition> positions_;
-  std::vector<KeyRotation> rotations_;
-  std::vector<KeyScale> scales_;
+  KeyframeCompression::VectorTrack positions_;
+  KeyframeCompression::RotationTrack rotations_;
+  KeyframeCompression::VectorTrack scales_;
+  KeyframeCompression::Report report_;
 
-  glm::mat4 local_transform_;
   std::string bone_name_;
   glm::int32 bone_id_;
 };
@@ -0,0 +1,130 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_BONEPALETTEBUFFER_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_BONEPALETTEBUFFER_H_
+
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "Animator.h"
+#include "../Buffers.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The BonePaletteBuffer class holds the bone matrices of many animated
+ * characters in one GPU buffer. Every frame the buffer is mapped, the
+ * animators are updated in parallel by AnimationBatch and each worker
+ * copies its palettes straight into the mapping, without a staging copy on
+ * the render thread.
+ *
+ * Shaders read the buffer through a texture buffer of RGBA32F texels, so
+ * there is no limit on the number of bones and no per bone uniform calls:
+ * @code
+ * uniform samplerBuffer bone_palette;
+ * uniform int bone_offset;
+ * @endcode
+ * bone_offset is the first bone of the drawn character, see GetOffset. The
+ * palette format decides how many texels a bone takes: four for a mat4,
+ * three for a 3x4 matrix and two for a dual quaternion. The skinning shader
+ * has to match it, e.g. animation_model_3x4.vert for kMatrix3x4.
+ *
+ * Usage example:
+ * @code
+ * BonePaletteBuffer palettes(PaletteFormat::kMatrix3x4);
+ * palettes.Update(animators, delta_time);
+ * palettes.Bind(shader);
+ * shader.SetInt("bone_offset", palettes.GetOffset(i));
+ * @endcode
+ */
+class BonePaletteBuffer {
+ public:
+  // The texture unit of bone_palette, the first one after the material units.
+  static constexpr GLuint kTextureUnit = 16;
+
+  /**
+   * Constructs an empty palette buffer.
+   * @param format The layout of each bone transform.
+   */
+  explicit BonePaletteBuffer(PaletteFormat format = PaletteFormat::kMatrix4x4);
+
+  /**
+   * Deletes the texture buffer view.
+   */
+  ~BonePaletteBuffer();
+
+  BonePaletteBuffer(const BonePaletteBuffer&) = delete;
+
+  BonePaletteBuffer& operator=(const BonePaletteBuffer&) = delete;
+
+  /**
+   * Advances the animators and uploads all their palettes, replacing the
+   * previous ones.
+   * @param animators The animators to update. Null entries are skipped.
+   * @param delta_time The time passed since the last update.
+   */
+  void Update(const std::vector<Animator*>& animators,
+              glm::float64 delta_time);
+
+  /**
+   * Binds the palettes to kTextureUnit and points the shader's
+   * "bone_palette" sampler at it. The shader must be in use.
+   * @param shader The skinning shader.
+   */
+  void Bind(Shader& shader) const;
+
+  /**
+   * Retrieves the first bone of an animator's palette.
+   * @param index The index of the animator in the last Update.
+   * @return The offset in bones.
+   */
+  glm::uint32 GetOffset(std::size_t index) const;
+
+  /**
+   * Retrieves the number of bone transforms uploaded last.
+   * @return The bone count.
+   */
+  glm::uint32 GetBoneCount() const;
+
+  /**
+   * Retrieves the layout of each bone transform.
+   * @return The palette format.
+   */
+  PaletteFormat GetFormat() const;
+
+  /**
+   * Retrieves the OpenGL name of the underlying buffer.
+   * @return The buffer id.
+   */
+  GLuint GetBufferId() const;
+
+ private:
+  Buffers buffer_;
+  // Texture buffer view of buffer_.
+  GLuint texture_;
+  PaletteFormat format_;
+  // Bones uploaded last and bones the buffer can hold.
+  glm::uint32 count_;
+  glm::uint32 capacity_;
+  std::vector<glm::uint32> offsets_;
+  // Packs one palette when the buffer can not be mapped.
+  std::vector<glm::vec4> staging_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_BONEPALETTEBUFFER_H_
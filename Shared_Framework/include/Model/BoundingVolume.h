@@ -0,0 +1,174 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_BOUNDINGVOLUME_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_BOUNDINGVOLUME_H_
+
+#include <limits>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "MeshData.h"
+
+namespace model {
+/**
+ * An axis aligned bounding box in the local space of the geometry it 
+ * encloses. An empty box has its minimum corner above its maximum corner.
+ */
+struct AxisAlignedBox {
+  // The minimum corner of the box.
+  glm::vec3 min = glm::vec3(std::numeric_limits<glm::float32>::max());
+  // The maximum corner of the box.
+  glm::vec3 max = glm::vec3(std::numeric_limits<glm::float32>::lowest());
+
+  /**
+   * Checks whether the box encloses anything.
+   * @return True if the box has never been expanded, false otherwise.
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Grows the box to include a point.
+   * @param point The point to include.
+   */
+  void Expand(const glm::vec3& point);
+
+  /**
+   * Grows the box to include another box.
+   * @param box The box to include.
+   */
+  void Expand(const AxisAlignedBox& box);
+
+  /**
+   * Retrieves the center of the box.
+   * @return The center of the box.
+   */
+  glm::vec3 GetCenter() const;
+
+  /**
+   * Retrieves the half size of the box along each axis.
+   * @return The half extents of the box.
+   */
+  glm::vec3 GetExtents() const;
+
+  /**
+   * Computes the axis aligned box enclosing this box after it has been 
+   * transformed by the given matrix.
+   * @param transform The matrix that moves the box into the new space.
+   * @return The transformed box.
+   */
+  AxisAlignedBox Transform(const glm::mat4& transform) const;
+
+  /**
+   * Computes the box enclosing all vertex positions.
+   * @param vertices The vertices to enclose.
+   * @return The enclosing box, empty if there are no vertices.
+   */
+  static AxisAlignedBox FromVertices(
+      const std::vector<meshdata::Vertex>& vertices);
+};
+
+/**
+ * A bounding sphere in the local space of the geometry it encloses. An empty 
+ * sphere has a negative radius.
+ */
+struct BoundingSphere {
+  // The center of the sphere.
+  glm::vec3 center = glm::vec3(0.0f);
+  // The radius of the sphere, negative when the sphere is empty.
+  glm::float32 radius = -1.0f;
+
+  /**
+   * Checks whether the sphere encloses anything.
+   * @return True if the sphere has never been expanded, false otherwise.
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Computes a sphere that encloses this sphere after it has been transformed 
+   * by the given matrix. Non-uniform scales are handled conservatively by 
+   * using the largest axis scale.
+   * @param transform The matrix that moves the sphere into the new space.
+   * @return The transformed sphere.
+   */
+  BoundingSphere Transform(const glm::mat4& transform) const;
+
+  /**
+   * Computes a sphere enclosing all vertex positions. Ritter's algorithm is 
+   * used, which is not minimal but is within a few percent of it and runs in 
+   * linear time.
+   * @param vertices The vertices to enclose.
+   * @return The enclosing sphere, empty if there are no vertices.
+   */
+  static BoundingSphere FromVertices(
+      const std::vector<meshdata::Vertex>& vertices);
+
+  /**
+   * Computes a sphere enclosing all points, see FromVertices.
+   * @param points The points to enclose.
+   * @return The enclosing sphere, empty if there are no points.
+   */
+  static BoundingSphere FromPoints(const std::vector<glm::vec3>& points);
+};
+
+/**
+ * Conservative bounds of skinned geometry. Every bone keeps the box of the
+ * bind pose vertices it influences. A skinned vertex is a weighted average
+ * of its position moved by each influencing bone matrix, so as long as the
+ * weights sum to one it lies inside the union of the bone boxes moved by
+ * their bone matrices. That union is cheap enough to build every frame from
+ * the bone palette.
+ */
+struct SkinnedBounds {
+  // The box of the vertices each bone influences, in bind pose model space,
+  // indexed by bone id.
+  std::vector<AxisAlignedBox> bone_boxes;
+  // The box of the vertices no bone influences, which never move.
+  AxisAlignedBox unskinned_box;
+
+  /**
+   * Checks whether the bounds enclose anything.
+   * @return True if there are no vertices, false otherwise.
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Grows the bounds to include other bounds, bone by bone.
+   * @param bounds The bounds to include.
+   */
+  void Expand(const SkinnedBounds& bounds);
+
+  /**
+   * Computes the box enclosing the geometry in a pose. Bones without a
+   * matrix are ignored.
+   * @param bone_matrices The final bone matrices of the pose, indexed by
+   * bone id.
+   * @return The posed box in model space.
+   */
+  AxisAlignedBox Pose(const std::vector<glm::mat4>& bone_matrices) const;
+
+  /**
+   * Computes the bone boxes of vertices. Influences with a zero weight are
+   * ignored.
+   * @param vertices The skinned vertices.
+   * @return The bounds, empty if there are no vertices.
+   */
+  static SkinnedBounds FromVertices(
+      const std::vector<meshdata::Vertex>& vertices);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_BOUNDINGVOLUME_H_
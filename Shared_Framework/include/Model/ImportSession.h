@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_IMPORTSESSION_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_IMPORTSESSION_H_
+
+#include <string>
+#include <vector>
+
+#include "assimp/Importer.hpp"
+#include "assimp/postprocess.h"
+#include "assimp/scene.h"
+#include "glm/glm.hpp"
+
+namespace model {
+/**
+ * The ImportSession class parses a model file once and keeps the Assimp
+ * scene alive, so the meshes, the node hierarchy and every animation clip
+ * of the file can be read from the same import.
+ *
+ * Usage example:
+ * @code
+ * ImportSession session(path, Model::GetImportFlags(options));
+ * Model model(session, options);
+ * auto clips = Animation::LoadAll(session, &model);
+ * @endcode
+ *
+ * @note The session holds the whole Assimp scene, so it should not outlive
+ * the loading code, unless an AnimationSet still decodes clips from it.
+ */
+class ImportSession {
+ public:
+  /**
+   * Parses a model file. A failed import leaves the scene null and keeps
+   * the Assimp error message.
+   * @param path The file path of the model file.
+   * @param flags The Assimp post processing flags.
+   */
+  ImportSession(const std::string& path, unsigned int flags);
+
+  ImportSession(const ImportSession&) = delete;
+
+  ImportSession& operator=(const ImportSession&) = delete;
+
+  /**
+   * Retrieves the parsed scene.
+   * @return The scene, or nullptr if the import failed.
+   */
+  const aiScene* GetScene() const;
+
+  /**
+   * Retrieves the path of the parsed file.
+   * @return A const reference to the path.
+   */
+  const std::string& GetPath() const;
+
+  /**
+   * Retrieves the Assimp error message of a failed import.
+   * @return A const reference to the message.
+   */
+  const std::string& GetError() const;
+
+  /**
+   * Retrieves the number of animation clips in the file.
+   * @return The clip count.
+   */
+  glm::uint32 GetAnimationCount() const;
+
+  /**
+   * Retrieves the names of the animation clips in the file.
+   * @return The names, in clip order.
+   */
+  std::vector<std::string> GetAnimationNames() const;
+
+ private:
+  Assimp::Importer importer_;
+  const aiScene* scene_;
+  std::string path_;
+  std::string error_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_IMPORTSESSION_H_
@@ -0,0 +1,165 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_INSTANCEBUFFER_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_INSTANCEBUFFER_H_
+
+#include <vector>
+
+#include "BoundingVolume.h"
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "../Buffers.h"
+#include "../Frustum.h"
+#include "../VertexArray.h"
+
+namespace model {
+/**
+ * The InstanceBuffer class holds one model matrix per instance in a vertex
+ * buffer. Attached to a vertex array, the matrix feeds the attribute
+ * locations kFirstAttribute to kFirstAttribute + 3 with a divisor of 1, so
+ * a vertex shader reads it as
+ * @code
+ * layout (location = 7) in mat4 aInstanceMatrix;
+ * @endcode
+ * Optionally every instance also carries a vec4 of shader defined
+ * parameters, e.g. the time offset of a baked animation, at
+ * kParameterAttribute:
+ * @code
+ * layout (location = 11) in vec4 aInstanceParameters;
+ * @endcode
+ *
+ * Usage example:
+ * @code
+ * InstanceBuffer instances;
+ * instances.SetTransforms(transforms);
+ * model.DrawInstanced(shader, instances, instances.GetCount());
+ * @endcode
+ */
+class InstanceBuffer {
+ public:
+  // First of the four attribute locations holding the instance matrix.
+  static constexpr GLuint kFirstAttribute = 7;
+  // The attribute location of the per instance parameters.
+  static constexpr GLuint kParameterAttribute = 11;
+
+  /**
+   * Constructs an empty instance buffer.
+   */
+  InstanceBuffer();
+
+  InstanceBuffer(const InstanceBuffer&) = delete;
+
+  InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+
+  /**
+   * Uploads the instance transforms, replacing the previous ones.
+   * @param transforms The model matrix of each instance.
+   */
+  void SetTransforms(const std::vector<glm::mat4>& transforms);
+
+  /**
+   * Uploads the instance transforms and parameters, replacing the previous
+   * ones.
+   * @param transforms The model matrix of each instance.
+   * @param parameters The shader parameters of each instance, one per
+   * transform.
+   */
+  void SetTransforms(const std::vector<glm::mat4>& transforms,
+                     const std::vector<glm::vec4>& parameters);
+
+  /**
+   * Uploads only the instances whose bounds touch the frustum, packed to the
+   * front of the buffer.
+   * @param transforms The model matrix of each instance.
+   * @param bounds The bounding sphere of the instanced geometry in model
+   * space.
+   * @param frustum The view frustum in world space.
+   * @return The number of visible instances uploaded.
+   */
+  GLsizei SetVisibleTransforms(const std::vector<glm::mat4>& transforms,
+                               const BoundingSphere& bounds,
+                               const Frustum& frustum);
+
+  /**
+   * Uploads only the instances whose bounds touch the frustum, together with
+   * their parameters, packed to the front of the buffer.
+   * @param transforms The model matrix of each instance.
+   * @param parameters The shader parameters of each instance, one per
+   * transform.
+   * @param bounds The bounding sphere of the instanced geometry in model
+   * space.
+   * @param frustum The view frustum in world space.
+   * @return The number of visible instances uploaded.
+   */
+  GLsizei SetVisibleTransforms(const std::vector<glm::mat4>& transforms,
+                               const std::vector<glm::vec4>& parameters,
+                               const BoundingSphere& bounds,
+                               const Frustum& frustum);
+
+  /**
+   * Points the instance attributes of a vertex array at this buffer. The
+   * parameter attribute is disabled when no parameters were uploaded, so the
+   * shader reads (0, 0, 0, 1). The vertex array must be bound.
+   * @param vao The vertex array to attach to.
+   */
+  void AttachTo(const VertexArray& vao) const;
+
+  /**
+   * Retrieves the number of instances uploaded last.
+   * @return The instance count.
+   */
+  GLsizei GetCount() const;
+
+  /**
+   * Retrieves the OpenGL name of the underlying buffer.
+   * @return The buffer id.
+   */
+  GLuint GetBufferId() const;
+
+ private:
+  /**
+   * Uploads count matrices, growing the buffer when needed.
+   * @param data The matrices to upload.
+   * @param count The number of matrices.
+   */
+  void Upload(const glm::mat4* data, GLsizei count);
+
+  /**
+   * Uploads count parameters, growing the buffer when needed. A count of 0
+   * drops the parameters.
+   * @param data The parameters to upload.
+   * @param count The number of parameters.
+   */
+  void UploadParameters(const glm::vec4* data, GLsizei count);
+
+  Buffers buffer_;
+  GLsizei count_;
+  GLsizei capacity_;
+
+  Buffers parameter_buffer_;
+  GLsizei parameter_count_;
+  GLsizei parameter_capacity_;
+
+  // Reused by SetVisibleTransforms to avoid per frame allocations.
+  std::vector<glm::vec4> spheres_;
+  std::vector<glm::uint8> visible_;
+  std::vector<glm::mat4> compacted_;
+  std::vector<glm::vec4> compacted_parameters_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_INSTANCEBUFFER_H_
@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_KEYFRAMECOMPRESSION_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_KEYFRAMECOMPRESSION_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+#include "glm/gtc/type_precision.hpp"
+
+namespace model {
+/**
+ * The KeyframeCompression class shrinks the key tracks of an animation
+ * channel in two steps:
+ * - key reduction drops every key that linear interpolation (spherical for
+ *   rotations) between the kept neighbours reproduces within a tolerance;
+ * - quantization stores rotations with the smallest three encoding in 48
+ *   bits, and translations and scales as 16 bit values normalized to the
+ *   range of the track.
+ * A track is stored as structure of arrays: the key times in one array, the
+ * encoded values in another. Tracks are decoded while they are sampled.
+ *
+ * Usage example:
+ * @code
+ * KeyframeCompression::Report report;
+ * auto track = KeyframeCompression::CompressVectors(times, positions, 1e-3f,
+ *                                                   &report);
+ * glm::uint32 cursor = 0;
+ * glm::vec3 position = KeyframeCompression::Sample(track, time, cursor);
+ * @endcode
+ */
+class KeyframeCompression {
+ public:
+  /**
+   * Tolerances of the key reduction. A negative tolerance keeps every key,
+   * only quantizing it.
+   */
+  struct Settings {
+    // Largest position error of a dropped key, in model units.
+    glm::float32 position_tolerance = 1e-3f;
+    // Largest rotation error of a dropped key, in radians.
+    glm::float32 rotation_tolerance = 1e-3f;
+    // Largest scale error of a dropped key.
+    glm::float32 scale_tolerance = 1e-3f;
+  };
+
+  /**
+   * Size and accuracy of compressed tracks, measured against their source
+   * keys.
+   */
+  struct Report {
+    glm::uint32 source_keys = 0;
+    glm::uint32 stored_keys = 0;
+    std::size_t source_bytes = 0;
+    std::size_t compressed_bytes = 0;
+    glm::float32 max_position_error = 0.0f;
+    glm::float32 max_rotation_error = 0.0f;
+    glm::float32 max_scale_error = 0.0f;
+
+    /**
+     * Adds the counters of another report to this one.
+     * @param other The report to add.
+     */
+    void Merge(const Report& other);
+
+    /**
+     * Retrieves the source size divided by the compressed size.
+     * @return The compression ratio, 1 for empty tracks.
+     */
+    glm::float32 GetRatio() const;
+  };
+
+  // Translation or scale keys, normalized to [minimum, minimum + extent].
+  struct VectorTrack {
+    std::vector<glm::float32> times;
+    std::vector<glm::u16vec3> values;
+    glm::vec3 minimum = glm::vec3(0.0f);
+    glm::vec3 extent = glm::vec3(0.0f);
+
+    /**
+     * Decodes one key.
+     * @param index The index of the key.
+     * @return The value of the key.
+     */
+    glm::vec3 Decode(glm::uint32 index) const;
+  };
+
+  // Rotation keys in the smallest three encoding.
+  struct RotationTrack {
+    std::vector<glm::float32> times;
+    std::vector<glm::u16vec3> values;
+
+    /**
+     * Decodes one key.
+     * @param index The index of the key.
+     * @return The unit quaternion of the key.
+     */
+    glm::quat Decode(glm::uint32 index) const;
+  };
+
+  /**
+   * Reduces and quantizes a translation or scale track.
+   * @param times The key times, in ascending order.
+   * @param values The key values.
+   * @param tolerance The largest error of a dropped key, negative to keep
+   * every key.
+   * @param report If not null, the sizes are added to it.
+   * @param max_error If not null, receives the largest error of the result.
+   * @return The compressed track.
+   */
+  static VectorTrack CompressVectors(const std::vector<glm::float64>& times,
+                                     const std::vector<glm::vec3>& values,
+                                     glm::float32 tolerance,
+                                     Report* report = nullptr,
+                                     glm::float32* max_error = nullptr);
+
+  /**
+   * Reduces and quantizes a rotation track.
+   * @param times The key times, in ascending order.
+   * @param values The key rotations.
+   * @param tolerance The largest error of a dropped key in radians, negative
+   * to keep every key.
+   * @param report If not null, the sizes are added to it.
+   * @param max_error If not null, receives the largest error of the result in
+   * radians.
+   * @return The compressed track.
+   */
+  static RotationTrack CompressRotations(const std::vector<glm::float64>& times,
+                                         const std::vector<glm::quat>& values,
+                                         glm::float32 tolerance,
+                                         Report* report = nullptr,
+                                         glm::float32* max_error = nullptr);
+
+  /**
+   * Interpolates a translation or scale track. The track must not be empty.
+   * @param track The track to sample.
+   * @param time The animation time, clamped to the track.
+   * @param cursor The key used last, updated to the key used now.
+   * @return The interpolated value.
+   */
+  static glm::vec3 Sample(const VectorTrack& track, glm::float64 time,
+                          glm::uint32& cursor);
+
+  /**
+   * Interpolates a rotation track. The track must not be empty.
+   * @param track The track to sample.
+   * @param time The animation time, clamped to the track.
+   * @param cursor The key used last, updated to the key used now.
+   * @return The interpolated rotation.
+   */
+  static glm::quat Sample(const RotationTrack& track, glm::float64 time,
+                          glm::uint32& cursor);
+
+  /**
+   * Finds the key to interpolate from. The cursor is tried first, then the
+   * key after it, and only then the times are binary searched.
+   * @param times The key times, in ascending order.
+   * @param time The animation time.
+   * @param cursor The key used last, updated to the key found.
+   * @return The index of the key, at most times.size() - 2, or 0 for tracks
+   * with fewer than two keys.
+   */
+  static glm::uint32 FindKey(const std::vector<glm::float32>& times,
+                             glm::float64 time, glm::uint32& cursor);
+
+  /**
+   * Encodes a rotation in 48 bits: the index of its largest component in 2
+   * bits and the three others in 15 bits each.
+   * @param rotation The rotation to encode.
+   * @return The packed rotation.
+   */
+  static glm::u16vec3 PackRotation(const glm::quat& rotation);
+
+  /**
+   * Decodes a rotation packed by PackRotation.
+   * @param packed The packed rotation.
+   * @return The unit quaternion.
+   */
+  static glm::quat UnpackRotation(const glm::u16vec3& packed);
+
+  /**
+   * Retrieves the memory used by a compressed track.
+   * @param track The track.
+   * @return The size in bytes.
+   */
+  static std::size_t GetByteSize(const VectorTrack& track);
+
+  /**
+   * Retrieves the memory used by a compressed track.
+   * @param track The track.
+   * @return The size in bytes.
+   */
+  static std::size_t GetByteSize(const RotationTrack& track);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_KEYFRAMECOMPRESSION_H_
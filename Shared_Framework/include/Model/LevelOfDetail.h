@@ -0,0 +1,68 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_LEVELOFDETAIL_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_LEVELOFDETAIL_H_
+
+#include "glm/glm.hpp"
+
+namespace model {
+/**
+ * A single level of detail of a mesh. All levels share the vertex buffer of 
+ * the mesh and live back to back in its element buffer, so switching levels 
+ * only changes the range passed to glDrawElements.
+ */
+struct LodLevel {
+  // Offset of the first index of this level in the element buffer.
+  glm::uint32 index_offset;
+  // Number of indices of this level.
+  glm::uint32 index_count;
+  // Simplification error of this level, relative to the mesh extent.
+  glm::float32 error;
+};
+
+/**
+ * Controls how a level of detail is picked from the projected size of a 
+ * mesh's bounding sphere.
+ * 
+ * Level 0 is used while the projected diameter is at least 
+ * full_detail_pixels, level 1 while it is at least half of that, and so on. 
+ * The hysteresis band keeps a mesh on its current level until the size has 
+ * moved clearly past a threshold, which avoids popping when a mesh sits right 
+ * on a boundary.
+ */
+struct LodSettings {
+  // Projected diameter in pixels down to which level 0 is kept.
+  glm::float32 full_detail_pixels = 256.0f;
+  // Fraction of a threshold the size must move past before switching.
+  glm::float32 hysteresis = 0.1f;
+  // Levels below this index are never selected.
+  glm::uint32 min_level = 0;
+
+  /**
+   * Selects a level for the given projected size.
+   * @param current_level The level used in the previous frame.
+   * @param level_count The number of levels available.
+   * @param screen_diameter The projected diameter of the bounding sphere in 
+   * pixels.
+   * @return The level to draw.
+   */
+  glm::uint32 SelectLevel(glm::uint32 current_level, glm::uint32 level_count,
+                          glm::float32 screen_diameter) const;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_LEVELOFDETAIL_H_
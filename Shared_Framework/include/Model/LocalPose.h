@@ -0,0 +1,96 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_LOCALPOSE_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_LOCALPOSE_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+namespace model {
+/**
+ * The LocalPose struct holds the local transform of every skeleton node as
+ * separate translation, rotation and scale arrays, in the node order of
+ * Animation::GetSkeleton. Poses of clips sharing a skeleton are mixed node
+ * by node in flat loops, before a single pass over the hierarchy turns the
+ * result into bone matrices. Translations and scales are padded to four
+ * floats, so each part of a node fills one SSE register.
+ */
+struct LocalPose {
+  // The translation of every node in xyz, w is unused.
+  std::vector<glm::vec4> translations;
+  std::vector<glm::quat> rotations;
+  // The scale of every node in xyz, w is unused.
+  std::vector<glm::vec4> scales;
+
+  /**
+   * Resizes the pose, new nodes get the identity transform.
+   * @param count The number of nodes.
+   */
+  void Resize(std::size_t count);
+
+  /**
+   * Retrieves the number of nodes.
+   * @return The node count.
+   */
+  std::size_t GetSize() const;
+
+  /**
+   * Sets the transform of a node from an affine matrix without shear.
+   * @param node The index of the node.
+   * @param matrix The local transformation matrix.
+   */
+  void SetMatrix(std::size_t node, const glm::mat4& matrix);
+
+  /**
+   * Builds the local transformation matrix of a node.
+   * @param node The index of the node.
+   * @return The matrix translate * rotate * scale.
+   */
+  glm::mat4 GetMatrix(std::size_t node) const;
+
+  /**
+   * Blends two poses: translations and scales are interpolated linearly and
+   * rotations normalized linearly along the shorter arc (nlerp).
+   * @param from The pose at weight 0.
+   * @param to The pose at weight 1.
+   * @param weight The blend weight.
+   * @param mask Multiplies the weight per node, empty for every node.
+   * @param result Receives the blended pose. It may be from or to.
+   */
+  static void Blend(const LocalPose& from, const LocalPose& to,
+                    glm::float32 weight, const std::vector<glm::float32>& mask,
+                    LocalPose& result);
+
+  /**
+   * Adds the difference between an additive pose and its reference pose,
+   * e.g. a breathing clip and its first frame, on top of a base pose.
+   * @param base The pose to add to.
+   * @param additive The additive pose.
+   * @param reference The pose the additive one is relative to.
+   * @param weight The weight of the difference.
+   * @param mask Multiplies the weight per node, empty for every node.
+   * @param result Receives the sum. It may be base.
+   */
+  static void Add(const LocalPose& base, const LocalPose& additive,
+                  const LocalPose& reference, glm::float32 weight,
+                  const std::vector<glm::float32>& mask, LocalPose& result);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_LOCALPOSE_H_
@@ -0,0 +1,117 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MATERIAL_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MATERIAL_H_
+
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "MeshData.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The Material class binds the textures of a mesh. Every texture gets a fixed
+ * texture unit when the material is built: the N-th texture of a type uses
+ * unit type * kMaxTexturesPerType + N - 1, so texture_diffuse1 is always on
+ * unit 0, texture_specular1 on unit 4, and so on.
+ *
+ * Because the units never change, the sampler uniforms of a shader program
+ * only need to be set once. The material remembers the programs it has
+ * prepared, and binding it afterwards is just one texture bind per texture,
+ * with no string work and no uniform calls.
+ *
+ * Usage example:
+ * @code
+ * Material material(textures);
+ * shader.Use();
+ * material.Bind(shader);
+ * @endcode
+ */
+class Material {
+ public:
+  // Largest number of textures of one type, e.g. texture_diffuse1..4.
+  static constexpr glm::uint32 kMaxTexturesPerType = 4;
+
+  /**
+   * Constructs an empty material.
+   */
+  Material() = default;
+
+  /**
+   * Constructs a material from textures and assigns their texture units.
+   * Textures beyond kMaxTexturesPerType of one type are ignored.
+   * @param textures The textures of the material.
+   */
+  explicit Material(const std::vector<meshdata::Texture>& textures);
+
+  /**
+   * Binds the textures to their units. The first time a shader program is
+   * seen, its sampler uniforms are pointed at the units.
+   * @param shader The shader the material is drawn with. It must be in use.
+   */
+  void Bind(const Shader& shader);
+
+  /**
+   * Retrieves the textures of the material.
+   * @return A const reference to the vector of textures.
+   */
+  const std::vector<meshdata::Texture>& GetTextures() const;
+
+  /**
+   * Retrieves the sampler uniform name of a texture, e.g. texture_diffuse1.
+   * @param type The type of the texture.
+   * @param number The one based number of the texture within its type.
+   * @return The sampler name.
+   */
+  static std::string GetSamplerName(meshdata::TextureType type,
+                                    glm::uint32 number);
+
+ private:
+  struct Binding {
+    // Texture ID in OpenGL
+    GLuint texture_id;
+    // Texture unit the texture is bound to
+    GLint unit;
+    // Sampler uniform the unit is assigned to
+    std::string sampler_name;
+  };
+
+  struct ProgramSamplers {
+    GLuint program;
+    // Location of each binding's sampler, -1 if the program lacks it.
+    std::vector<GLint> locations;
+  };
+
+  /**
+   * Resolves the sampler locations of a program and points them at the
+   * texture units.
+   * @param program The shader program to prepare.
+   * @return The resolved sampler locations.
+   */
+  const ProgramSamplers& PrepareProgram(GLuint program);
+
+  std::vector<meshdata::Texture> textures_;
+  std::vector<Binding> bindings_;
+  // Programs whose samplers have been set. Few shaders draw the same mesh,
+  // so a linear search is enough.
+  std::vector<ProgramSamplers> programs_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MATERIAL_H_
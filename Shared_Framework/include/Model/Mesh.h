@@ -17,15 +17,23 @@
 #ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MESH_H_
 #define CMAKE_OPEN_INCLUDES_INCLUDE_MESH_H_
 
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
+#include "BoundingVolume.h"
+#include "InstanceBuffer.h"
+#include "LevelOfDetail.h"
+#include "Material.h"
 #include "MeshData.h"
+#include "Meshlet.h"
+#include "MorphTargets.h"
 #include "glad/glad.h"
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "../Buffers.h"
+#include "../Frustum.h"
 #include "../Shader.h"
 #include "../VertexArray.h"
 #include "Core/MacroDefinition.h"
@@ -53,15 +61,41 @@ namespace model {
  */
 class Mesh {
  public:
+  /**
+   * How much of its geometry a mesh keeps in system memory once the data is
+   * uploaded to the GPU.
+   */
+  enum class CpuDataPolicy : glm::uint8 {
+    // Keep the vertices and indices.
+    kKeepAll = 0,
+    // Keep only the vertex positions and the indices, e.g. for picking.
+    kKeepPositions = 1,
+    // Keep nothing; the data is read back from the buffers on demand.
+    kRelease = 2
+  };
+
+  /**
+   * Bytes of geometry a mesh holds in system memory and on the GPU.
+   */
+  struct MemoryUsage {
+    glm::uint64 cpu_bytes = 0;
+    glm::uint64 gpu_bytes = 0;
+  };
+
   /**
    * Constructs a Mesh object with the given vertices, indices, and textures.
    * @param vertices The vertex data for the mesh.
    * @param indices The index data for the mesh.
    * @param texture The texture data for the mesh.
+   * @param lod_indices Index lists of the simplified levels of detail, from 
+   * finest to coarsest. They must reference the same vertices.
+   * @param lod_errors The simplification error of each level in lod_indices.
    */
   explicit Mesh(const std::vector<meshdata::Vertex>& vertices,
                 const std::vector<glm::uint32>& indices,
-                const std::vector<meshdata::Texture>& texture);
+                const std::vector<meshdata::Texture>& texture,
+                const std::vector<std::vector<glm::uint32>>& lod_indices = {},
+                const std::vector<glm::float32>& lod_errors = {});
 
   Mesh(const Mesh&) = delete;
 
@@ -71,40 +105,150 @@ class Mesh {
 
   /**
    * Renders the mesh using the given shader. This function binds the necessary 
-   * textures and draws the mesh.
+   * textures and morph targets and draws the mesh.
    * @param shader The shader to use for rendering the mesh.
    */
   void Draw(Shader& shader);
 
+  /**
+   * Renders one level of detail of the mesh using the given shader.
+   * @param shader The shader to use for rendering the mesh.
+   * @param lod_level The level to draw, clamped to the available levels.
+   */
+  void Draw(Shader& shader, glm::uint32 lod_level);
+
+  /**
+   * Renders several instances of one level of detail in a single draw call. 
+   * The instance buffer is attached to the vertex array of the mesh first.
+   * @param shader The shader to use for rendering the mesh. It reads the 
+   * instance matrix at InstanceBuffer::kFirstAttribute.
+   * @param instance_buffer The per instance transforms.
+   * @param count The number of instances to draw.
+   * @param lod_level The level to draw, clamped to the available levels.
+   */
+  void DrawInstanced(Shader& shader, const InstanceBuffer& instance_buffer,
+                     GLsizei count, glm::uint32 lod_level = 0);
+
+  /**
+   * Issues the draw call of one level of detail without touching any other 
+   * state. The caller must have bound the shader, the material and the 
+   * vertex array of the mesh, as RenderQueue does.
+   * @param lod_level The level to draw, clamped to the available levels.
+   */
+  void DrawElements(glm::uint32 lod_level) const;
+
+  /**
+   * Binds the morph targets of the mesh, or turns morphing off for a mesh
+   * without any. Draw does this itself; callers of DrawElements must do it.
+   * @param shader The shader about to draw the mesh. It must be in use.
+   */
+  void BindMorphTargets(Shader& shader) const;
+
+  /**
+   * Renders the meshlets of the full detail level that pass the frustum and 
+   * normal cone tests. The visible meshlets are written to an indirect 
+   * buffer and drawn with a single glMultiDrawElementsIndirect call on 
+   * OpenGL 4.3 and above. Without meshlets the whole mesh is drawn, and so
+   * is a mesh with morph targets, whose meshlet bounds and normal cones only
+   * hold the base shape.
+   * @param shader The shader to use for rendering the mesh.
+   * @param frustum The view frustum in the model space of the mesh.
+   * @param camera_position The camera position in the model space of the 
+   * mesh.
+   * @param index_count If not null, receives the number of indices drawn.
+   * @return The number of meshlets drawn.
+   */
+  glm::uint32 DrawMeshlets(Shader& shader, const Frustum& frustum,
+                           const glm::vec3& camera_position,
+                           glm::uint32* index_count = nullptr);
+
+  /**
+   * Picks the level of detail for the given projected size. The mesh may be
+   * drawn by several instances, so the caller keeps the level it drew last
+   * and passes it back for the hysteresis of the settings.
+   * @param screen_diameter The projected diameter of the bounding sphere in 
+   * pixels.
+   * @param settings The level selection settings.
+   * @param current_level The level the caller drew the mesh at last.
+   * @return The selected level.
+   */
+  glm::uint32 SelectLod(glm::float32 screen_diameter,
+                        const LodSettings& settings,
+                        glm::uint32 current_level) const;
+
   /**
    * Destructor for the Mesh class.Cleans up the allocated resources.
    */
   ~Mesh() = default;
 
   /**
-   * Gets the vertices of the mesh.
+   * Gets the vertices of the mesh. If they were released, they are read back
+   * from the vertex buffer first, which needs the OpenGL context.
    * @return A const reference to the vector of vertices.
    */
   const std::vector<meshdata::Vertex>& GetVertices() const;
 
   /**
-   * Sets the vertices of the mesh.
+   * Sets the vertices of the mesh. The mesh keeps all its data in system
+   * memory afterwards.
    * @param vertices The new vertices for the mesh.
    */
   void SetVertices(const std::vector<meshdata::Vertex>& vertices);
 
   /**
-   * Gets the indices of the mesh.
+   * Gets the full detail indices of the mesh. If they were released, they
+   * are read back from the element buffer first, which needs the OpenGL
+   * context.
    * @return A const reference to the vector of indices.
    */
   const std::vector<glm::uint32>& GetIndices() const;
 
   /**
-   * Sets the indices of the mesh.
+   * Sets the indices of the mesh. The meshlets and the levels of detail were 
+   * built from the old indices, so they are discarded. The mesh keeps all
+   * its data in system memory afterwards.
    * @param indices The new indices for the mesh.
    */
   void SetIndices(const std::vector<glm::uint32>& indices);
 
+  /**
+   * Gets the vertex positions of the mesh, extracted from the vertices on
+   * the first call.
+   * @return A const reference to the vector of positions.
+   */
+  const std::vector<glm::vec3>& GetPositions() const;
+
+  /**
+   * Gets the number of uploaded vertices, without touching the CPU copies.
+   * @return The vertex count.
+   */
+  glm::uint32 GetVertexCount() const;
+
+  /**
+   * Gets the number of full detail indices, without touching the CPU copies.
+   * @return The index count.
+   */
+  glm::uint32 GetIndexCount() const;
+
+  /**
+   * Drops or restores the system memory copies of the geometry. Released
+   * data stays valid on the GPU and is read back when requested.
+   * @param policy What to keep in system memory.
+   */
+  void SetCpuDataPolicy(CpuDataPolicy policy);
+
+  /**
+   * Gets the policy applied last by SetCpuDataPolicy.
+   * @return The policy.
+   */
+  CpuDataPolicy GetCpuDataPolicy() const;
+
+  /**
+   * Gets the memory held by the geometry of the mesh.
+   * @return The bytes in system memory and on the GPU.
+   */
+  MemoryUsage GetMemoryUsage() const;
+
   /**
    * Gets the textures of the mesh.
    * @return A const reference to the vector of textures.
@@ -123,6 +267,76 @@ class Mesh {
    */
   const VertexArray& GetVao() const;
 
+  /**
+   * Gets the OpenGL name of the vertex buffer, one meshdata::Vertex per
+   * vertex.
+   * @return The buffer id.
+   */
+  GLuint GetVertexBufferId() const;
+
+  /**
+   * Gets the OpenGL name of the index buffer, all levels of detail.
+   * @return The buffer id.
+   */
+  GLuint GetIndexBufferId() const;
+
+  /**
+   * Gets the material binding the textures of the mesh.
+   * @return A reference to the material.
+   */
+  Material& GetMaterial();
+
+  /**
+   * Gets the levels of detail of the mesh. Level 0 is the full detail mesh.
+   * @return A const reference to the vector of levels.
+   */
+  const std::vector<LodLevel>& GetLodLevels() const;
+
+  /**
+   * Gets the bounding sphere of the mesh in model space.
+   * @return A const reference to the bounding sphere.
+   */
+  const BoundingSphere& GetBoundingSphere() const;
+
+  /**
+   * Gets the axis aligned bounding box of the mesh in model space.
+   * @return A const reference to the bounding box.
+   */
+  const AxisAlignedBox& GetBoundingBox() const;
+
+  /**
+   * Gets the per bone boxes of the mesh, for bounds that follow a pose.
+   * @return A const reference to the skinned bounds, empty bone boxes for a
+   * mesh without bones.
+   */
+  const SkinnedBounds& GetSkinnedBounds() const;
+
+  /**
+   * Gets the meshlets of the full detail level.
+   * @return A const reference to the vector of meshlets.
+   */
+  const std::vector<Meshlet>& GetMeshlets() const;
+
+  /**
+   * Sets the meshlets of the full detail level. Each meshlet must cover a 
+   * contiguous range of the indices, as produced by MeshletBuilder.
+   * @param meshlets The new vector of meshlets.
+   */
+  void SetMeshlets(const std::vector<Meshlet>& meshlets);
+
+  /**
+   * Gets the blend shapes of the mesh.
+   * @return A pointer to the morph targets, or nullptr without any.
+   */
+  const MorphTargets* GetMorphTargets() const;
+
+  /**
+   * Sets the blend shapes of the mesh, bound by Draw and DrawInstanced.
+   * They must be compressed from the vertices of this mesh.
+   * @param morph_targets The uploaded morph targets, or nullptr to drop them.
+   */
+  void SetMorphTargets(std::unique_ptr<MorphTargets> morph_targets);
+
  private:
   /**
    * Sets up the mesh for rendering.This function initializes the vertex 
@@ -130,18 +344,61 @@ class Mesh {
    */
   void SetupMesh();
 
+
+  /**
+   * Rebuilds the level table from the full detail indices and the simplified 
+   * index lists, and packs the simplified indices for upload.
+   * @param lod_indices Index lists of the simplified levels.
+   * @param lod_errors The simplification error of each simplified level.
+   */
+  void BuildLodLevels(const std::vector<std::vector<glm::uint32>>& lod_indices,
+                      const std::vector<glm::float32>& lod_errors);
+
+  /**
+   * Reads the vertices back from the vertex buffer if they were released.
+   */
+  void RestoreVertices() const;
+
+  /**
+   * Reads the indices of every level back from the element buffer if they
+   * were released.
+   */
+  void RestoreIndices() const;
+
+  /**
+   * Fills the positions from the vertices if they are not extracted yet.
+   */
+  void ExtractPositions() const;
+
  private:
   /*
    * Mesh data 
    */
-  std::vector<meshdata::Vertex> vertices_;
-  std::vector<glm::uint32> indices_;
-  std::vector<meshdata::Texture> textures_;
+  // Read back lazily after SetCpuDataPolicy released them.
+  mutable std::vector<meshdata::Vertex> vertices_;
+  mutable std::vector<glm::uint32> indices_;
+  mutable std::vector<glm::vec3> positions_;
+  Material material_;
+  // Indices of all simplified levels, stored back to back after indices_.
+  mutable std::vector<glm::uint32> lod_indices_;
+  // Sizes of the uploaded data, valid when the CPU copies are released.
+  glm::uint32 vertex_count_;
+  glm::uint32 buffer_index_count_;
+  CpuDataPolicy cpu_data_policy_;
+  std::vector<LodLevel> lod_levels_;
+  BoundingSphere bounding_sphere_;
+  AxisAlignedBox bounding_box_;
+  SkinnedBounds skinned_bounds_;
+  std::vector<Meshlet> meshlets_;
+  std::unique_ptr<MorphTargets> morph_targets_;
   /*
    * Render data 
    */
   VertexArray vao_;
   Buffers vbo_, ebo_;
+  // Created on the first DrawMeshlets call.
+  std::unique_ptr<Buffers> indirect_buffer_;
+  std::vector<meshdata::DrawElementsIndirectCommand> draw_commands_;
 
   mutable std::mutex mesh_mutex_;
 };
@@ -42,11 +42,29 @@ struct Vertex {
   glm::float32 weights[kMaxBoneInfluence];
 };
 
+/**
+ * Layout of one command in a GL_DRAW_INDIRECT_BUFFER consumed by 
+ * glMultiDrawElementsIndirect.
+ */
+struct DrawElementsIndirectCommand {
+  glm::uint32 count;
+  glm::uint32 instance_count;
+  glm::uint32 first_index;
+  glm::int32 base_vertex;
+  glm::uint32 base_instance;
+};
+
+/**
+ * The role of a texture in a material. The values index the texture unit 
+ * blocks of Material, so keep them dense.
+ */
+enum class TextureType { kDiffuse = 0, kSpecular, kNormal, kHeight, kCount };
+
 struct Texture {
   // Texture ID in OpenGL
   glm::uint32 id;
   // Texture type
-  std::string type;
+  TextureType type;
   // Texture path
   std::string path;
 };
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MESHSIMPLIFIER_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MESHSIMPLIFIER_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "MeshData.h"
+
+namespace model {
+/**
+ * The MeshSimplifier class reduces the triangle count of an indexed triangle 
+ * mesh with quadric error metrics (Garland and Heckbert). Edges are collapsed 
+ * onto one of their existing end points, so a simplified mesh only produces a 
+ * new index buffer and keeps using the original vertex buffer.
+ * 
+ * Vertices on open borders and on attribute seams (several vertices sharing a 
+ * position) are never moved, which keeps the silhouette of open meshes and 
+ * prevents texture seams from tearing apart.
+ * 
+ * Usage example:
+ * @code
+ * std::vector<std::vector<glm::uint32>> lods;
+ * std::vector<glm::float32> errors;
+ * MeshSimplifier::GenerateLods(vertices, indices, 4, 0.5f, 0.05f, lods, 
+ * errors);
+ * @endcode
+ */
+class MeshSimplifier {
+ public:
+  /**
+   * Simplifies a mesh until the target index count is reached or no collapse 
+   * stays below the target error.
+   * @param vertices The vertex data of the mesh.
+   * @param indices The triangle list to simplify.
+   * @param target_index_count The desired number of indices.
+   * @param target_error The largest allowed error, relative to the extent of 
+   * the mesh.
+   * @param result_error If not null, receives the error of the result 
+   * relative to the extent of the mesh.
+   * @return The simplified triangle list.
+   */
+  static std::vector<glm::uint32> Simplify(
+      const std::vector<meshdata::Vertex>& vertices,
+      const std::vector<glm::uint32>& indices, std::size_t target_index_count,
+      glm::float32 target_error, glm::float32* result_error = nullptr);
+
+  /**
+   * Builds a chain of levels of detail, each one simplified from the previous 
+   * one. Generation stops early once a level no longer shrinks noticeably.
+   * @param vertices The vertex data of the mesh.
+   * @param indices The full detail triangle list.
+   * @param lod_count The number of levels to build, including the full 
+   * detail one.
+   * @param reduction The index count ratio between two consecutive levels.
+   * @param target_error The largest allowed error of the coarsest level.
+   * @param lods Receives the index lists of levels 1 and above.
+   * @param errors Receives the error of each level in lods.
+   */
+  static void GenerateLods(const std::vector<meshdata::Vertex>& vertices,
+                           const std::vector<glm::uint32>& indices,
+                           glm::uint32 lod_count, glm::float32 reduction,
+                           glm::float32 target_error,
+                           std::vector<std::vector<glm::uint32>>& lods,
+                           std::vector<glm::float32>& errors);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MESHSIMPLIFIER_H_
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MESHLET_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MESHLET_H_
+
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "MeshData.h"
+
+namespace model {
+/**
+ * A small cluster of neighbouring triangles of a mesh. Its triangles are a
+ * contiguous range of the mesh's element buffer, so a visible meshlet is
+ * drawn with a single glDrawElements range or one indirect command.
+ */
+struct Meshlet {
+  // Offset of the first index of the meshlet in the element buffer.
+  glm::uint32 index_offset;
+  // Number of indices of the meshlet.
+  glm::uint32 index_count;
+  // Center of the bounding sphere in model space.
+  glm::vec3 center;
+  // Radius of the bounding sphere.
+  glm::float32 radius;
+  // Average facing direction of the triangles.
+  glm::vec3 cone_axis;
+  // Sine of the largest angle between cone_axis and a triangle normal. A
+  // value of 1 means the triangles face too many ways to be back face culled.
+  glm::float32 cone_cutoff;
+
+  /**
+   * Checks whether every triangle of the meshlet faces away from a point.
+   * The test is conservative: it may keep a meshlet that is fully back
+   * facing, but never rejects one with a visible triangle.
+   * @param camera_position The viewer position in the meshlet's space.
+   * @return True if the meshlet can be skipped.
+   */
+  bool IsBackFacing(const glm::vec3& camera_position) const;
+};
+
+/**
+ * The MeshletBuilder class splits a triangle list into meshlets. Triangles
+ * are gathered greedily around a seed triangle, preferring the neighbours
+ * that add the fewest new vertices, so each meshlet stays compact and its
+ * sphere and normal cone stay tight.
+ *
+ * Usage example:
+ * @code
+ * std::vector<glm::uint32> meshlet_indices;
+ * auto meshlets = MeshletBuilder::Build(vertices, indices, meshlet_indices);
+ * // Upload meshlet_indices in place of indices.
+ * @endcode
+ */
+class MeshletBuilder {
+ public:
+  // Largest number of unique vertices referenced by one meshlet.
+  static constexpr glm::uint32 kMaxVertices = 64;
+  // Largest number of triangles in one meshlet.
+  static constexpr glm::uint32 kMaxTriangles = 124;
+
+  /**
+   * Builds the meshlets of a triangle list.
+   * @param vertices The vertex data of the mesh.
+   * @param indices The triangle list to split.
+   * @param meshlet_indices Receives the same triangles as indices, reordered
+   * so that each meshlet is a contiguous range.
+   * @return The meshlets, with offsets into meshlet_indices.
+   */
+  static std::vector<Meshlet> Build(
+      const std::vector<meshdata::Vertex>& vertices,
+      const std::vector<glm::uint32>& indices,
+      std::vector<glm::uint32>& meshlet_indices);
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MESHLET_H_
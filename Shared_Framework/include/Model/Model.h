@@ -17,15 +17,23 @@
 #ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MODEL_H_
 #define CMAKE_OPEN_INCLUDES_INCLUDE_MODEL_H_
 
+#include <atomic>
 #include <map>
+#include <memory>
+#include <utility>
 
 #include "BoneInfo.h"
+#include "ImportSession.h"
 #include "Mesh.h"
+#include "../LoadImage.h"
+#include "../RenderQueue.h"
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
 #include "assimp/scene.h"
 
 namespace model {
+class ModelLoadTask;
+
 /**
  * The Model class represents a 3D model loaded from an external file. It 
  * contains meshes, textures, and bone information. The class provides methods
@@ -34,6 +42,58 @@ namespace model {
  */
 class Model {
  public:
+  /**
+   * Options controlling how a model is imported.
+   */
+  struct LoadOptions {
+    // Whether to apply gamma correction to the textures.
+    bool gamma_correction = false;
+    // Number of levels of detail per mesh, including the full detail level. 
+    // A value of 1 disables simplification.
+    glm::uint32 lod_count = 1;
+    // Target index count of each level relative to the previous level.
+    glm::float32 lod_reduction = 0.5f;
+    // Largest simplification error allowed for the coarsest level, relative 
+    // to the extent of the mesh.
+    glm::float32 lod_target_error = 0.05f;
+    // Whether to split each mesh into meshlets for DrawMeshlets.
+    bool build_meshlets = false;
+    // What each mesh keeps in system memory after uploading its geometry.
+    Mesh::CpuDataPolicy cpu_data = Mesh::CpuDataPolicy::kKeepAll;
+  };
+
+  /**
+   * Memory held by the geometry of a model, summed over its meshes.
+   */
+  struct MemoryReport {
+    glm::uint32 mesh_count = 0;
+    glm::uint64 vertex_count = 0;
+    // Full detail indices; the levels of detail add to gpu_bytes only.
+    glm::uint64 index_count = 0;
+    glm::uint64 cpu_bytes = 0;
+    glm::uint64 gpu_bytes = 0;
+    glm::uint32 texture_count = 0;
+  };
+
+  /**
+   * Counters of the most recent draw call, used to judge how much the levels 
+   * of detail save.
+   */
+  struct DrawStatistics {
+    glm::uint32 meshes_drawn = 0;
+    // Meshes skipped because they are outside the view frustum.
+    glm::uint32 meshes_culled = 0;
+    glm::uint64 triangles_drawn = 0;
+    // Triangles that full detail would have drawn on top of triangles_drawn.
+    glm::uint64 triangles_saved = 0;
+    // Meshlets drawn and skipped by DrawMeshlets.
+    glm::uint32 meshlets_drawn = 0;
+    glm::uint32 meshlets_culled = 0;
+    // Instances drawn and skipped by DrawInstanced.
+    glm::uint32 instances_drawn = 0;
+    glm::uint32 instances_culled = 0;
+  };
+
   /**
    * Constructor for the Model class. Loads the model from the specified file 
    * path. Optionally applies gamma correction to the textures.
@@ -42,17 +102,219 @@ class Model {
    */
   explicit Model(const std::string& path, bool gamma = false);
 
+  /**
+   * Constructor for the Model class. Loads the model from the specified file 
+   * path and generates the requested levels of detail for each mesh.
+   * @param path The file path of the model file.
+   * @param options The import options.
+   */
+  Model(const std::string& path, const LoadOptions& options);
+
+  /**
+   * Constructor for the Model class. Builds the model from a file that is
+   * already parsed, so an Animation can read the same import.
+   * @param session The parsed file, opened with GetImportFlags(options).
+   * @param options The import options.
+   */
+  Model(const ImportSession& session, const LoadOptions& options);
+
   /**
    * Destructor for the Model class. Frees all allocated resources.
    */
   ~Model();
 
+  /**
+   * Starts loading a model on a worker thread. The worker imports the file
+   * and decodes the textures; the returned task uploads the results when
+   * its Update method is called on the OpenGL thread.
+   * @param path The file path of the model file.
+   * @param options The import options.
+   * @return The task tracking the load.
+   */
+  static std::shared_ptr<ModelLoadTask> LoadAsync(const std::string& path,
+                                                  const LoadOptions& options);
+
+  /**
+   * Starts loading a model on a worker thread with the default options.
+   * @param path The file path of the model file.
+   * @return The task tracking the load.
+   */
+  static std::shared_ptr<ModelLoadTask> LoadAsync(const std::string& path);
+
+  /**
+   * Retrieves the Assimp post processing flags a model with the given
+   * options is imported with.
+   * @param options The import options.
+   * @return The flags to open an ImportSession with.
+   */
+  static unsigned int GetImportFlags(const LoadOptions& options);
+
   /**
    * Draws the model using the given shader.
    * @param shader The shader to use for rendering the model.
    */
   void Draw(Shader& shader);
 
+  /**
+   * Draws the model using the given shader, skipping the meshes whose 
+   * bounding sphere is outside the view frustum.
+   * @param shader The shader to use for rendering the model.
+   * @param model_matrix The model matrix the shader is drawing with.
+   * @param view_projection The projection matrix multiplied by the view 
+   * matrix of the camera.
+   */
+  void Draw(Shader& shader, const glm::mat4& model_matrix,
+            const glm::mat4& view_projection);
+
+  /**
+   * Draws a posed skinned model, skipping the meshes whose posed bounds are
+   * outside the view frustum. The bind pose bounds used by the other Draw
+   * overloads can cull an animated mesh that has moved into view.
+   * @param shader The shader to use for rendering the model.
+   * @param model_matrix The model matrix the shader is drawing with.
+   * @param view_projection The projection matrix multiplied by the view 
+   * matrix of the camera.
+   * @param bone_matrices The final bone matrices of the pose.
+   */
+  void Draw(Shader& shader, const glm::mat4& model_matrix,
+            const glm::mat4& view_projection,
+            const std::vector<glm::mat4>& bone_matrices);
+
+  /**
+   * Draws the model using the given shader, skipping the meshes outside the 
+   * view frustum and picking a level of detail for each remaining mesh from 
+   * the projected size of its bounding sphere.
+   * @param shader The shader to use for rendering the model.
+   * @param model_matrix The model matrix the shader is drawing with.
+   * @param view The view matrix of the camera.
+   * @param projection The projection matrix of the camera.
+   * @param viewport_height The height of the viewport in pixels.
+   * @param mesh_lods The level each mesh was drawn at last, updated for the
+   * next call. The model may be shared, so every instance keeps its own.
+   */
+  void Draw(Shader& shader, const glm::mat4& model_matrix,
+            const glm::mat4& view, const glm::mat4& projection,
+            glm::float32 viewport_height, std::vector<glm::uint32>& mesh_lods);
+
+  /**
+   * Draws the model using the given shader, culling each mesh and then each 
+   * of its meshlets against the view frustum and their normal cones. Meshes 
+   * without meshlets are drawn whole once they pass the frustum test.
+   * @param shader The shader to use for rendering the model.
+   * @param model_matrix The model matrix the shader is drawing with.
+   * @param view_projection The projection matrix multiplied by the view 
+   * matrix of the camera.
+   * @param camera_position The camera position in world space.
+   */
+  void DrawMeshlets(Shader& shader, const glm::mat4& model_matrix,
+                    const glm::mat4& view_projection,
+                    const glm::vec3& camera_position);
+
+  /**
+   * Draws several instances of the model with one draw call per mesh.
+   * @param shader The shader to use for rendering the model. It reads the 
+   * instance matrix at InstanceBuffer::kFirstAttribute.
+   * @param instance_buffer The per instance transforms.
+   * @param count The number of instances to draw.
+   */
+  void DrawInstanced(Shader& shader, const InstanceBuffer& instance_buffer,
+                     GLsizei count);
+
+  /**
+   * Culls the instances against the view frustum, uploads the visible ones 
+   * and draws them with one draw call per mesh.
+   * @param shader The shader to use for rendering the model. It reads the 
+   * instance matrix at InstanceBuffer::kFirstAttribute.
+   * @param instance_buffer Receives the visible transforms.
+   * @param transforms The model matrix of every instance.
+   * @param view_projection The projection matrix multiplied by the view 
+   * matrix of the camera.
+   * @return The number of instances drawn.
+   */
+  GLsizei DrawInstanced(Shader& shader, InstanceBuffer& instance_buffer,
+                        const std::vector<glm::mat4>& transforms,
+                        const glm::mat4& view_projection);
+
+  /**
+   * Queues the meshes that are inside the view frustum instead of drawing 
+   * them, so they are sorted with the rest of the frame. Each mesh gets the
+   * level of detail the matching Draw overload would pick, and its morph
+   * targets are bound when the queue draws it.
+   * @param queue The queue to add the meshes to.
+   * @param shader The shader to draw the meshes with.
+   * @param model_matrix The model matrix of the model.
+   * @param view The view matrix of the camera.
+   * @param projection The projection matrix of the camera.
+   * @param viewport_height The height of the viewport in pixels.
+   * @param mesh_lods The level each mesh was drawn at last, updated for the
+   * next call.
+   * @param pass The pass the meshes are drawn in.
+   * @param morph_weight_offset The first blend shape weight of the drawn
+   * instance, -1 to leave morph_weight_offset as it is.
+   */
+  void Submit(RenderQueue& queue, Shader& shader,
+              const glm::mat4& model_matrix, const glm::mat4& view,
+              const glm::mat4& projection, glm::float32 viewport_height,
+              std::vector<glm::uint32>& mesh_lods,
+              RenderQueue::Pass pass = RenderQueue::Pass::kOpaque,
+              glm::int32 morph_weight_offset = -1);
+
+  /**
+   * Retrieves the settings used to select the levels of detail.
+   * @return A const reference to the level of detail settings.
+   */
+  const LodSettings& GetLodSettings() const;
+
+  /**
+   * Sets the settings used to select the levels of detail.
+   * @param lod_settings The new level of detail settings.
+   */
+  void SetLodSettings(const LodSettings& lod_settings);
+
+  /**
+   * Retrieves the bounding box enclosing all meshes in model space.
+   * @return A const reference to the bounding box.
+   */
+  const AxisAlignedBox& GetBoundingBox() const;
+
+  /**
+   * Retrieves the bounding sphere enclosing all meshes in model space.
+   * @return A const reference to the bounding sphere.
+   */
+  const BoundingSphere& GetBoundingSphere() const;
+
+  /**
+   * Retrieves the per bone boxes of all meshes, see SkinnedBounds::Pose.
+   * @return A const reference to the skinned bounds.
+   */
+  const SkinnedBounds& GetSkinnedBounds() const;
+
+  /**
+   * Retrieves the number of blend shape weights an instance of the model
+   * needs, the most targets of any mesh.
+   * @return The target count, 0 for a model without morph targets.
+   */
+  glm::uint32 GetMorphTargetCount() const;
+
+  /**
+   * Retrieves the counters of the most recent draw call.
+   * @return A const reference to the draw statistics.
+   */
+  const DrawStatistics& GetDrawStatistics() const;
+
+  /**
+   * Drops or restores the system memory copies of the geometry of every
+   * mesh.
+   * @param policy What to keep in system memory.
+   */
+  void SetCpuDataPolicy(Mesh::CpuDataPolicy policy);
+
+  /**
+   * Sums up the memory held by the geometry of the model.
+   * @return The memory report.
+   */
+  MemoryReport GetMemoryReport() const;
+
   /**
    * Retrieves the loaded textures.
    * @return A const reference to the vector of loaded textures.
@@ -114,38 +376,139 @@ class Model {
   void SetBoneCounter(glm::int32 bone_counter);
 
  private:
+  friend class ModelLoadTask;
+
   /**
-   * Loads the model from the specified file path.
-   * @param path The file path of the model file.
+   * A texture decoded by the import, waiting for its upload.
+   */
+  struct DecodedTexture {
+    // Path and role of the first use; the id is set by the upload.
+    meshdata::Texture texture;
+    LoadImage::DecodedImage image;
+    // Embedded textures are clamped instead of repeated.
+    bool embedded = false;
+  };
+
+  /**
+   * The geometry of a mesh built by the import, waiting for its upload.
+   */
+  struct DecodedMesh {
+    std::vector<meshdata::Vertex> vertices;
+    std::vector<glm::uint32> indices;
+    std::vector<std::vector<glm::uint32>> lod_indices;
+    std::vector<glm::float32> lod_errors;
+    std::vector<Meshlet> meshlets;
+    MorphTargets::SparseData morph_targets;
+    // Index into DecodedScene::textures and role of each texture.
+    std::vector<std::pair<std::size_t, meshdata::TextureType>> textures;
+
+    /**
+     * Computes the bytes the geometry takes in the vertex and element
+     * buffers.
+     * @return The size in bytes.
+     */
+    glm::uint64 GetUploadSize() const;
+  };
+
+  /**
+   * Everything the import produced, in upload order.
+   */
+  struct DecodedScene {
+    std::vector<DecodedTexture> textures;
+    std::vector<DecodedMesh> meshes;
+  };
+
+  /**
+   * Counters written by the import and read by other threads.
+   */
+  struct LoadProgress {
+    std::atomic<glm::uint32> meshes_parsed{0};
+    std::atomic<glm::uint32> meshes_total{0};
+    std::atomic<glm::uint32> textures_decoded{0};
+    std::atomic<glm::uint32> textures_total{0};
+    std::atomic<glm::uint64> bytes_uploaded{0};
+    std::atomic<glm::uint64> bytes_total{0};
+    // Set to stop the import between two meshes or textures.
+    std::atomic<bool> cancelled{false};
+  };
+
+  /**
+   * Constructs an empty model, filled later by a ModelLoadTask.
+   * @param options The import options.
+   */
+  explicit Model(const LoadOptions& options);
+
+  /**
+   * Loads the model from a parsed file.
+   * @param session The parsed model file.
+   */
+  void LoadModel(const ImportSession& session);
+
+  /**
+   * Builds the geometry of a parsed file and decodes its textures without
+   * calling OpenGL, so it can run on a worker thread.
+   * @param session The parsed model file.
+   * @param decoded Receives the decoded meshes and textures.
+   * @param progress The counters to update.
+   * @return False if the import was cancelled.
    */
-  void LoadModel(std::string const& path);
+  bool DecodeModel(const ImportSession& session, DecodedScene& decoded,
+                   LoadProgress& progress);
 
   /**
    * Processes a node in the model hierarchy.
    * @param node The AI node to process.
    * @param scene The AI scene containing the node.
+   * @param decoded Receives the decoded meshes and textures.
+   * @param progress The counters to update.
+   * @return False if the import was cancelled.
    */
-  void ProcessNode(aiNode* node, const aiScene* scene);
+  bool ProcessNode(aiNode* node, const aiScene* scene, DecodedScene& decoded,
+                   LoadProgress& progress);
 
   /**
-   * Processes a mesh and creates a Mesh object from the AI mesh data.
+   * Processes a mesh and builds its geometry from the AI mesh data.
    * @param mesh The AI mesh to process.
    * @param scene The AI scene containing the mesh.
-   * @return A pointer to the created Mesh object.
+   * @param decoded Receives the textures of the mesh.
+   * @param progress The counters to update.
+   * @return The decoded mesh, incomplete if the import was cancelled.
    */
-  Mesh* ProcessMesh(aiMesh* mesh, const aiScene* scene);
+  DecodedMesh ProcessMesh(aiMesh* mesh, const aiScene* scene,
+                          DecodedScene& decoded, LoadProgress& progress);
 
   /**
-   * Loads the textures associated with a material.
+   * Decodes the textures associated with a material. Textures already
+   * decoded for this model are shared.
    * @param mat The AI material containing the textures.
    * @param type The type of texture to load.
-   * @param type_name The name of the texture type.
+   * @param texture_type The role of the texture in the material.
    * @param scene The AI scene containing the material.
-   * @return A vector of Textures loaded from the material.
+   * @param decoded Receives the newly decoded textures.
+   * @param mesh Receives the textures of the material.
+   * @param progress The counters to update.
+   * @return False if the import was cancelled.
+   */
+  bool LoadMaterialTexture(aiMaterial* mat, aiTextureType type,
+                           meshdata::TextureType texture_type,
+                           const aiScene* scene, DecodedScene& decoded,
+                           DecodedMesh& mesh, LoadProgress& progress);
+
+  /**
+   * Uploads a decoded texture and frees its pixels.
+   * @param texture The decoded texture.
+   * @return The number of bytes uploaded.
    */
-  std::vector<meshdata::Texture> LoadMaterialTexture(
-      aiMaterial* mat, aiTextureType type, const std::string& type_name,
-      const aiScene* scene);
+  glm::uint64 UploadTexture(DecodedTexture& texture);
+
+  /**
+   * Creates a Mesh from decoded geometry and frees the geometry. The
+   * textures of the mesh must be uploaded already.
+   * @param mesh The decoded mesh.
+   * @param decoded The scene holding the textures of the mesh.
+   * @return The number of bytes uploaded.
+   */
+  glm::uint64 UploadMesh(DecodedMesh& mesh, const DecodedScene& decoded);
 
   /**
    * Sets the bone data for a vertex to default values.
@@ -171,6 +534,48 @@ class Model {
   void ExtractBoneWeightForVertices(std::vector<meshdata::Vertex>& vertices,
                                     aiMesh* mesh, const aiScene* scene);
 
+  /**
+   * Recomputes the model bounds from the bounds of its meshes.
+   */
+  void UpdateBounds();
+
+  /**
+   * Tests every mesh against the frustum of the given matrix and stores the 
+   * result in mesh_visibility_.
+   * @param model_view_projection The matrix mapping model space to clip 
+   * space.
+   */
+  void CullMeshes(const glm::mat4& model_view_projection);
+
+  /**
+   * Tests the posed box of every mesh against the frustum of the given
+   * matrix and stores the result in mesh_visibility_.
+   * @param model_view_projection The matrix mapping model space to clip 
+   * space.
+   * @param bone_matrices The final bone matrices of the pose.
+   */
+  void CullPosedMeshes(const glm::mat4& model_view_projection,
+                       const std::vector<glm::mat4>& bone_matrices);
+
+  /**
+   * Picks the level of detail of every visible mesh from the projected size
+   * of its bounding sphere.
+   * @param model_view The view matrix multiplied by the model matrix.
+   * @param projection The projection matrix of the camera.
+   * @param viewport_height The height of the viewport in pixels.
+   * @param mesh_lods The previous level of each mesh, receives the new one.
+   */
+  void SelectMeshLods(const glm::mat4& model_view, const glm::mat4& projection,
+                      glm::float32 viewport_height,
+                      std::vector<glm::uint32>& mesh_lods) const;
+
+  /**
+   * Adds a drawn level of a mesh to draw_statistics_.
+   * @param mesh The mesh.
+   * @param level The level of detail it was drawn at.
+   */
+  void CountDrawnLevel(const Mesh& mesh, glm::uint32 level);
+
  private:
   /*
    * Model data
@@ -183,6 +588,23 @@ class Model {
   std::string directory_;
   bool gamma_correction_;
 
+  /*
+   * Level of detail data
+   */
+  LoadOptions load_options_;
+  LodSettings lod_settings_;
+  DrawStatistics draw_statistics_;
+
+  /*
+   * Culling data
+   */
+  AxisAlignedBox bounding_box_;
+  BoundingSphere bounding_sphere_;
+  SkinnedBounds skinned_bounds_;
+  // Per mesh scratch buffers reused by every draw call.
+  std::vector<glm::vec4> mesh_spheres_;
+  std::vector<glm::uint8> mesh_visibility_;
+
   /*
    * Bone data 
    */
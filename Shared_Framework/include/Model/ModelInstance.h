@@ -0,0 +1,173 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MODELINSTANCE_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MODELINSTANCE_H_
+
+#include <memory>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "Animation.h"
+#include "Animator.h"
+#include "Model.h"
+
+namespace model {
+/**
+ * The ModelInstance class places a shared Model in the scene. It only owns
+ * a transform and, for animated models, an Animator; the meshes and
+ * materials stay with the model, so any number of instances cost about as
+ * much GPU memory as one.
+ *
+ * Usage example:
+ * @code
+ * ModelInstance instance(ModelLibrary::GetInstance().Load(path));
+ * instance.SetTransform(glm::translate(glm::mat4(1.0f), position));
+ * instance.UpdateAnimation(delta_time);
+ * instance.Draw(shader, projection * view);
+ * @endcode
+ */
+class ModelInstance {
+ public:
+  /**
+   * Constructs an instance of a model with an identity transform.
+   * @param model The model to instance.
+   */
+  explicit ModelInstance(std::shared_ptr<Model> model);
+
+  /**
+   * Draws the instance with frustum culling. The shader's "model" uniform is
+   * set to the instance transform and, for animated instances, "bone_offset"
+   * to the palette offset; "morph_weight_offset" is set once the instance
+   * has a weight offset. The palettes must be uploaded and bound with a
+   * BonePaletteBuffer. Animated instances are culled by their posed bounds.
+   * @param shader The shader to draw the instance with. It must be in use.
+   * @param view_projection The projection matrix multiplied by the view
+   * matrix of the camera.
+   */
+  void Draw(Shader& shader, const glm::mat4& view_projection);
+
+  /**
+   * Draws the instance like Draw, picking a level of detail for each mesh of
+   * a static instance from its projected size. The instance remembers the
+   * levels, so instances sharing the model keep their own hysteresis.
+   * Animated instances are drawn at full detail.
+   * @param shader The shader to draw the instance with. It must be in use.
+   * @param view The view matrix of the camera.
+   * @param projection The projection matrix of the camera.
+   * @param viewport_height The height of the viewport in pixels.
+   */
+  void Draw(Shader& shader, const glm::mat4& view, const glm::mat4& projection,
+            glm::float32 viewport_height);
+
+  /**
+   * Plays an animation on this instance, starting from its first frame.
+   * @param animation The animation to play. It may be shared with other
+   * instances of the model.
+   */
+  void SetAnimation(std::shared_ptr<const Animation> animation);
+
+  /**
+   * Sets the first matrix of the instance's pose in the bone palette buffer.
+   * @param offset The offset in matrices, from BonePaletteBuffer::GetOffset.
+   */
+  void SetPaletteOffset(glm::uint32 offset);
+
+  /**
+   * Sets the weight of one blend shape of the instance.
+   * @param target The target index, see MorphTargets::FindTarget.
+   * @param weight The weight, usually between 0 and 1.
+   */
+  void SetMorphWeight(glm::uint32 target, glm::float32 weight);
+
+  /**
+   * Retrieves the blend shape weights of the instance, for
+   * MorphWeightBuffer::Add.
+   * @return A const reference to the weights, in target order.
+   */
+  const std::vector<glm::float32>& GetMorphWeights() const;
+
+  /**
+   * Sets the first weight of the instance in the morph weight buffer.
+   * @param offset The offset returned by MorphWeightBuffer::Add.
+   */
+  void SetMorphWeightOffset(glm::uint32 offset);
+
+  /**
+   * Retrieves the first weight of the instance in the morph weight buffer.
+   * @return The offset, or -1 before SetMorphWeightOffset.
+   */
+  glm::int32 GetMorphWeightOffset() const;
+
+  /**
+   * Advances the animation of the instance. Does nothing without an
+   * animation.
+   * @param delta_time The time passed since the last update.
+   */
+  void UpdateAnimation(glm::float64 delta_time);
+
+  /**
+   * Retrieves the animator of the instance.
+   * @return A pointer to the animator, or nullptr without an animation.
+   */
+  Animator* GetAnimator() const;
+
+  /**
+   * Computes a world space box around the instance. Animated instances use
+   * the posed box of their current pose, so the box follows limbs that move
+   * outside the bind pose; it can be used to cull shadow casters as well.
+   * @return The box, empty if the model has no vertices.
+   */
+  AxisAlignedBox GetBounds() const;
+
+  /**
+   * Retrieves the shared model.
+   * @return A shared pointer to the model.
+   */
+  const std::shared_ptr<Model>& GetModel() const;
+
+  /**
+   * Retrieves the transform of the instance.
+   * @return The model matrix.
+   */
+  const glm::mat4& GetTransform() const;
+
+  /**
+   * Sets the transform of the instance.
+   * @param transform The new model matrix.
+   */
+  void SetTransform(const glm::mat4& transform);
+
+ private:
+  /**
+   * Sets the per instance uniforms Draw documents.
+   * @param shader The shader to draw the instance with.
+   */
+  void SetUniforms(Shader& shader) const;
+
+  std::shared_ptr<Model> model_;
+  glm::mat4 transform_;
+  std::unique_ptr<Animator> animator_;
+  glm::uint32 palette_offset_ = 0;
+  std::vector<glm::float32> morph_weights_;
+  // -1 until the weights are added to a MorphWeightBuffer.
+  glm::int32 morph_weight_offset_ = -1;
+  // The level of detail each mesh was drawn at last.
+  std::vector<glm::uint32> mesh_lods_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MODELINSTANCE_H_
@@ -0,0 +1,156 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MODELLIBRARY_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MODELLIBRARY_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "Animation.h"
+#include "AnimationSet.h"
+#include "Model.h"
+
+namespace model {
+/**
+ * The ModelLibrary class imports each model file once and hands out shared
+ * references to it, so every copy of an asset in a scene reuses the same
+ * vertex, index and texture data. Models loaded with different LoadOptions
+ * are kept apart. Animations are indexed per file and model in an
+ * AnimationSet, because decoding a clip extends the bone map of its model;
+ * each clip is decoded on its first request.
+ *
+ * The library keeps its assets alive until they are released, even when no
+ * ModelInstance refers to them any more.
+ *
+ * Usage example:
+ * @code
+ * auto vampire = ModelLibrary::GetInstance().LoadAnimated(path);
+ * ModelInstance first(vampire);
+ * ModelInstance second(vampire);
+ * second.SetAnimation(ModelLibrary::GetInstance().LoadAnimation(path,
+ * vampire));
+ * @endcode
+ *
+ * @note Loading creates OpenGL objects, so Load and LoadAnimation must be
+ * called on the thread owning the OpenGL context.
+ */
+class ModelLibrary {
+ public:
+  /**
+   * Retrieves the singleton instance of ModelLibrary.
+   * @return The singleton instance of ModelLibrary.
+   */
+  static ModelLibrary& GetInstance();
+
+  ModelLibrary(const ModelLibrary&) = delete;
+
+  ModelLibrary& operator=(const ModelLibrary&) = delete;
+
+  /**
+   * Loads a model, or returns the already loaded one.
+   * @param path The file path of the model.
+   * @param options The options to import the model with.
+   * @return A shared pointer to the model.
+   */
+  std::shared_ptr<Model> Load(const std::string& path,
+                              const Model::LoadOptions& options = {});
+
+  /**
+   * Loads a model together with every animation clip of the same file, from
+   * a single import. Returns the already loaded model if there is one.
+   * @param path The file path of the model.
+   * @param options The options to import the model with.
+   * @return A shared pointer to the model.
+   */
+  std::shared_ptr<Model> LoadAnimated(const std::string& path,
+                                      const Model::LoadOptions& options = {});
+
+  /**
+   * Indexes the animation clips of a file for a model, or returns the
+   * already indexed set. A model loaded with LoadAnimated has its set
+   * indexed from the same import.
+   * @param path The file path of the animations.
+   * @param model The model the animations drive.
+   * @return A shared pointer to the set.
+   */
+  std::shared_ptr<AnimationSet> LoadAnimationSet(
+      const std::string& path, const std::shared_ptr<Model>& model);
+
+  /**
+   * Loads an animation clip of a model, or returns the already loaded one.
+   * Other clips of the file are not decoded.
+   * @param path The file path of the animation.
+   * @param model The model the animation drives.
+   * @param clip_index The index of the clip in the file.
+   * @return A shared pointer to the animation.
+   */
+  std::shared_ptr<const Animation> LoadAnimation(
+      const std::string& path, const std::shared_ptr<Model>& model,
+      glm::uint32 clip_index = 0);
+
+  /**
+   * Drops the assets that are only referenced by the library. Their OpenGL
+   * objects are deleted with them.
+   * @return The number of models and animations dropped.
+   */
+  std::size_t ReleaseUnused();
+
+  /**
+   * Drops every asset of the library. Assets still referenced elsewhere stay
+   * alive until their last reference goes away.
+   */
+  void Clear();
+
+  /**
+   * Retrieves the number of models in the library.
+   * @return The model count.
+   */
+  std::size_t GetModelCount() const;
+
+ private:
+  ModelLibrary() = default;
+
+  /**
+   * Builds the cache key of a model from its path and import options.
+   * @param path The file path of the model.
+   * @param options The options to import the model with.
+   * @return The key.
+   */
+  static std::string MakeKey(const std::string& path,
+                             const Model::LoadOptions& options);
+
+  struct AnimationSetEntry {
+    // Detects a model released and reallocated at the same address.
+    std::weak_ptr<Model> model;
+    std::shared_ptr<AnimationSet> set;
+  };
+
+  std::map<std::string, std::shared_ptr<Model>> models_;
+  std::map<std::pair<std::string, const Model*>, AnimationSetEntry>
+      animation_sets_;
+
+  mutable std::mutex library_mutex_;
+
+  static std::once_flag initialized_;
+  static ModelLibrary* instance_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MODELLIBRARY_H_
@@ -0,0 +1,153 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MODELLOADTASK_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MODELLOADTASK_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "glm/glm.hpp"
+#include "Model.h"
+
+namespace model {
+/**
+ * The ModelLoadTask class loads a model in the background. A worker thread
+ * imports the file, builds the geometry and decodes the textures; Update
+ * then uploads the results on the OpenGL thread, a few megabytes per call,
+ * so the frame keeps its rate while the model streams in.
+ *
+ * Usage example:
+ * @code
+ * auto task = Model::LoadAsync(path);
+ * // Once per frame:
+ * if (task->Update() && task->GetModel() != nullptr) {
+ *   task->GetModel()->Draw(shader);
+ * } else {
+ *   DrawPlaceholder(task->GetProgress());
+ * }
+ * @endcode
+ *
+ * @note Update, Cancel, GetModel and the destructor must be called on the
+ * thread owning the OpenGL context. GetState and GetProgress can be called
+ * from any thread.
+ */
+class ModelLoadTask {
+ public:
+  enum class State : glm::uint8 {
+    // The worker is importing the file and decoding textures.
+    kDecoding = 0,
+    // Update is uploading the decoded data.
+    kUploading = 1,
+    kReady = 2,
+    kFailed = 3,
+    kCancelled = 4
+  };
+
+  /**
+   * A snapshot of the load progress.
+   */
+  struct Progress {
+    glm::uint32 meshes_parsed = 0;
+    glm::uint32 meshes_total = 0;
+    glm::uint32 textures_decoded = 0;
+    glm::uint32 textures_total = 0;
+    glm::uint64 bytes_uploaded = 0;
+    // Grows while the worker decodes; final once uploading starts.
+    glm::uint64 bytes_total = 0;
+  };
+
+  // Bytes uploaded by one Update call by default.
+  static constexpr glm::uint64 kDefaultUploadBudget = 8 << 20;
+
+  /**
+   * Starts loading a model on a worker thread.
+   * @param path The file path of the model file.
+   * @param options The import options.
+   */
+  ModelLoadTask(const std::string& path, const Model::LoadOptions& options);
+
+  ModelLoadTask(const ModelLoadTask&) = delete;
+
+  ModelLoadTask& operator=(const ModelLoadTask&) = delete;
+
+  /**
+   * Cancels the load, waits for the worker thread and deletes the textures
+   * uploaded so far unless the model is ready.
+   */
+  ~ModelLoadTask();
+
+  /**
+   * Uploads decoded textures and meshes until the budget is spent. At least
+   * one item is uploaded per call.
+   * @param upload_budget The number of bytes to upload in this call.
+   * @return True once the task is ready, failed or cancelled.
+   */
+  bool Update(glm::uint64 upload_budget = kDefaultUploadBudget);
+
+  /**
+   * Stops the load. The worker stops at the next mesh or texture and the
+   * data uploaded so far is freed by the next Update call.
+   */
+  void Cancel();
+
+  /**
+   * Retrieves the state of the load.
+   * @return The state.
+   */
+  State GetState() const;
+
+  /**
+   * Retrieves the load progress.
+   * @return A snapshot of the counters.
+   */
+  Progress GetProgress() const;
+
+  /**
+   * Retrieves the loaded model.
+   * @return The model once the task is ready, nullptr before that.
+   */
+  std::shared_ptr<Model> GetModel() const;
+
+ private:
+  /**
+   * Imports the model. Runs on the worker thread.
+   * @param path The file path of the model file.
+   */
+  void Decode(const std::string& path);
+
+  /**
+   * Frees the data uploaded before a cancellation.
+   */
+  void Discard();
+
+  std::shared_ptr<Model> model_;
+  Model::DecodedScene decoded_;
+  Model::LoadProgress progress_;
+  std::atomic<State> state_;
+  // Written by the worker before it publishes kFailed.
+  std::string error_;
+  std::thread worker_;
+
+  // Upload position, only touched by Update.
+  std::size_t next_texture_;
+  std::size_t next_mesh_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MODELLOADTASK_H_
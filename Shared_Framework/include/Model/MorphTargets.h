@@ -0,0 +1,252 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MORPHTARGETS_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MORPHTARGETS_H_
+
+#include <string>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "glm/gtc/type_precision.hpp"
+#include "MeshData.h"
+#include "../Buffers.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The MorphTargets class stores the blend shapes of one mesh as sparse,
+ * quantized deltas. Only the vertices a target moves are kept, so a face
+ * rig with dozens of targets costs memory for the lips and eyelids rather
+ * than for the whole head.
+ *
+ * The deltas are kept in compressed sparse row order: the entries of vertex
+ * v are row_starts[v] up to row_starts[v + 1]. Each entry takes two RGBA16I
+ * texels, the position delta with the target index in w, then the normal
+ * delta. Both are scaled by a per mesh factor, see SparseData.
+ *
+ * A vertex shader reads them through texture buffers, indexed by
+ * gl_VertexID, and blends them with the weights of the drawn instance from
+ * a MorphWeightBuffer, before skinning:
+ * @code
+ * uniform bool morph_enabled;
+ * uniform usamplerBuffer morph_rows;
+ * uniform isamplerBuffer morph_deltas;
+ * uniform float morph_position_scale;
+ * uniform float morph_normal_scale;  // optional
+ * @endcode
+ * Mesh::Draw binds the targets of the mesh, or clears morph_enabled for a
+ * mesh without any.
+ *
+ * The uniform locations of every shader program are resolved the first time
+ * the program is seen, when its samplers are also pointed at their units.
+ * Binding afterwards is two texture binds, plus a uniform call only when
+ * morph_enabled or a scale actually changes.
+ *
+ * Usage example:
+ * @code
+ * auto data = MorphTargets::Compress(vertices, targets);
+ * mesh.SetMorphTargets(std::make_unique<MorphTargets>(data));
+ * MorphTargets::Prepare(shader);
+ * @endcode
+ */
+class MorphTargets {
+ public:
+  // The texture units of morph_rows and morph_deltas, after the baked
+  // animation unit.
+  static constexpr GLuint kRowTextureUnit = 18;
+  static constexpr GLuint kDeltaTextureUnit = 19;
+  // Texels of one entry in morph_deltas.
+  static constexpr glm::uint32 kTexelsPerEntry = 2;
+  // Deltas no longer than this in every component are dropped.
+  static constexpr glm::float32 kDefaultTolerance = 1e-5f;
+
+  /**
+   * One blend shape, as an importer provides it.
+   */
+  struct Target {
+    std::string name;
+    // The absolute position of every vertex, empty to keep the positions.
+    std::vector<glm::vec3> positions;
+    // The absolute normal of every vertex, empty to keep the normals.
+    std::vector<glm::vec3> normals;
+  };
+
+  /**
+   * The compressed deltas of all targets of a mesh.
+   */
+  struct SparseData {
+    std::vector<std::string> names;
+    // The first entry of every vertex and the entry count at the end.
+    std::vector<glm::uint32> row_starts;
+    // kTexelsPerEntry texels per entry.
+    std::vector<glm::i16vec4> deltas;
+    // Multiply a quantized delta by these to get model space units.
+    glm::float32 position_scale = 0.0f;
+    glm::float32 normal_scale = 0.0f;
+
+    /**
+     * Checks whether no target moves any vertex.
+     * @return True if there are no entries.
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Retrieves the number of vertex and target pairs stored.
+     * @return The entry count.
+     */
+    glm::uint32 GetEntryCount() const;
+
+    /**
+     * Computes the size of the texture buffers.
+     * @return The size in bytes.
+     */
+    glm::uint64 GetByteSize() const;
+
+    /**
+     * Blends the targets into vertices on the CPU, as the shaders do. The
+     * normals are not renormalized.
+     * @param weights The weight of every target. Missing weights are zero.
+     * @param vertices The vertices the targets were compressed from.
+     */
+    void Apply(const std::vector<glm::float32>& weights,
+               std::vector<meshdata::Vertex>& vertices) const;
+  };
+
+  /**
+   * Turns absolute blend shapes into sparse, quantized deltas.
+   * @param vertices The base vertices of the mesh.
+   * @param targets The blend shapes of the mesh.
+   * @param tolerance The largest delta component treated as no change.
+   * @return The compressed targets.
+   */
+  static SparseData Compress(const std::vector<meshdata::Vertex>& vertices,
+                             const std::vector<Target>& targets,
+                             glm::float32 tolerance = kDefaultTolerance);
+
+  /**
+   * Points the morph samplers of a shader at their texture units and
+   * disables morphing. Programs are prepared on their first draw anyway;
+   * calling it after loading a shader does the work up front.
+   * @param shader The shader. It must be in use.
+   */
+  static void Prepare(Shader& shader);
+
+  /**
+   * Clears morph_enabled if a mesh with targets set it on this shader.
+   * @param shader The shader about to draw a mesh without targets. It must
+   * be in use.
+   */
+  static void Unbind(Shader& shader);
+
+  /**
+   * Sets morph_weight_offset for the instance about to be drawn, if the
+   * shader reads it and the value changed.
+   * @param shader The morphing shader. It must be in use.
+   * @param offset The offset returned by MorphWeightBuffer::Add.
+   */
+  static void SetWeightOffset(Shader& shader, glm::int32 offset);
+
+  /**
+   * Uploads compressed targets to texture buffers.
+   * @param data The compressed targets.
+   */
+  explicit MorphTargets(const SparseData& data);
+
+  /**
+   * Deletes the texture buffer views.
+   */
+  ~MorphTargets();
+
+  MorphTargets(const MorphTargets&) = delete;
+
+  MorphTargets& operator=(const MorphTargets&) = delete;
+
+  /**
+   * Binds the deltas to their texture units and sets the morph uniforms.
+   * Does nothing for a shader that does not read morph targets.
+   * @param shader The shader drawing the mesh. It must be in use.
+   */
+  void Bind(Shader& shader) const;
+
+  /**
+   * Retrieves the number of targets.
+   * @return The target count, the weights an instance needs.
+   */
+  glm::uint32 GetTargetCount() const;
+
+  /**
+   * Retrieves the target names, in weight order.
+   * @return A const reference to the names.
+   */
+  const std::vector<std::string>& GetTargetNames() const;
+
+  /**
+   * Finds the weight index of a target.
+   * @param name The name of the target.
+   * @return The index, or -1 if there is no such target.
+   */
+  glm::int32 FindTarget(const std::string& name) const;
+
+  /**
+   * Retrieves the size of the texture buffers.
+   * @return The size in bytes.
+   */
+  glm::uint64 GetByteSize() const;
+
+ private:
+  /**
+   * The morph uniforms of one shader program and the values last set.
+   */
+  struct ProgramUniforms {
+    GLuint program;
+    // Location of morph_enabled, -1 if the program does not morph.
+    GLint enabled;
+    GLint position_scale;
+    GLint normal_scale;
+    GLint weight_offset;
+    bool morphing;
+    // -1 until set, the real values are never negative.
+    glm::float32 position_scale_value;
+    glm::float32 normal_scale_value;
+    glm::int32 weight_offset_value;
+  };
+
+  /**
+   * Finds the uniforms of a program, resolving them and setting its
+   * samplers the first time.
+   * @param program The shader program. It must be in use.
+   * @return The cached uniforms.
+   */
+  static ProgramUniforms& GetProgram(GLuint program);
+
+  // Every program seen so far. Few shaders morph, so a linear search is
+  // enough.
+  static std::vector<ProgramUniforms> programs_;
+
+  Buffers row_buffer_;
+  Buffers delta_buffer_;
+  // Texture buffer views of row_buffer_ and delta_buffer_.
+  GLuint textures_[2];
+  std::vector<std::string> names_;
+  glm::float32 position_scale_;
+  glm::float32 normal_scale_;
+  glm::uint64 byte_size_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MORPHTARGETS_H_
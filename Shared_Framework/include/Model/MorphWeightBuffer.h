@@ -0,0 +1,108 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_MORPHWEIGHTBUFFER_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_MORPHWEIGHTBUFFER_H_
+
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "../Buffers.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The MorphWeightBuffer class holds the blend shape weights of many
+ * instances in one texture buffer of R32F texels. The weights of every
+ * instance are added each frame and uploaded at once; a shader finds the
+ * weights of the drawn instance with its offset:
+ * @code
+ * uniform samplerBuffer morph_weights;
+ * uniform int morph_weight_offset;
+ * @endcode
+ *
+ * Usage example:
+ * @code
+ * weights.Clear();
+ * instance.SetMorphWeightOffset(
+ *     weights.Add(instance.GetMorphWeights(), target_count));
+ * weights.Upload();
+ * weights.Bind(shader);
+ * @endcode
+ */
+class MorphWeightBuffer {
+ public:
+  // The texture unit of morph_weights, after the morph target units.
+  static constexpr GLuint kTextureUnit = 20;
+
+  /**
+   * Constructs an empty weight buffer.
+   */
+  MorphWeightBuffer();
+
+  /**
+   * Deletes the texture buffer view.
+   */
+  ~MorphWeightBuffer();
+
+  MorphWeightBuffer(const MorphWeightBuffer&) = delete;
+
+  MorphWeightBuffer& operator=(const MorphWeightBuffer&) = delete;
+
+  /**
+   * Drops the weights added since the last upload.
+   */
+  void Clear();
+
+  /**
+   * Appends the weights of one instance.
+   * @param weights The weights, in target order.
+   * @param count The weights the shader may read; missing ones are zero.
+   * @return The offset of the first weight, for morph_weight_offset.
+   */
+  glm::uint32 Add(const std::vector<glm::float32>& weights,
+                  glm::uint32 count);
+
+  /**
+   * Uploads the weights added since Clear, replacing the previous ones.
+   */
+  void Upload();
+
+  /**
+   * Binds the weights to kTextureUnit and points the shader's
+   * "morph_weights" sampler at it. The shader must be in use.
+   * @param shader The morphing shader.
+   */
+  void Bind(Shader& shader) const;
+
+  /**
+   * Retrieves the number of weights added since Clear.
+   * @return The weight count.
+   */
+  glm::uint32 GetWeightCount() const;
+
+ private:
+  Buffers buffer_;
+  // Texture buffer view of buffer_.
+  GLuint texture_;
+  // Weights the buffer can hold.
+  glm::uint32 capacity_;
+  std::vector<glm::float32> weights_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_MORPHWEIGHTBUFFER_H_
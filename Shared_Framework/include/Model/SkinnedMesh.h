@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_SKINNEDMESH_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_SKINNEDMESH_H_
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "Mesh.h"
+#include "../Buffers.h"
+#include "../Shader.h"
+#include "../VertexArray.h"
+
+namespace model {
+/**
+ * The SkinnedMesh class holds the posed vertices of one animated Mesh,
+ * written by SkinningPass. It shares the index buffer and the material of
+ * the source mesh and has no bone attributes, so every pass of a frame, the
+ * main pass, each shadow cascade and each cube face, draws it as static
+ * geometry instead of skinning the mesh again.
+ *
+ * The attribute locations 0 to 4 match Mesh: position, normal, texture
+ * coordinates, tangent and bitangent.
+ *
+ * Usage example:
+ * @code
+ * SkinnedMesh posed(*mesh);
+ * skinning.Skin(posed, palettes, offset);
+ * skinning.Finish();
+ * posed.Draw(shader);
+ * posed.DrawElements();  // In a depth pass with its own shader bound.
+ * @endcode
+ */
+class SkinnedMesh {
+ public:
+  /**
+   * One posed vertex, the first members of meshdata::Vertex.
+   */
+  struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 tex_coords;
+    glm::vec3 tangent;
+    glm::vec3 bitangent;
+  };
+
+  /**
+   * Allocates the posed vertices of a mesh. The vertices stay undefined
+   * until the mesh is skinned.
+   * @param source The animated mesh. It must outlive the skinned mesh.
+   */
+  explicit SkinnedMesh(Mesh& source);
+
+  SkinnedMesh(const SkinnedMesh&) = delete;
+
+  SkinnedMesh& operator=(const SkinnedMesh&) = delete;
+
+  /**
+   * Draws the posed mesh with the material of the source mesh.
+   * @param shader The shader to draw with, reading the static attributes.
+   * @param lod_level The level of detail to draw.
+   */
+  void Draw(Shader& shader, glm::uint32 lod_level = 0);
+
+  /**
+   * Issues only the draw call, e.g. in a depth pass where the caller has
+   * bound the shader already.
+   * @param lod_level The level of detail to draw.
+   */
+  void DrawElements(glm::uint32 lod_level = 0) const;
+
+  /**
+   * Gets the animated mesh the vertices are computed from.
+   * @return A reference to the source mesh.
+   */
+  Mesh& GetSource() const;
+
+  /**
+   * Gets the OpenGL name of the posed vertex buffer.
+   * @return The buffer id.
+   */
+  GLuint GetVertexBufferId() const;
+
+  /**
+   * Gets the vertex array drawing the posed vertices.
+   * @return A const reference to the VAO.
+   */
+  const VertexArray& GetVao() const;
+
+ private:
+  Mesh* source_;
+  VertexArray vao_;
+  Buffers vbo_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_SKINNEDMESH_H_
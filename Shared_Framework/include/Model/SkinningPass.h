@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_SKINNINGPASS_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_SKINNINGPASS_H_
+
+#include <memory>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "BonePaletteBuffer.h"
+#include "MorphWeightBuffer.h"
+#include "SkinnedMesh.h"
+#include "../Shader.h"
+
+namespace model {
+/**
+ * The SkinningPass class skins animated meshes once per frame with the
+ * compute shader resources/glsl/skinning.comp. Each invocation reads one
+ * meshdata::Vertex from the mesh's vertex buffer, blends its bone
+ * transforms from a BonePaletteBuffer and writes the posed vertex to a
+ * SkinnedMesh. Every later pass of the frame draws the SkinnedMesh as static
+ * geometry, so the skinning cost no longer grows with the number of shadow
+ * cascades or cube map faces. Blend shapes of the source mesh are added
+ * before skinning, with the weights of the character.
+ *
+ * Compute shaders need OpenGL 4.3. On older contexts IsSupported returns
+ * false and meshes keep being skinned in the vertex shader.
+ *
+ * Usage example:
+ * @code
+ * palettes.Update(animators, delta_time);
+ * if (skinning.IsSupported()) {
+ *   for (auto& posed : skinned_meshes) {
+ *     skinning.Skin(posed, palettes, palettes.GetOffset(i));
+ *   }
+ *   skinning.Finish();
+ * }
+ * @endcode
+ */
+class SkinningPass {
+ public:
+  // Vertices per work group, the local_size_x of skinning.comp.
+  static constexpr GLuint kGroupSize = 64;
+
+  /**
+   * Builds the compute program when the context supports it.
+   */
+  SkinningPass();
+
+  SkinningPass(const SkinningPass&) = delete;
+
+  SkinningPass& operator=(const SkinningPass&) = delete;
+
+  /**
+   * Checks whether meshes can be skinned by this pass.
+   * @return True when the compute program was built.
+   */
+  bool IsSupported() const;
+
+  /**
+   * Dispatches the skinning of one mesh. The result may only be drawn after
+   * Finish.
+   * @param target Receives the posed vertices of its source mesh.
+   * @param palettes The bone palettes of the frame.
+   * @param palette_offset The first bone of the mesh's palette, see
+   * BonePaletteBuffer::GetOffset.
+   * @param morph_weights The blend shape weights of the frame, or nullptr
+   * to skip the morph targets of the mesh.
+   * @param morph_weight_offset The first weight of the character, see
+   * MorphWeightBuffer::Add, or -1 without weights.
+   */
+  void Skin(SkinnedMesh& target, const BonePaletteBuffer& palettes,
+            glm::uint32 palette_offset,
+            const MorphWeightBuffer* morph_weights = nullptr,
+            glm::int32 morph_weight_offset = -1);
+
+  /**
+   * Makes the vertices written by the preceding Skin calls visible to
+   * vertex fetching. Call it once after all meshes of the frame.
+   */
+  void Finish();
+
+ private:
+  std::unique_ptr<Shader> shader_;
+  // Whether Skin dispatched anything since the last Finish.
+  bool pending_;
+};
+}  // namespace model
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_SKINNINGPASS_H_
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#ifndef CMAKE_OPEN_INCLUDES_INCLUDE_RENDERQUEUE_H_
+#define CMAKE_OPEN_INCLUDES_INCLUDE_RENDERQUEUE_H_
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "glad/glad.h"
+#include "glm/glm.hpp"
+#include "Shader.h"
+#include "Model/Mesh.h"
+
+/**
+ * The RenderQueue class collects the draw calls of a frame and submits them
+ * in an order that minimizes state changes. Every item gets a 64 bit sort
+ * key; the keys are radix sorted and the items are executed in key order,
+ * switching the program, material and vertex array only when they change.
+ *
+ * Key layout, from the most significant bit:
+ * - opaque:  pass (2) | program (12) | material (14) | vao (12) | depth (24)
+ * - blended: pass (2) | inverted depth (24) | program (12) | material (14) |
+ *            vao (12)
+ * Opaque items are grouped by state and drawn front to back inside a group;
+ * blended items are drawn strictly back to front, with alpha blending on and
+ * depth writes off. Blending is disabled again at the end of Flush.
+ *
+ * Usage example:
+ * @code
+ * queue.Begin(camera.GetViewMatrix(), camera.GetFarPlane());
+ * queue.Submit(RenderQueue::Pass::kOpaque, shader, mesh, model_matrix);
+ * queue.Flush();
+ * auto changes = queue.GetStatistics().program_changes;
+ * @endcode
+ */
+class RenderQueue {
+ public:
+  enum class Pass : glm::uint8 { kOpaque = 0, kBlended = 1 };
+
+  /**
+   * Counters of the most recent Flush call.
+   */
+  struct Statistics {
+    glm::uint32 items = 0;
+    glm::uint32 draw_calls = 0;
+    glm::uint32 program_changes = 0;
+    glm::uint32 material_changes = 0;
+    glm::uint32 vao_changes = 0;
+  };
+
+  /**
+   * Starts a new frame. Items submitted before the previous Flush are
+   * dropped.
+   * @param view The view matrix used to compute item depths.
+   * @param far_plane The far plane distance, used to quantize depths.
+   */
+  void Begin(const glm::mat4& view, glm::float32 far_plane);
+
+  /**
+   * Queues one level of detail of a mesh. The shader's "model" uniform is
+   * set to model_matrix and the morph targets of the mesh are bound before
+   * the mesh is drawn.
+   * @param pass The pass the mesh is drawn in.
+   * @param shader The shader to draw the mesh with.
+   * @param mesh The mesh to draw. It must outlive the next Flush.
+   * @param model_matrix The model matrix of the mesh.
+   * @param lod_level The level of detail to draw.
+   * @param morph_weight_offset The first blend shape weight of the drawn
+   * instance, -1 to leave morph_weight_offset as it is.
+   */
+  void Submit(Pass pass, Shader& shader, model::Mesh& mesh,
+              const glm::mat4& model_matrix, glm::uint32 lod_level = 0,
+              glm::int32 morph_weight_offset = -1);
+
+  /**
+   * Queues a custom draw call, e.g. a glDrawArrays on a chapter's own vertex
+   * array. The queue binds the shader and the vertex array before calling
+   * draw, so draw must not bind another vertex array. draw may bind its own
+   * textures; the next mesh binds its material again.
+   * @param pass The pass the item is drawn in.
+   * @param shader The shader to draw the item with.
+   * @param vao The vertex array the item draws from.
+   * @param model_matrix The model matrix of the item, used for its depth and
+   * set as the shader's "model" uniform.
+   * @param draw Issues the draw call.
+   */
+  void Submit(Pass pass, Shader& shader, GLuint vao,
+              const glm::mat4& model_matrix,
+              std::function<void(Shader&)> draw);
+
+  /**
+   * Sorts the queued items, draws them and empties the queue.
+   */
+  void Flush();
+
+  /**
+   * Retrieves the counters of the most recent Flush call.
+   * @return A const reference to the statistics.
+   */
+  const Statistics& GetStatistics() const;
+
+  /**
+   * Sorts 64 bit keys with a least significant digit radix sort, 8 bits per
+   * pass. Passes in which every key has the same digit are skipped.
+   * @param keys The keys to sort.
+   * @param order Receives the indices of keys in ascending key order.
+   * @param scratch Temporary storage, resized as needed.
+   */
+  static void RadixSort(const std::vector<glm::uint64>& keys,
+                        std::vector<glm::uint32>& order,
+                        std::vector<glm::uint32>& scratch);
+
+  /**
+   * Builds the sort key of an item with the view of the current frame.
+   * Materials get dense ids in the order they are first seen after Begin.
+   * @param pass The pass of the item.
+   * @param program The shader program of the item.
+   * @param material The material of the item, or null.
+   * @param vao The vertex array of the item.
+   * @param model_matrix The model matrix of the item.
+   * @return The packed key.
+   */
+  glm::uint64 MakeKey(Pass pass, GLuint program, const void* material,
+                      GLuint vao, const glm::mat4& model_matrix);
+
+ private:
+  struct Item {
+    Shader* shader;
+    model::Mesh* mesh;
+    GLuint vao;
+    glm::uint32 lod_level;
+    glm::int32 morph_weight_offset;
+    Pass pass;
+    glm::mat4 model_matrix;
+    std::function<void(Shader&)> draw;
+  };
+
+  glm::mat4 view_ = glm::mat4(1.0f);
+  glm::float32 far_plane_ = 100.0f;
+
+  std::vector<Item> items_;
+  std::vector<glm::uint64> keys_;
+  std::vector<glm::uint32> order_;
+  std::vector<glm::uint32> scratch_;
+  // Dense per frame ids of the materials, so they fit the key.
+  std::unordered_map<const void*, glm::uint32> material_ids_;
+
+  Statistics statistics_;
+};
+
+#endif  //CMAKE_OPEN_INCLUDES_INCLUDE_RENDERQUEUE_H_
@@ -533,6 +533,14 @@ class Shader {
          const std::string& tess_evaluation_path = std::string(),
          const std::string& compute_path = std::string());
 
+  /**
+   * Build an OpenGL compute program. A compute shader can not be linked with
+   * the other stages, so the program has no vertex or fragment shader. Run
+   * it with SetDispatchCompute while it is in use.
+   * @param compute_path Compute shader path, required.
+   */
+  explicit Shader(const std::string& compute_path);
+
   ~Shader();
 
   /**
@@ -65,7 +65,7 @@ class VertexArray {
    * Unbind the vertex array object.It binds 0 to OpenGL, and in OpenGL 4.6 
    * binding to 0 means unbinding the vertex array object.
    */
-  void UnBind();
+  void UnBind() const;
 
   /**
    * Define an array of generic vertex attribute data. please note that this 
@@ -233,6 +233,8 @@ class VertexArray {
   void AddLongBuffer(GLuint index, GLint size, GLenum type, GLsizei stride,
                      const void* pointer);
 
+  void SetAttribDivisor(GLuint index, GLuint divisor) const;
+
   GLuint GetVaoId() const;
 
   GLsizei GetN() const;
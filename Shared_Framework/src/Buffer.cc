@@ -53,6 +53,21 @@ void Buffers::SetData(const void* data, GLsizeiptr size, GLenum usage) const {
     glBufferData(type_, size, data, usage);
   }
 }
+void Buffers::SetSubData(GLintptr offset, GLsizeiptr size,
+                         const void* data) const {
+  if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 5)) {
+    glNamedBufferSubData(buffer_id_, offset, size, data);
+  } else {
+    glBufferSubData(type_, offset, size, data);
+  }
+}
+void Buffers::GetSubData(GLintptr offset, GLsizeiptr size, void* data) const {
+  if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 5)) {
+    glGetNamedBufferSubData(buffer_id_, offset, size, data);
+  } else {
+    glGetBufferSubData(type_, offset, size, data);
+  }
+}
 GLenum Buffers::GetType() const {
   return type_;
 }
@@ -74,6 +89,9 @@ void Buffers::ResetBuffers(GLsizei n, GLenum type) {
 GLsizei Buffers::GetN() const {
   return n_;
 }
+GLuint Buffers::GetBufferId() const {
+  return buffer_id_;
+}
 void Buffers::SetData(const void* data, GLsizeiptr size, GLenum usage) {
   if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 5)) {
     glNamedBufferData(buffer_id_, size, data, usage);
@@ -121,4 +139,12 @@ template void Buffers::SetData<struct meshdata::Vertex>(
     const std::vector<meshdata::Vertex>& data, GLenum usage);
 
 template void Buffers::SetData<unsigned int>(
-    const std::vector<unsigned int>& data, GLenum usage);
\ No newline at end of file
+    const std::vector<unsigned int>& data, GLenum usage);
+
+template void Buffers::SetData<struct meshdata::DrawElementsIndirectCommand>(
+    const std::vector<meshdata::DrawElementsIndirectCommand>& data,
+    GLenum usage) const;
+
+template void Buffers::SetData<struct meshdata::DrawElementsIndirectCommand>(
+    const std::vector<meshdata::DrawElementsIndirectCommand>& data,
+    GLenum usage);
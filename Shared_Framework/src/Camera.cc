@@ -315,6 +315,10 @@ glm::mat4 Camera::GetProjectionMatrix(const float width,
                           far_plane_);
 }
 
+Frustum Camera::GetFrustum(const float width, const float height) const {
+  return Frustum(GetProjectionMatrix(width, height) * GetViewMatrix());
+}
+
 void Camera::ResetCamera(glm::vec3 position, glm::vec3 world_up,
                          glm::float32 yaw, glm::float32 pitch,
                          glm::float32 near_plane, glm::float32 far_plane) {
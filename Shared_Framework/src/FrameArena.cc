@@ -0,0 +1,87 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "FrameArena.h"
+#include <cstdint>
+
+std::once_flag FrameArena::initialized_;
+FrameArena* FrameArena::instance_ = nullptr;
+
+namespace {
+unsigned char* AlignUp(unsigned char* address, std::size_t alignment) {
+  auto value = reinterpret_cast<std::uintptr_t>(address);
+  auto aligned = (value + alignment - 1) & ~(std::uintptr_t(alignment) - 1);
+  return address + (aligned - value);
+}
+}  // namespace
+
+FrameArena& FrameArena::GetInstance() {
+  if (nullptr == instance_) {
+    std::call_once(initialized_, []() { instance_ = new FrameArena; });
+  }
+  return *instance_;
+}
+
+FrameArena::FrameArena()
+    : buffer_(new unsigned char[kDefaultCapacity]),
+      capacity_(kDefaultCapacity) {}
+
+void* FrameArena::Allocate(std::size_t size, std::size_t alignment) {
+  ++frame_stats_.allocation_count;
+  unsigned char* begin = AlignUp(buffer_.get() + offset_, alignment);
+  auto end = static_cast<std::size_t>(begin - buffer_.get()) + size;
+  if (end <= capacity_) {
+    offset_ = end;
+    frame_stats_.used_bytes = offset_ + heap_bytes_;
+    return begin;
+  }
+
+  // Padded, so the aligned start still leaves size bytes.
+  heap_blocks_.emplace_back(new unsigned char[size + alignment]);
+  heap_bytes_ += size + alignment;
+  ++frame_stats_.heap_allocation_count;
+  frame_stats_.used_bytes = offset_ + heap_bytes_;
+  return AlignUp(heap_blocks_.back().get(), alignment);
+}
+
+void FrameArena::Reset() {
+  if (!heap_blocks_.empty()) {
+    // Grows to the peak of this frame, so the same frame fits next time.
+    std::size_t capacity = capacity_;
+    while (capacity < offset_ + heap_bytes_) {
+      capacity *= 2;
+    }
+    buffer_.reset(new unsigned char[capacity]);
+    capacity_ = capacity;
+    heap_blocks_.clear();
+    heap_bytes_ = 0;
+  }
+  offset_ = 0;
+  last_frame_stats_ = frame_stats_;
+  frame_stats_ = Stats();
+}
+
+const FrameArena::Stats& FrameArena::GetFrameStats() const {
+  return frame_stats_;
+}
+
+const FrameArena::Stats& FrameArena::GetLastFrameStats() const {
+  return last_frame_stats_;
+}
+
+std::size_t FrameArena::GetCapacity() const {
+  return capacity_;
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Frustum.h"
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define FRUSTUM_USE_SSE 1
+#endif
+
+Frustum::Frustum() {
+  for (auto& plane : planes_) {
+    plane = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  }
+}
+
+Frustum::Frustum(const glm::mat4& clip_matrix) {
+  Update(clip_matrix);
+}
+
+void Frustum::Update(const glm::mat4& clip_matrix) {
+  // glm is column major, so the rows of the matrix are gathered by hand.
+  glm::mat4 m = glm::transpose(clip_matrix);
+  planes_[kLeft] = m[3] + m[0];
+  planes_[kRight] = m[3] - m[0];
+  planes_[kBottom] = m[3] + m[1];
+  planes_[kTop] = m[3] - m[1];
+  planes_[kNear] = m[3] + m[2];
+  planes_[kFar] = m[3] - m[2];
+  for (auto& plane : planes_) {
+    glm::float32 length = glm::length(glm::vec3(plane));
+    if (length > 0.0f) {
+      plane /= length;
+    }
+  }
+}
+
+const glm::vec4& Frustum::GetPlane(Plane plane) const {
+  return planes_[plane];
+}
+
+bool Frustum::IntersectsSphere(const glm::vec3& center,
+                               glm::float32 radius) const {
+  for (const auto& plane : planes_) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Frustum::IntersectsBox(const glm::vec3& min, const glm::vec3& max) const {
+  for (const auto& plane : planes_) {
+    // Only the corner farthest along the plane normal needs testing.
+    glm::vec3 positive(plane.x >= 0.0f ? max.x : min.x,
+                       plane.y >= 0.0f ? max.y : min.y,
+                       plane.z >= 0.0f ? max.z : min.z);
+    if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::size_t Frustum::CullSpheres(const glm::vec4* spheres, std::size_t count,
+                                 glm::uint8* visible) const {
+  std::size_t visible_count = 0;
+  std::size_t i = 0;
+#ifdef FRUSTUM_USE_SSE
+  for (; i + 4 <= count; i += 4) {
+    // Transpose four spheres into x, y, z and radius lanes.
+    __m128 x = _mm_loadu_ps(&spheres[i].x);
+    __m128 y = _mm_loadu_ps(&spheres[i + 1].x);
+    __m128 z = _mm_loadu_ps(&spheres[i + 2].x);
+    __m128 r = _mm_loadu_ps(&spheres[i + 3].x);
+    _MM_TRANSPOSE4_PS(x, y, z, r);
+    __m128 zero = _mm_setzero_ps();
+    __m128 negative_radius = _mm_sub_ps(zero, r);
+
+    __m128 inside = _mm_cmpeq_ps(zero, zero);
+    for (const auto& plane : planes_) {
+      __m128 distance = _mm_add_ps(
+          _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                     _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+          _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)),
+                     _mm_set1_ps(plane.w)));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+    }
+
+    int mask = _mm_movemask_ps(inside);
+    for (int lane = 0; lane < 4; ++lane) {
+      visible[i + lane] = static_cast<glm::uint8>((mask >> lane) & 1);
+    }
+    visible_count += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) +
+                     ((mask >> 3) & 1);
+  }
+#endif
+  for (; i < count; ++i) {
+    bool inside = IntersectsSphere(glm::vec3(spheres[i]), spheres[i].w);
+    visible[i] = inside ? 1 : 0;
+    visible_count += inside ? 1 : 0;
+  }
+  return visible_count;
+}
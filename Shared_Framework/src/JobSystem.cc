@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "JobSystem.h"
+#include <algorithm>
+
+thread_local bool JobSystem::inside_job_ = false;
+std::once_flag JobSystem::initialized_;
+JobSystem* JobSystem::instance_ = nullptr;
+
+JobSystem& JobSystem::GetInstance() {
+  if (nullptr == instance_) {
+    std::call_once(initialized_, []() { instance_ = new JobSystem; });
+  }
+  return *instance_;
+}
+
+JobSystem::JobSystem() {
+  std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t i = 1; i < threads; ++i) {
+    workers_.emplace_back(&JobSystem::WorkerLoop, this);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_ready_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void JobSystem::ParallelFor(std::size_t count, std::size_t chunk_size,
+                            const Job& job) {
+  if (count == 0) {
+    return;
+  }
+  chunk_size = std::max<std::size_t>(chunk_size, 1);
+  // Nested loops and single chunks gain nothing from the workers.
+  if (inside_job_ || workers_.empty() || count <= chunk_size) {
+    job(0, count);
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+  Batch batch;
+  batch.job = &job;
+  batch.count = count;
+  batch.chunk_size = chunk_size;
+  batch.chunk_count = (count + chunk_size - 1) / chunk_size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    batch_ = &batch;
+    ++generation_;
+  }
+  work_ready_.notify_all();
+
+  RunChunks(batch);
+
+  // Every chunk is claimed, wait for the workers still running one.
+  std::unique_lock<std::mutex> lock(mutex_);
+  batch_ = nullptr;
+  work_done_.wait(lock, [&batch] { return batch.users == 0; });
+}
+
+std::size_t JobSystem::GetWorkerCount() const {
+  return workers_.size();
+}
+
+void JobSystem::WorkerLoop() {
+  std::size_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    work_ready_.wait(lock, [&] {
+      return stopping_ ||
+             (batch_ != nullptr && generation_ != seen_generation);
+    });
+    if (stopping_) {
+      return;
+    }
+    seen_generation = generation_;
+    Batch* batch = batch_;
+    ++batch->users;
+    lock.unlock();
+
+    RunChunks(*batch);
+
+    lock.lock();
+    if (--batch->users == 0) {
+      work_done_.notify_all();
+    }
+  }
+}
+
+void JobSystem::RunChunks(Batch& batch) {
+  inside_job_ = true;
+  while (true) {
+    std::size_t chunk = batch.next_chunk.fetch_add(1);
+    if (chunk >= batch.chunk_count) {
+      break;
+    }
+    std::size_t begin = chunk * batch.chunk_size;
+    std::size_t end = std::min(begin + batch.chunk_size, batch.count);
+    (*batch.job)(begin, end);
+  }
+  inside_job_ = false;
+}
@@ -175,6 +175,81 @@ GLuint LoadImage::LoadTexture2DFromAssimp(const aiTexture* ai_texture,
   return texture_id;
 }
 
+LoadImage::DecodedImage LoadImage::DecodeImage2D(
+    const std::string& path, GLboolean gamma_correction) {
+  DecodedImage image;
+  unsigned char* data = LoadImageData(path, &image.width, &image.height,
+                                      &image.nr_channels);
+  if (data == nullptr) {
+    LoggerSystem::GetInstance().Log(
+        LoggerSystem::Level::kWarning,
+        "Texture failed to load at path: " + path);
+    return image;
+  }
+  image.pixels.assign(data, data + static_cast<std::size_t>(image.width) *
+                                       image.height * image.nr_channels);
+  stbi_image_free(data);
+  if (gamma_correction) {
+    GammaCorrect(image.pixels.data(), image.width, image.height, 1,
+                 image.nr_channels, 2.2f);
+  }
+  return image;
+}
+
+LoadImage::DecodedImage LoadImage::DecodeImage2DFromAssimp(
+    const aiTexture* ai_texture, GLboolean gamma_correction) {
+  DecodedImage image;
+  if (nullptr == ai_texture) {
+    return image;
+  }
+  // A height of 0 means the texture holds a compressed file of mWidth bytes.
+  int size = ai_texture->mHeight == 0
+                 ? static_cast<int>(ai_texture->mWidth)
+                 : static_cast<int>(ai_texture->mWidth * ai_texture->mHeight);
+  unsigned char* data = stbi_load_from_memory(
+      reinterpret_cast<unsigned char*>(ai_texture->pcData), size, &image.width,
+      &image.height, &image.nr_channels, 0);
+  if (data == nullptr) {
+    LoggerSystem::GetInstance().Log(
+        LoggerSystem::Level::kWarning,
+        "Texture failed to load at path: " +
+            std::string(ai_texture->mFilename.C_Str()));
+    return image;
+  }
+  image.pixels.assign(data, data + static_cast<std::size_t>(image.width) *
+                                       image.height * image.nr_channels);
+  stbi_image_free(data);
+  if (gamma_correction) {
+    GammaCorrect(image.pixels.data(), image.width, image.height, 1,
+                 image.nr_channels, 2.2f);
+  }
+  return image;
+}
+
+GLuint LoadImage::UploadTexture2D(const DecodedImage& image, GLint wrap_mode,
+                                  GLint min_filter_mode,
+                                  GLint mag_filter_mode) {
+  if (image.pixels.empty()) {
+    return 0;
+  }
+  GLenum format = DetermineFormat(image.nr_channels);
+  GLuint texture_id = 0;
+  glGenTextures(1, &texture_id);
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  // Rows of 1 and 3 channel images are not always 4 byte aligned.
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format,
+               GL_UNSIGNED_BYTE, image.pixels.data());
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap_mode);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap_mode);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter_mode);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mag_filter_mode);
+  glGenerateMipmap(GL_TEXTURE_2D);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return texture_id;
+}
+
 void LoadImage::DisEnableStbImageFlipYAxis() {
   stbi_set_flip_vertically_on_load(false);
 }
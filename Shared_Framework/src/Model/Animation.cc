@@ -15,7 +15,9 @@
  ******************************************************************************/
 
 #include "Model/Animation.h"
+#include <algorithm>
 #include <stdexcept>
+#include <utility>
 #include "LoggerSystem.h"
 #include "Model/ModelException.h"
 #include "ImGui/OpenGLLogMessage.h"
@@ -39,6 +41,7 @@ const Animation::AssimpNodeData& Animation::GetRootNode() const {
 }
 void Animation::SetRootNode(const Animation::AssimpNodeData& root_node) {
   root_node_ = root_node;
+  RebuildSkeleton();
 }
 const std::map<std::string, BoneInfo>& Animation::GetBoneInfoMap() const {
   return bone_info_map_;
@@ -46,8 +49,11 @@ const std::map<std::string, BoneInfo>& Animation::GetBoneInfoMap() const {
 void Animation::SetBoneInfoMap(
     const std::map<std::string, BoneInfo>& bone_info_map) {
   bone_info_map_ = bone_info_map;
+  RebuildSkeleton();
 }
-void Animation::ReadMissingBones(const aiAnimation* animation, Model* model) {
+void Animation::ReadMissingBones(
+    const aiAnimation* animation, Model* model,
+    const KeyframeCompression::Settings& settings) {
   auto size = animation->mNumChannels;
 
   //getting m_BoneInfoMap from Model class
@@ -67,7 +73,8 @@ void Animation::ReadMissingBones(const aiAnimation* animation, Model* model) {
 
     this->bones_.emplace_back(channel->mNodeName.data,
                               bone_info_map[channel->mNodeName.data].id,
-                              channel);
+                              channel, settings);
+    this->compression_report_.Merge(this->bones_.back().GetCompressionReport());
   }
 
   this->bone_info_map_ = bone_info_map;
@@ -96,21 +103,20 @@ void Animation::ReadHierarchyData(Animation::AssimpNodeData& dest,
 }
 Animation::Animation(const std::string& animation_path, Model* model) {
   try {
-    Assimp::Importer importer=Assimp::Importer();
-    auto scene = importer.ReadFile(animation_path, aiProcess_Triangulate);
-    if (!scene || !scene->mRootNode) {
-      throw ModelException(
-          LoggerSystem::Level::kWarning,
-          "Error: Failed to load animation from " + animation_path);
-    }
-
-    auto animation = scene->mAnimations[0];
-    this->duration_ = animation->mDuration;
-    this->ticks_per_second_ = animation->mTicksPerSecond;
-    auto global_transformation = scene->mRootNode->mTransformation;
-    global_transformation = global_transformation.Inverse();
-    ReadHierarchyData(this->root_node_, scene->mRootNode);
-    ReadMissingBones(animation, model);
+    ImportSession session(animation_path, aiProcess_Triangulate);
+    Load(session, model, 0, KeyframeCompression::Settings());
+  } catch (ModelException& e) {
+    OpenGLLogMessage::GetInstance().AddLog(
+        std::string(
+            "There was an error initializing the animation class. Because: ") +
+        e.what());
+  }
+}
+Animation::Animation(const ImportSession& session, Model* model,
+                     glm::uint32 clip_index,
+                     const KeyframeCompression::Settings& settings) {
+  try {
+    Load(session, model, clip_index, settings);
   } catch (ModelException& e) {
     OpenGLLogMessage::GetInstance().AddLog(
         std::string(
@@ -118,7 +124,97 @@ Animation::Animation(const std::string& animation_path, Model* model) {
         e.what());
   }
 }
-Bone* Animation::FindBone(const std::string& name) {
+Animation::Animation(std::string name, glm::float64 duration,
+                     glm::float64 ticks_per_second, AssimpNodeData root_node,
+                     std::map<std::string, BoneInfo> bone_info_map,
+                     std::vector<Bone> channels)
+    : name_(std::move(name)),
+      duration_(duration),
+      ticks_per_second_(ticks_per_second),
+      bones_(std::move(channels)),
+      root_node_(std::move(root_node)),
+      bone_info_map_(std::move(bone_info_map)) {
+  for (const auto& bone : bones_) {
+    compression_report_.Merge(bone.GetCompressionReport());
+  }
+  RebuildSkeleton();
+}
+std::vector<std::shared_ptr<Animation>> Animation::LoadAll(
+    const ImportSession& session, Model* model,
+    const KeyframeCompression::Settings& settings) {
+  std::vector<std::shared_ptr<Animation>> animations;
+  for (glm::uint32 i = 0; i < session.GetAnimationCount(); ++i) {
+    animations.push_back(std::make_shared<Animation>(session, model, i, settings));
+  }
+  return animations;
+}
+void Animation::Load(const ImportSession& session, Model* model,
+                     glm::uint32 clip_index,
+                     const KeyframeCompression::Settings& settings) {
+  auto scene = session.GetScene();
+  if (!scene || !scene->mRootNode) {
+    throw ModelException(
+        LoggerSystem::Level::kWarning,
+        "Error: Failed to load animation from " + session.GetPath());
+  }
+  if (clip_index >= scene->mNumAnimations) {
+    throw ModelException(LoggerSystem::Level::kWarning,
+                         "Error: No animation " + std::to_string(clip_index) +
+                             " in " + session.GetPath());
+  }
+
+  auto animation = scene->mAnimations[clip_index];
+  this->name_ = animation->mName.C_Str();
+  this->duration_ = animation->mDuration;
+  this->ticks_per_second_ = animation->mTicksPerSecond;
+  ReadHierarchyData(this->root_node_, scene->mRootNode);
+  ReadMissingBones(animation, model, settings);
+  RebuildSkeleton();
+}
+void Animation::RebuildSkeleton() {
+  std::map<std::string, glm::int32> channels;
+  for (std::size_t i = 0; i < bones_.size(); ++i) {
+    channels.emplace(bones_[i].GetBoneName(), static_cast<glm::int32>(i));
+  }
+  skeleton_.clear();
+  node_names_.clear();
+  bone_count_ = 0;
+  BuildSkeleton(root_node_, -1, channels);
+  // Children come after their parents, so a reverse pass sees every child
+  // before its parent.
+  for (std::size_t i = skeleton_.size(); i-- > 1;) {
+    auto& parent = skeleton_[skeleton_[i].parent];
+    parent.height = std::max(parent.height, skeleton_[i].height + 1);
+  }
+}
+void Animation::BuildSkeleton(
+    const AssimpNodeData& node, glm::int32 parent,
+    const std::map<std::string, glm::int32>& channels) {
+  SkeletonNode flat;
+  flat.transformation = node.transformation;
+  flat.offset = glm::mat4(1.0f);
+  flat.parent = parent;
+  flat.height = 0;
+  auto channel = channels.find(node.name);
+  flat.channel = channel != channels.end() ? channel->second : -1;
+  auto bone = bone_info_map_.find(node.name);
+  if (bone != bone_info_map_.end()) {
+    flat.bone_id = bone->second.id;
+    flat.offset = bone->second.offset;
+    bone_count_ = std::max(bone_count_,
+                           static_cast<glm::uint32>(flat.bone_id) + 1);
+  } else {
+    flat.bone_id = -1;
+  }
+
+  auto index = static_cast<glm::int32>(skeleton_.size());
+  skeleton_.push_back(flat);
+  node_names_.push_back(node.name);
+  for (const auto& child : node.children) {
+    BuildSkeleton(child, index, channels);
+  }
+}
+const Bone* Animation::FindBone(const std::string& name) const {
   auto iter = std::find_if(
       this->bones_.begin(), this->bones_.end(),
       [&](const Bone& bone) { return bone.GetBoneName() == name; });
@@ -131,3 +227,48 @@ Bone* Animation::FindBone(const std::string& name) {
 const std::vector<Bone>& Animation::GetBones() const {
   return bones_;
 }
+const Bone& Animation::GetBone(glm::uint32 index) const {
+  return bones_[index];
+}
+const std::vector<Animation::SkeletonNode>& Animation::GetSkeleton() const {
+  return skeleton_;
+}
+std::vector<glm::float32> Animation::GetNodeMask(const std::string& node_name,
+                                                glm::float32 weight) const {
+  std::vector<glm::float32> mask(skeleton_.size(), 0.0f);
+  auto node = std::find(node_names_.begin(), node_names_.end(), node_name);
+  if (node == node_names_.end()) {
+    return mask;
+  }
+  // Depth first order keeps a subtree contiguous: it ends at the first node
+  // whose parent comes before the subtree root.
+  auto root = static_cast<glm::int32>(node - node_names_.begin());
+  mask[root] = weight;
+  for (std::size_t i = root + 1;
+       i < skeleton_.size() && skeleton_[i].parent >= root; ++i) {
+    mask[i] = weight;
+  }
+  return mask;
+}
+bool Animation::SharesSkeleton(const Animation& other) const {
+  if (skeleton_.size() != other.skeleton_.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < skeleton_.size(); ++i) {
+    if (skeleton_[i].parent != other.skeleton_[i].parent ||
+        skeleton_[i].bone_id != other.skeleton_[i].bone_id ||
+        node_names_[i] != other.node_names_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+glm::uint32 Animation::GetBoneCount() const {
+  return bone_count_;
+}
+const std::string& Animation::GetName() const {
+  return name_;
+}
+const KeyframeCompression::Report& Animation::GetCompressionReport() const {
+  return compression_report_;
+}
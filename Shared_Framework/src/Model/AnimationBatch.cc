@@ -0,0 +1,77 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/AnimationBatch.h"
+#include "JobSystem.h"
+
+using namespace model;
+
+void AnimationBatch::Update(const std::vector<Animator*>& animators,
+                            glm::float64 delta_time, glm::uint32 chunk_size) {
+  JobSystem::GetInstance().ParallelFor(
+      animators.size(), chunk_size,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          if (animators[i] != nullptr) {
+            animators[i]->UpdateAnimation(delta_time);
+          }
+        }
+      });
+}
+
+void AnimationBatch::Update(const std::vector<Animator*>& animators,
+                            glm::float64 delta_time,
+                            const std::vector<glm::uint32>& offsets,
+                            glm::vec4* palettes, PaletteFormat format,
+                            glm::uint32 chunk_size) {
+  const glm::uint32 texels = Animator::GetTexelsPerBone(format);
+  JobSystem::GetInstance().ParallelFor(
+      animators.size(), chunk_size,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          if (animators[i] != nullptr) {
+            animators[i]->UpdateAnimation(
+                delta_time, palettes + offsets[i] * texels, format);
+          }
+        }
+      });
+}
+
+glm::uint32 AnimationBatch::GetPaletteOffsets(
+    const std::vector<Animator*>& animators,
+    std::vector<glm::uint32>& offsets) {
+  offsets.resize(animators.size());
+  glm::uint32 total = 0;
+  for (std::size_t i = 0; i < animators.size(); ++i) {
+    offsets[i] = total;
+    if (animators[i] != nullptr) {
+      total += static_cast<glm::uint32>(
+          animators[i]->GetFinalBoneMatrices().size());
+    }
+  }
+  return total;
+}
+
+glm::uint64 AnimationBatch::GetEvaluatedBoneCount(
+    const std::vector<Animator*>& animators) {
+  glm::uint64 total = 0;
+  for (const auto* animator : animators) {
+    if (animator != nullptr) {
+      total += animator->GetEvaluatedBoneCount();
+    }
+  }
+  return total;
+}
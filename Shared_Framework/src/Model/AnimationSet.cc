@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/AnimationSet.h"
+#include <utility>
+#include "ImGui/OpenGLLogMessage.h"
+
+using namespace model;
+
+AnimationSet::AnimationSet(std::shared_ptr<const ImportSession> session,
+                           const std::shared_ptr<Model>& model,
+                           const KeyframeCompression::Settings& settings)
+    : session_(std::move(session)), model_(model), settings_(settings) {
+  path_ = session_->GetPath();
+  const aiScene* scene = session_->GetScene();
+  if (scene == nullptr) {
+    OpenGLLogMessage::GetInstance().AddLog(
+        "There was an error indexing the animations of " + path_ +
+        ". Because: " + session_->GetError());
+    return;
+  }
+  // Only the headers are read here, the channels stay in the scene.
+  for (glm::uint32 i = 0; i < scene->mNumAnimations; ++i) {
+    const aiAnimation* animation = scene->mAnimations[i];
+    clips_.push_back({animation->mName.C_Str(), animation->mDuration,
+                      animation->mTicksPerSecond, animation->mNumChannels});
+  }
+  decoded_.resize(clips_.size());
+}
+
+glm::uint32 AnimationSet::GetClipCount() const {
+  return static_cast<glm::uint32>(clips_.size());
+}
+
+const AnimationSet::ClipInfo& AnimationSet::GetClipInfo(
+    glm::uint32 index) const {
+  return clips_[index];
+}
+
+glm::int32 AnimationSet::FindClip(const std::string& name) const {
+  for (std::size_t i = 0; i < clips_.size(); ++i) {
+    if (clips_[i].name == name) {
+      return static_cast<glm::int32>(i);
+    }
+  }
+  return -1;
+}
+
+std::shared_ptr<const Animation> AnimationSet::Get(glm::uint32 index) {
+  std::lock_guard<std::mutex> lock(set_mutex_);
+  if (index >= decoded_.size()) {
+    return nullptr;
+  }
+  if (decoded_[index] == nullptr) {
+    std::shared_ptr<Model> model = model_.lock();
+    if (model == nullptr) {
+      OpenGLLogMessage::GetInstance().AddLog(
+          "The animation " + clips_[index].name + " of " + path_ +
+          " cannot be decoded because its model was released.");
+      return nullptr;
+    }
+    if (session_ == nullptr) {
+      session_ = std::make_shared<ImportSession>(path_, aiProcess_Triangulate);
+    }
+    decoded_[index] =
+        std::make_shared<Animation>(*session_, model.get(), index, settings_);
+  }
+  return decoded_[index];
+}
+
+std::shared_ptr<const Animation> AnimationSet::Find(const std::string& name) {
+  glm::int32 index = FindClip(name);
+  if (index < 0) {
+    return nullptr;
+  }
+  return Get(static_cast<glm::uint32>(index));
+}
+
+bool AnimationSet::IsDecoded(glm::uint32 index) const {
+  std::lock_guard<std::mutex> lock(set_mutex_);
+  return index < decoded_.size() && decoded_[index] != nullptr;
+}
+
+glm::uint32 AnimationSet::GetDecodedCount() const {
+  std::lock_guard<std::mutex> lock(set_mutex_);
+  glm::uint32 count = 0;
+  for (const auto& animation : decoded_) {
+    if (animation != nullptr) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+void AnimationSet::ReleaseSource() {
+  std::lock_guard<std::mutex> lock(set_mutex_);
+  session_.reset();
+}
+
+std::size_t AnimationSet::ReleaseUnused() {
+  std::lock_guard<std::mutex> lock(set_mutex_);
+  std::size_t released = 0;
+  for (auto& animation : decoded_) {
+    if (animation != nullptr && animation.use_count() == 1) {
+      animation.reset();
+      ++released;
+    }
+  }
+  return released;
+}
@@ -15,17 +15,22 @@
  ******************************************************************************/
 
 #include "Model/Animator.h"
+#include <algorithm>
+#include <utility>
 #include "LoggerSystem.h"
 #include "Model/ModelException.h"
+#include "glm/gtc/quaternion.hpp"
 #include "ImGui/OpenGLLogMessage.h"
 
 using namespace model;
 const std::vector<glm::mat4>& Animator::GetFinalBoneMatrices() const {
   return final_bone_matrices_;
 }
-Animator::Animator(Animation* animation) {
+Animator::Animator(Animation* animation)
+    : Animator(std::shared_ptr<const Animation>(animation)) {}
+Animator::Animator(std::shared_ptr<const Animation> animation) {
   try {
-    SetupAnimator(animation);
+    SetupAnimator(std::move(animation));
   } catch (ModelException& e) {
     OpenGLLogMessage::GetInstance().AddLog(
         std::string(
@@ -36,53 +41,371 @@ Animator::Animator(Animation* animation) {
 void Animator::UpdateAnimation(glm::float64 delete_time) {
   this->delta_time_ = delete_time;
   if (this->current_animation_) {
-    this->current_time_ +=
-        current_animation_->GetTicksPerSecond() * delta_time_;
     this->current_time_ =
-        fmod(this->current_time_, current_animation_->GetDuration());
-    CalculateBoneTransform(this->current_animation_->GetRootNode(),
-                           glm::mat4(1.0f));
+        AdvanceTime(*current_animation_, current_time_, delta_time_);
+    if (fading_) {
+      if (fade_animation_ != nullptr) {
+        fade_time_ = AdvanceTime(*fade_animation_, fade_time_, delta_time_);
+      }
+      fade_elapsed_ += delta_time_;
+      if (fade_elapsed_ >= fade_duration_) {
+        fading_ = false;
+        fade_animation_ = nullptr;
+      }
+    }
+    for (auto& playback : layers_) {
+      playback.time =
+          AdvanceTime(*playback.layer.animation, playback.time, delta_time_);
+    }
+    evaluated_bone_count_ = 0;
+    if (!lod_.visible) {
+      pose_stale_ = true;
+      return;
+    }
+    if (lod_.update_interval <= 1 || pose_stale_) {
+      CalculatePose(final_bone_matrices_);
+      pose_stale_ = false;
+      interpolation_step_ = kNoTarget;
+      return;
+    }
+    InterpolatePose();
+  }
+}
+void Animator::UpdateAnimation(glm::float64 delete_time, glm::vec4* palette,
+                               PaletteFormat format) {
+  UpdateAnimation(delete_time);
+  WritePalette(palette, format);
+}
+void Animator::WritePalette(glm::vec4* palette, PaletteFormat format) const {
+  const glm::uint32 texels = GetTexelsPerBone(format);
+  for (const auto& matrix : final_bone_matrices_) {
+    PackBone(matrix, format, palette);
+    palette += texels;
+  }
+}
+glm::uint32 Animator::GetTexelsPerBone(PaletteFormat format) {
+  switch (format) {
+    case PaletteFormat::kMatrix3x4:
+      return 3;
+    case PaletteFormat::kDualQuaternion:
+      return 2;
+    default:
+      return 4;
+  }
+}
+void Animator::PackBone(const glm::mat4& matrix, PaletteFormat format,
+                        glm::vec4* texels) {
+  switch (format) {
+    case PaletteFormat::kMatrix3x4:
+      // glm is column major, the shader takes one dot product per row.
+      for (int row = 0; row < 3; ++row) {
+        texels[row] = glm::vec4(matrix[0][row], matrix[1][row],
+                                matrix[2][row], matrix[3][row]);
+      }
+      break;
+    case PaletteFormat::kDualQuaternion: {
+      // Removes the scale first, quat_cast expects a pure rotation.
+      glm::mat3 rotation(glm::normalize(glm::vec3(matrix[0])),
+                         glm::normalize(glm::vec3(matrix[1])),
+                         glm::normalize(glm::vec3(matrix[2])));
+      glm::quat real = glm::normalize(glm::quat_cast(rotation));
+      glm::quat translation(0.0f, matrix[3].x, matrix[3].y, matrix[3].z);
+      glm::quat dual = 0.5f * (translation * real);
+      texels[0] = glm::vec4(real.x, real.y, real.z, real.w);
+      texels[1] = glm::vec4(dual.x, dual.y, dual.z, dual.w);
+      break;
+    }
+    default:
+      for (int column = 0; column < 4; ++column) {
+        texels[column] = matrix[column];
+      }
+      break;
   }
 }
 void Animator::ResetAnimation(Animation* p_animation) {
-  SetupAnimator(p_animation);
+  SetupAnimator(std::shared_ptr<const Animation>(p_animation));
 }
-void Animator::CalculateBoneTransform(
-    const Animation::AssimpNodeData& node_data, glm::mat4 parent_transform) {
-  std::lock_guard<std::recursive_mutex> lock(bone_matrices_mutex_);
-  std::string node_name = node_data.name;
-  glm::mat4 node_transform = node_data.transformation;
-
-  auto bone = this->current_animation_->FindBone(node_name);
-  if (bone) {
-    bone->Update(this->current_time_);
-    node_transform = bone->GetLocalTransform();
+void Animator::ResetAnimation(std::shared_ptr<const Animation> animation) {
+  SetupAnimator(std::move(animation));
+}
+void Animator::CrossFade(std::shared_ptr<const Animation> animation,
+                         glm::float64 duration) {
+  if (nullptr == animation || nullptr == current_animation_ ||
+      !animation->SharesSkeleton(*current_animation_)) {
+    SetupAnimator(std::move(animation));
+    return;
   }
-
-  auto global_transformation = parent_transform * node_transform;
-  auto bone_info_map = this->current_animation_->GetBoneInfoMap();
-  if (bone_info_map.find(node_name) != bone_info_map.end()) {
-    auto index = bone_info_map[node_name].id;
-    auto offset = bone_info_map[node_name].offset;
-    this->final_bone_matrices_[index] = global_transformation * offset;
+  if (duration <= 0.0) {
+    fading_ = false;
+    fade_animation_ = nullptr;
+    StartClip(std::move(animation));
+    return;
+  }
+  if (fading_) {
+    // A fade started during a fade starts from the mix shown last, frozen,
+    // so the clip fading out does not vanish at once.
+    static const std::vector<glm::float32> kAllNodes;
+    LocalPose::Blend(fade_pose_, main_pose_,
+                     static_cast<glm::float32>(fade_elapsed_ / fade_duration_),
+                     kAllNodes, fade_pose_);
+    fade_animation_ = nullptr;
+  } else {
+    fade_animation_ = std::move(current_animation_);
+    fade_time_ = current_time_;
+    fade_cursors_.swap(cursors_);
+    fade_pose_.translations.swap(main_pose_.translations);
+    fade_pose_.rotations.swap(main_pose_.rotations);
+    fade_pose_.scales.swap(main_pose_.scales);
+  }
+  fading_ = true;
+  fade_duration_ = duration;
+  fade_elapsed_ = 0.0;
+  StartClip(std::move(animation));
+}
+bool Animator::IsFading() const {
+  return fading_;
+}
+glm::uint32 Animator::AddLayer(const AnimationLayer& layer) {
+  if (nullptr == layer.animation || nullptr == current_animation_ ||
+      !layer.animation->SharesSkeleton(*current_animation_)) {
+    throw ModelException(LoggerSystem::Level::kWarning,
+                         "The layer clip does not share the skeleton of the "
+                         "main clip.");
+  }
+  if (!layer.mask.empty() && layer.mask.size() != bind_pose_.GetSize()) {
+    throw ModelException(LoggerSystem::Level::kWarning,
+                         "The layer mask does not match the skeleton.");
+  }
+  LayerPlayback playback;
+  playback.layer = layer;
+  playback.cursors.assign(layer.animation->GetBones().size(), Bone::Cursor());
+  playback.pose = bind_pose_;
+  if (layer.blend == LayerBlend::kAdditive) {
+    // Sampled in full once, skipped leaves still need their reference.
+    playback.reference = bind_pose_;
+    const auto& skeleton = layer.animation->GetSkeleton();
+    Bone::Cursor cursor;
+    glm::vec3 translation;
+    glm::vec3 scale;
+    for (std::size_t i = 0; i < skeleton.size(); ++i) {
+      if (skeleton[i].channel < 0) {
+        continue;
+      }
+      layer.animation->GetBone(skeleton[i].channel)
+          .Sample(0.0, cursor, translation, playback.reference.rotations[i],
+                  scale);
+      playback.reference.translations[i] = glm::vec4(translation, 0.0f);
+      playback.reference.scales[i] = glm::vec4(scale, 0.0f);
+    }
   }
+  layers_.push_back(std::move(playback));
+  return static_cast<glm::uint32>(layers_.size() - 1);
+}
+void Animator::SetLayerWeight(glm::uint32 index, glm::float32 weight) {
+  layers_.at(index).layer.weight = weight;
+}
+glm::uint32 Animator::GetLayerCount() const {
+  return static_cast<glm::uint32>(layers_.size());
+}
+void Animator::ClearLayers() {
+  layers_.clear();
+}
+void Animator::SetLod(const AnimationLod& lod) {
+  lod_ = lod;
+}
+const AnimationLod& Animator::GetLod() const {
+  return lod_;
+}
+glm::uint32 Animator::GetEvaluatedBoneCount() const {
+  return evaluated_bone_count_;
+}
+const std::shared_ptr<const Animation>& Animator::GetAnimation() const {
+  return current_animation_;
+}
+void Animator::CalculatePose(std::vector<glm::mat4>& bone_matrices) {
+  if (fading_ || !layers_.empty()) {
+    EvaluateLocalPose();
+    std::lock_guard<std::mutex> lock(bone_matrices_mutex_);
+    ComposePose(pose_, bone_matrices);
+    composed_from_pose_ = true;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(bone_matrices_mutex_);
+  composed_from_pose_ = false;
+  const auto& skeleton = current_animation_->GetSkeleton();
+  for (std::size_t i = 0; i < skeleton.size(); ++i) {
+    const Animation::SkeletonNode& node = skeleton[i];
+    glm::mat4 node_transform = node.transformation;
+    if (node.channel >= 0) {
+      if (node.height >= lod_.skipped_leaf_levels) {
+        local_transforms_[i] = current_animation_->GetBone(node.channel)
+                                   .Sample(current_time_,
+                                           cursors_[node.channel]);
+        ++evaluated_bone_count_;
+      }
+      node_transform = local_transforms_[i];
+    }
 
-  for (int i = 0; i < node_data.children_count; ++i) {
-    CalculateBoneTransform(node_data.children[i], global_transformation);
+    global_transforms_[i] = node.parent < 0
+                                ? node_transform
+                                : global_transforms_[node.parent] *
+                                      node_transform;
+    if (node.bone_id >= 0) {
+      bone_matrices[node.bone_id] = global_transforms_[i] * node.offset;
+    }
+  }
+}
+glm::float64 Animator::AdvanceTime(const Animation& animation,
+                                   glm::float64 time,
+                                   glm::float64 delta_time) {
+  return fmod(time + animation.GetTicksPerSecond() * delta_time,
+              animation.GetDuration());
+}
+void Animator::SamplePose(const Animation& animation, glm::float64 time,
+                          std::vector<Bone::Cursor>& cursors,
+                          LocalPose& pose) {
+  const auto& skeleton = animation.GetSkeleton();
+  glm::vec3 translation;
+  glm::vec3 scale;
+  for (std::size_t i = 0; i < skeleton.size(); ++i) {
+    const Animation::SkeletonNode& node = skeleton[i];
+    if (node.channel < 0 || node.height < lod_.skipped_leaf_levels) {
+      continue;
+    }
+    animation.GetBone(node.channel)
+        .Sample(time, cursors[node.channel], translation, pose.rotations[i],
+                scale);
+    pose.translations[i] = glm::vec4(translation, 0.0f);
+    pose.scales[i] = glm::vec4(scale, 0.0f);
+    ++evaluated_bone_count_;
   }
 }
-void Animator::SetupAnimator(Animation* animation) {
+void Animator::EvaluateLocalPose() {
+  static const std::vector<glm::float32> kAllNodes;
+  SamplePose(*current_animation_, current_time_, cursors_, main_pose_);
+  if (fading_) {
+    if (fade_animation_ != nullptr) {
+      SamplePose(*fade_animation_, fade_time_, fade_cursors_, fade_pose_);
+    }
+    LocalPose::Blend(fade_pose_, main_pose_,
+                     static_cast<glm::float32>(fade_elapsed_ / fade_duration_),
+                     kAllNodes, pose_);
+  } else {
+    pose_ = main_pose_;
+  }
+  for (auto& playback : layers_) {
+    const AnimationLayer& layer = playback.layer;
+    if (layer.weight <= 0.0f) {
+      continue;
+    }
+    SamplePose(*layer.animation, playback.time, playback.cursors,
+               playback.pose);
+    if (layer.blend == LayerBlend::kAdditive) {
+      LocalPose::Add(pose_, playback.pose, playback.reference, layer.weight,
+                     layer.mask, pose_);
+    } else {
+      LocalPose::Blend(pose_, playback.pose, layer.weight, layer.mask, pose_);
+    }
+  }
+}
+void Animator::ComposePose(const LocalPose& pose,
+                           std::vector<glm::mat4>& bone_matrices) {
+  const auto& skeleton = current_animation_->GetSkeleton();
+  for (std::size_t i = 0; i < skeleton.size(); ++i) {
+    const Animation::SkeletonNode& node = skeleton[i];
+    glm::mat4 node_transform = pose.GetMatrix(i);
+    global_transforms_[i] = node.parent < 0
+                                ? node_transform
+                                : global_transforms_[node.parent] *
+                                      node_transform;
+    if (node.bone_id >= 0) {
+      bone_matrices[node.bone_id] = global_transforms_[i] * node.offset;
+    }
+  }
+}
+void Animator::InterpolatePose() {
+  static const std::vector<glm::float32> kAllNodes;
+  const glm::uint32 interval = lod_.update_interval;
+  if (interpolation_step_ >= interval) {
+    // Blends from the pose on screen, so changing the interval never jumps.
+    if (interpolation_step_ == kNoTarget) {
+      CaptureShownPose(start_pose_);
+    } else {
+      std::swap(start_pose_, target_pose_);
+    }
+    EvaluateLocalPose();
+    target_pose_ = pose_;
+    interpolation_step_ = 0;
+  }
+  ++interpolation_step_;
+  auto weight = static_cast<glm::float32>(interpolation_step_) /
+                static_cast<glm::float32>(interval);
+  // Blending the local transforms keeps every bone rigid, blending the
+  // bone matrices would shrink and shear the joints between samples.
+  LocalPose::Blend(start_pose_, target_pose_, weight, kAllNodes, pose_);
+  std::lock_guard<std::mutex> lock(bone_matrices_mutex_);
+  ComposePose(pose_, final_bone_matrices_);
+  composed_from_pose_ = true;
+}
+void Animator::CaptureShownPose(LocalPose& pose) {
+  if (composed_from_pose_) {
+    pose = pose_;
+    return;
+  }
+  pose.Resize(local_transforms_.size());
+  for (std::size_t i = 0; i < local_transforms_.size(); ++i) {
+    pose.SetMatrix(i, local_transforms_[i]);
+  }
+  // Skipped leaves keep the transform the direct path left them.
+  main_pose_ = pose;
+}
+void Animator::SetupAnimator(std::shared_ptr<const Animation> animation) {
   if (nullptr == animation) {
     throw ModelException(LoggerSystem::Level::kWarning,
                          "The animation class is not initialized, "
                          "so please initialize it and try again.");
   }
-  this->current_animation_ = animation;
-  auto bone_count = this->current_animation_->GetBones().size();
-  this->final_bone_matrices_ = std::vector<glm::mat4>(bone_count);
-  this->current_time_ = 0.0f;
+  const auto& skeleton = animation->GetSkeleton();
+  this->final_bone_matrices_ =
+      std::vector<glm::mat4>(animation->GetBoneCount(), glm::mat4(1.0f));
+  this->global_transforms_.resize(skeleton.size());
+  this->bind_pose_.Resize(skeleton.size());
+  for (std::size_t i = 0; i < skeleton.size(); ++i) {
+    this->bind_pose_.SetMatrix(i, skeleton[i].transformation);
+  }
+  this->interpolation_step_ = kNoTarget;
+  this->composed_from_pose_ = false;
+  this->pose_stale_ = true;
+  this->evaluated_bone_count_ = 0;
+  this->fading_ = false;
+  this->fade_animation_ = nullptr;
+  this->layers_.clear();
   this->delta_time_ = 0.0f;
+  StartClip(std::move(animation));
 }
-Animator::~Animator() {
-  delete current_animation_;
+void Animator::StartClip(std::shared_ptr<const Animation> animation) {
+  this->current_animation_ = std::move(animation);
+  this->local_transforms_.clear();
+  for (const auto& node : current_animation_->GetSkeleton()) {
+    this->local_transforms_.push_back(node.transformation);
+  }
+  this->main_pose_ = this->bind_pose_;
+  this->cursors_.assign(current_animation_->GetBones().size(), Bone::Cursor());
+  this->current_time_ = 0.0f;
+}
+AnimationLod AnimationLodPolicy::Select(glm::float32 distance,
+                                       bool visible) const {
+  AnimationLod lod;
+  lod.visible = visible;
+  for (glm::float32 limit = full_rate_distance;
+       distance > limit && lod.update_interval < max_update_interval;
+       limit *= 2.0f) {
+    lod.update_interval *= 2;
+  }
+  lod.update_interval = std::min(lod.update_interval,
+                                 std::max(max_update_interval, 1u));
+  if (distance > leaf_skip_distance) {
+    lod.skipped_leaf_levels = skipped_leaf_levels;
+  }
+  return lod;
 }
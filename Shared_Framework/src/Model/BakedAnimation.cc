@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/BakedAnimation.h"
+#include <algorithm>
+#include <cmath>
+#include "LoggerSystem.h"
+#include "Model/Animator.h"
+#include "Model/ModelException.h"
+#include "ImGui/OpenGLLogMessage.h"
+
+using namespace model;
+
+BakedAnimation::BakedAnimation(std::shared_ptr<const Animation> animation,
+                               glm::float32 frames_per_second)
+    : texture_(0),
+      frame_count_(0),
+      bone_count_(0),
+      frame_rate_(frames_per_second) {
+  std::vector<glm::vec4> texels;
+  try {
+    frame_count_ = Bake(animation, frames_per_second, texels, frame_rate_);
+    bone_count_ = animation->GetBoneCount();
+  } catch (ModelException& e) {
+    OpenGLLogMessage::GetInstance().AddLog(
+        std::string("There was an error baking the animation because: ") +
+        e.what());
+    return;
+  }
+  if (bone_count_ == 0) {
+    return;
+  }
+
+  glGenTextures(1, &texture_);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F,
+               static_cast<GLsizei>(bone_count_ * kTexelsPerBone),
+               static_cast<GLsizei>(frame_count_), 0, GL_RGBA, GL_FLOAT,
+               texels.data());
+  // The shader fetches exact texels and blends the frames itself.
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+BakedAnimation::~BakedAnimation() {
+  if (texture_ != 0) {
+    glDeleteTextures(1, &texture_);
+  }
+}
+
+glm::uint32 BakedAnimation::Bake(
+    const std::shared_ptr<const Animation>& animation,
+    glm::float32 frames_per_second, std::vector<glm::vec4>& texels,
+    glm::float32& frame_rate) {
+  if (nullptr == animation) {
+    throw ModelException(LoggerSystem::Level::kWarning,
+                         "The animation class is not initialized, "
+                         "so please initialize it and try again.");
+  }
+  glm::float64 seconds =
+      animation->GetDuration() / animation->GetTicksPerSecond();
+  glm::uint32 frame_count = 1;
+  frame_rate = frames_per_second;
+  if (seconds > 0.0 && frames_per_second > 0.0f) {
+    // A whole number of frames per loop, so the last frame blends into the
+    // first one.
+    frame_count = static_cast<glm::uint32>(
+        std::max(1.0, std::round(seconds * frames_per_second)));
+    frame_rate = static_cast<glm::float32>(frame_count / seconds);
+  }
+
+  const std::size_t row = animation->GetBoneCount() * kTexelsPerBone;
+  texels.resize(frame_count * row);
+  // Steps forward through the clip, so the key cursors only move ahead.
+  Animator animator(animation);
+  animator.UpdateAnimation(0.0);
+  for (glm::uint32 frame = 0; frame < frame_count; ++frame) {
+    if (frame > 0) {
+      animator.UpdateAnimation(seconds / frame_count);
+    }
+    animator.WritePalette(texels.data() + frame * row,
+                          PaletteFormat::kMatrix3x4);
+  }
+  return frame_count;
+}
+
+void BakedAnimation::Bind(Shader& shader) const {
+  glActiveTexture(GL_TEXTURE0 + kTextureUnit);
+  glBindTexture(GL_TEXTURE_2D, texture_);
+  glActiveTexture(GL_TEXTURE0);
+  shader.SetInt("baked_palette", static_cast<GLint>(kTextureUnit));
+  shader.SetInt("baked_frame_count", static_cast<GLint>(frame_count_));
+  shader.SetFloat("baked_frame_rate", frame_rate_);
+}
+
+glm::uint32 BakedAnimation::GetFrameCount() const {
+  return frame_count_;
+}
+
+glm::uint32 BakedAnimation::GetBoneCount() const {
+  return bone_count_;
+}
+
+glm::float32 BakedAnimation::GetFrameRate() const {
+  return frame_rate_;
+}
+
+GLuint BakedAnimation::GetTextureId() const {
+  return texture_;
+}
@@ -16,19 +16,10 @@
 
 #include <utility>
 
-#include "LoggerSystem.h"
 #include "Model/Bone.h"
-#include "Model/ModelException.h"
-#include "ImGui/OpenGLLogMessage.h"
 
 using namespace model;
 
-const glm::mat4& Bone::GetLocalTransform() const {
-  return local_transform_;
-}
-void Bone::SetLocalTransform(const glm::mat4& local_transform) {
-  local_transform_ = local_transform;
-}
 const std::string& Bone::GetBoneName() const {
   return bone_name_;
 }
@@ -41,10 +32,13 @@ glm::int32 Bone::GetId() const {
 void Bone::SetId(glm::int32 id) {
   bone_id_ = id;
 }
-Bone::Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel)
+Bone::Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel,
+           const KeyframeCompression::Settings& settings)
     : bone_name_(std::move(bone_name)),
-      bone_id_(bone_id),
-      local_transform_(1.0f) {
+      bone_id_(bone_id) {
+  std::vector<KeyPosition> positions;
+  std::vector<KeyRotation> rotations;
+  std::vector<KeyScale> scales;
 
   for (int position_index = 0; position_index < channel->mNumPositionKeys;
        ++position_index) {
@@ -52,7 +46,7 @@ Bone::Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel)
     data.position = AssimpGLMHelpers::GetInstance().Assimp3DToGLMVec3(
         channel->mPositionKeys[position_index].mValue);
     data.time_stamp = channel->mPositionKeys[position_index].mTime;
-    this->positions_.push_back(data);
+    positions.push_back(data);
   }
 
   for (int rotation_index = 0; rotation_index < channel->mNumRotationKeys;
@@ -62,7 +56,7 @@ Bone::Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel)
         AssimpGLMHelpers::GetInstance().AssimpQuaternionToGLMQuaternion(
             channel->mRotationKeys[rotation_index].mValue);
     data.time_stamp = channel->mRotationKeys[rotation_index].mTime;
-    this->rotations_.push_back(data);
+    rotations.push_back(data);
   }
 
   for (int key_index = 0; key_index < channel->mNumScalingKeys; ++key_index) {
@@ -70,110 +64,117 @@ Bone::Bone(std::string bone_name, int bone_id, const aiNodeAnim* channel)
     data.scale = AssimpGLMHelpers::GetInstance().Assimp3DToGLMVec3(
         channel->mScalingKeys[key_index].mValue);
     data.time_stamp = channel->mScalingKeys[key_index].mTime;
-    this->scales_.push_back(data);
+    scales.push_back(data);
   }
+
+  Compress(positions, rotations, scales, settings);
 }
-void Bone::Update(glm::float64 animation_time) {
-  try {
-    glm::mat4 translation = InterpolatePosition(animation_time);
-    glm::mat4 rotation = InterpolateRotation(animation_time);
-    glm::mat4 scale = InterpolateScale(animation_time);
-    this->local_transform_ = translation * rotation * scale;
-  } catch (ModelException& e) {
-    OpenGLLogMessage::GetInstance().AddLog(
-        std::string("Bones load incorrectly because of the following: ") +
-        e.what());
-  }
+Bone::Bone(std::string bone_name, int bone_id,
+           const std::vector<KeyPosition>& positions,
+           const std::vector<KeyRotation>& rotations,
+           const std::vector<KeyScale>& scales,
+           const KeyframeCompression::Settings& settings)
+    : bone_name_(std::move(bone_name)),
+      bone_id_(bone_id) {
+  Compress(positions, rotations, scales, settings);
 }
-glm::int32 Bone::GetPositionsIndex(glm::float64 animation_time) {
-  for (int index = 0; index < this->positions_.size() - 1; ++index) {
-    if (animation_time < this->positions_[index + 1].time_stamp)
-      return index;
-  }
-
-  throw ModelException(LoggerSystem::Level::kError,
-                       "The position index of the animation point "
-                       "is not stored, the file is from: " +
-                           bone_name_);
-}
-glm::int32 Bone::GetRotationIndex(glm::float64 animation_time) {
-  for (int index = 0; index < this->rotations_.size() - 1; ++index) {
-    if (animation_time < this->rotations_[index + 1].time_stamp)
-      return index;
+void Bone::Compress(const std::vector<KeyPosition>& positions,
+                    const std::vector<KeyRotation>& rotations,
+                    const std::vector<KeyScale>& scales,
+                    const KeyframeCompression::Settings& settings) {
+  // The compressor works on separate time and value arrays.
+  std::vector<glm::float64> times;
+  std::vector<glm::vec3> vectors;
+  for (const auto& key : positions) {
+    times.push_back(key.time_stamp);
+    vectors.push_back(key.position);
   }
-
-  throw ModelException(LoggerSystem::Level::kError,
-                       "The rotation index of the animation point "
-                       "is not stored, the file is from: " +
-                           bone_name_);
-}
-glm::int32 Bone::GetScaleIndex(glm::float64 animation_time) {
-  for (int index = 0; index < this->scales_.size() - 1; ++index) {
-    if (animation_time < this->scales_[index + 1].time_stamp)
-      return index;
+  positions_ = KeyframeCompression::CompressVectors(
+      times, vectors, settings.position_tolerance, &report_,
+      &report_.max_position_error);
+
+  times.clear();
+  std::vector<glm::quat> orientations;
+  for (const auto& key : rotations) {
+    times.push_back(key.time_stamp);
+    orientations.push_back(key.orientation);
   }
-
-  throw ModelException(LoggerSystem::Level::kError,
-                       "The scale index of the animation point is "
-                       "not stored, the file is from: " +
-                           bone_name_);
-}
-glm::float64 Bone::GetScaleFactor(glm::float64 last_time_stamp,
-                                  glm::float64 next_time_stamp,
-                                  glm::float64 animation_time) {
-  auto mid_way_length = animation_time - last_time_stamp;
-  auto frames_diff = next_time_stamp - last_time_stamp;
-  auto scale_factor = mid_way_length / frames_diff;
-  return scale_factor;
-}
-glm::mat4 Bone::InterpolatePosition(glm::float64 animation_time) {
-  if (1 == this->positions_.size())
-    return glm::translate(glm::mat4(1.0f), this->positions_[0].position);
-
-  auto last_time_index = GetPositionsIndex(animation_time);
-  auto next_time_index = last_time_index + 1;
-  auto scale_factor = GetScaleFactor(
-      this->positions_[last_time_index].time_stamp,
-      this->positions_[next_time_index].time_stamp, animation_time);
-
-  auto final_position =
-      glm::mix(this->positions_[last_time_index].position,
-               this->positions_[next_time_index].position, scale_factor);
-  return glm::translate(glm::mat4(1.0f), final_position);
-}
-glm::mat4 Bone::InterpolateRotation(glm::float64 animation_time) {
-  if (1 == this->rotations_.size()) {
-    auto rotation = glm::normalize(this->rotations_[0].orientation);
-    return glm::toMat4(rotation);
+  rotations_ = KeyframeCompression::CompressRotations(
+      times, orientations, settings.rotation_tolerance, &report_,
+      &report_.max_rotation_error);
+
+  times.clear();
+  vectors.clear();
+  for (const auto& key : scales) {
+    times.push_back(key.time_stamp);
+    vectors.push_back(key.scale);
   }
+  scales_ = KeyframeCompression::CompressVectors(
+      times, vectors, settings.scale_tolerance, &report_,
+      &report_.max_scale_error);
+}
+glm::mat4 Bone::Sample(glm::float64 animation_time, Cursor& cursor) const {
+  glm::vec3 translation;
+  glm::quat rotation;
+  glm::vec3 scale;
+  Sample(animation_time, cursor, translation, rotation, scale);
+  return Compose(translation, rotation, scale);
+}
+void Bone::Sample(glm::float64 animation_time, Cursor& cursor,
+                  glm::vec3& translation, glm::quat& rotation,
+                  glm::vec3& scale) const {
+  translation = InterpolatePosition(animation_time, cursor);
+  rotation = InterpolateRotation(animation_time, cursor);
+  scale = InterpolateScale(animation_time, cursor);
+}
+glm::mat4 Bone::Compose(const glm::vec3& translation, const glm::quat& rotation,
+                        const glm::vec3& scale) {
+  // Equals translate * rotate * scale, without the two matrix products.
+  glm::mat3 basis = glm::mat3_cast(rotation);
+  return glm::mat4(glm::vec4(basis[0] * scale.x, 0.0f),
+                   glm::vec4(basis[1] * scale.y, 0.0f),
+                   glm::vec4(basis[2] * scale.z, 0.0f),
+                   glm::vec4(translation, 1.0f));
+}
+glm::int32 Bone::GetPositionsIndex(glm::float64 animation_time,
+                                   Cursor& cursor) const {
+  return KeyframeCompression::FindKey(positions_.times, animation_time,
+                                      cursor.position);
+}
+glm::int32 Bone::GetRotationIndex(glm::float64 animation_time,
+                                  Cursor& cursor) const {
+  return KeyframeCompression::FindKey(rotations_.times, animation_time,
+                                      cursor.rotation);
+}
+glm::int32 Bone::GetScaleIndex(glm::float64 animation_time,
+                               Cursor& cursor) const {
+  return KeyframeCompression::FindKey(scales_.times, animation_time,
+                                      cursor.scale);
+}
+const KeyframeCompression::Report& Bone::GetCompressionReport() const {
+  return report_;
+}
+glm::vec3 Bone::InterpolatePosition(glm::float64 animation_time,
+                                    Cursor& cursor) const {
+  if (this->positions_.times.empty())
+    return glm::vec3(0.0f);
 
-  auto last_time_index = GetRotationIndex(animation_time);
-  auto next_time_index = last_time_index + 1;
-  auto scale_factor = GetScaleFactor(
-      this->rotations_[last_time_index].time_stamp,
-      this->rotations_[next_time_index].time_stamp, animation_time);
+  return KeyframeCompression::Sample(positions_, animation_time,
+                                     cursor.position);
+}
+glm::quat Bone::InterpolateRotation(glm::float64 animation_time,
+                                    Cursor& cursor) const {
+  if (this->rotations_.times.empty())
+    return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
 
   auto final_rotation =
-      glm::slerp(this->rotations_[last_time_index].orientation,
-                 this->rotations_[next_time_index].orientation,
-                 static_cast<glm::float32>(scale_factor));
-
-  return glm::toMat4(final_rotation);
+      KeyframeCompression::Sample(rotations_, animation_time, cursor.rotation);
+  return glm::normalize(final_rotation);
 }
-glm::mat4 Bone::InterpolateScale(glm::float64 animation_time) {
-  if (1 == this->scales_.size())
-    return glm::scale(glm::mat4(1.0f), this->scales_[0].scale);
-
-  auto last_time_index = GetScaleIndex(animation_time);
-  auto next_time_index = last_time_index + 1;
-
-  auto scale_factor =
-      GetScaleFactor(this->scales_[last_time_index].time_stamp,
-                     this->scales_[next_time_index].time_stamp, animation_time);
-
-  auto final_scale =
-      glm::mix(this->scales_[last_time_index].scale,
-               this->scales_[next_time_index].scale, scale_factor);
+glm::vec3 Bone::InterpolateScale(glm::float64 animation_time,
+                                 Cursor& cursor) const {
+  if (this->scales_.times.empty())
+    return glm::vec3(1.0f);
 
-  return glm::scale(glm::mat4(1.0f), final_scale);
+  return KeyframeCompression::Sample(scales_, animation_time, cursor.scale);
 }
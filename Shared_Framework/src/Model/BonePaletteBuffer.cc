@@ -0,0 +1,104 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/BonePaletteBuffer.h"
+#include "Model/AnimationBatch.h"
+
+using namespace model;
+
+BonePaletteBuffer::BonePaletteBuffer(PaletteFormat format)
+    : buffer_(1, GL_TEXTURE_BUFFER),
+      texture_(0),
+      format_(format),
+      count_(0),
+      capacity_(0) {
+  glGenTextures(1, &texture_);
+}
+
+BonePaletteBuffer::~BonePaletteBuffer() {
+  glDeleteTextures(1, &texture_);
+}
+
+void BonePaletteBuffer::Update(const std::vector<Animator*>& animators,
+                               glm::float64 delta_time) {
+  count_ = AnimationBatch::GetPaletteOffsets(animators, offsets_);
+  if (count_ == 0) {
+    AnimationBatch::Update(animators, delta_time);
+    return;
+  }
+  const GLsizeiptr bone_size =
+      Animator::GetTexelsPerBone(format_) * sizeof(glm::vec4);
+  if (count_ > capacity_) {
+    // Grow with headroom so a slowly growing crowd does not reallocate every
+    // frame.
+    capacity_ = count_ + count_ / 2;
+    buffer_.Bind();
+    buffer_.SetData(nullptr, capacity_ * bone_size, GL_STREAM_DRAW);
+    buffer_.UnBind();
+    glBindTexture(GL_TEXTURE_BUFFER, texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer_.GetBufferId());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+
+  GLsizeiptr size = count_ * bone_size;
+  buffer_.Bind();
+  // Invalidating lets the driver hand out fresh memory instead of waiting
+  // for draws that still read last frame's palettes.
+  auto* mapped = static_cast<glm::vec4*>(glMapBufferRange(
+      GL_TEXTURE_BUFFER, 0, size,
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+  if (mapped != nullptr) {
+    AnimationBatch::Update(animators, delta_time, offsets_, mapped, format_);
+    glUnmapBuffer(GL_TEXTURE_BUFFER);
+  } else {
+    AnimationBatch::Update(animators, delta_time);
+    for (std::size_t i = 0; i < animators.size(); ++i) {
+      if (animators[i] == nullptr) {
+        continue;
+      }
+      auto bones = animators[i]->GetFinalBoneMatrices().size();
+      staging_.resize(bones * Animator::GetTexelsPerBone(format_));
+      animators[i]->WritePalette(staging_.data(), format_);
+      buffer_.SetSubData(static_cast<GLintptr>(offsets_[i] * bone_size),
+                         static_cast<GLsizeiptr>(bones * bone_size),
+                         staging_.data());
+    }
+  }
+  buffer_.UnBind();
+}
+
+void BonePaletteBuffer::Bind(Shader& shader) const {
+  glActiveTexture(GL_TEXTURE0 + kTextureUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, texture_);
+  glActiveTexture(GL_TEXTURE0);
+  shader.SetInt("bone_palette", static_cast<GLint>(kTextureUnit));
+}
+
+glm::uint32 BonePaletteBuffer::GetOffset(std::size_t index) const {
+  return offsets_[index];
+}
+
+glm::uint32 BonePaletteBuffer::GetBoneCount() const {
+  return count_;
+}
+
+PaletteFormat BonePaletteBuffer::GetFormat() const {
+  return format_;
+}
+
+GLuint BonePaletteBuffer::GetBufferId() const {
+  return buffer_.GetBufferId();
+}
@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/BoundingVolume.h"
+#include <algorithm>
+
+using namespace model;
+
+namespace {
+/**
+ * Ritter's bounding sphere over count points read through position(i).
+ */
+template <typename PositionFunction>
+BoundingSphere RitterSphere(std::size_t count, PositionFunction position) {
+  BoundingSphere sphere;
+  if (count == 0) {
+    return sphere;
+  }
+
+  // Pick the point farthest from an arbitrary point, then the point farthest
+  // from that one; the segment between them seeds the sphere.
+  auto farthest_from = [count, &position](const glm::vec3& point) {
+    std::size_t best = 0;
+    glm::float32 best_distance = -1.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+      glm::vec3 offset = position(i) - point;
+      glm::float32 distance = glm::dot(offset, offset);
+      if (distance > best_distance) {
+        best_distance = distance;
+        best = i;
+      }
+    }
+    return position(best);
+  };
+
+  glm::vec3 first = farthest_from(position(0));
+  glm::vec3 second = farthest_from(first);
+  sphere.center = (first + second) * 0.5f;
+  sphere.radius = glm::length(second - first) * 0.5f;
+
+  // Grow the sphere just enough to include every point that is still outside.
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::vec3 offset = position(i) - sphere.center;
+    glm::float32 distance = glm::length(offset);
+    if (distance > sphere.radius) {
+      glm::float32 new_radius = (sphere.radius + distance) * 0.5f;
+      sphere.center += offset * ((new_radius - sphere.radius) / distance);
+      sphere.radius = new_radius;
+    }
+  }
+  return sphere;
+}
+}  // namespace
+
+bool AxisAlignedBox::IsEmpty() const {
+  return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+void AxisAlignedBox::Expand(const glm::vec3& point) {
+  min = glm::min(min, point);
+  max = glm::max(max, point);
+}
+
+void AxisAlignedBox::Expand(const AxisAlignedBox& box) {
+  if (box.IsEmpty()) {
+    return;
+  }
+  min = glm::min(min, box.min);
+  max = glm::max(max, box.max);
+}
+
+glm::vec3 AxisAlignedBox::GetCenter() const {
+  return (min + max) * 0.5f;
+}
+
+glm::vec3 AxisAlignedBox::GetExtents() const {
+  return (max - min) * 0.5f;
+}
+
+AxisAlignedBox AxisAlignedBox::Transform(const glm::mat4& transform) const {
+  if (IsEmpty()) {
+    return *this;
+  }
+  // Transform the center, then project the extents onto each world axis
+  // using the absolute values of the rotation and scale part (Arvo's method).
+  glm::vec3 center = glm::vec3(transform * glm::vec4(GetCenter(), 1.0f));
+  glm::vec3 extents = GetExtents();
+  glm::vec3 new_extents = glm::abs(glm::vec3(transform[0])) * extents.x +
+                          glm::abs(glm::vec3(transform[1])) * extents.y +
+                          glm::abs(glm::vec3(transform[2])) * extents.z;
+  AxisAlignedBox result;
+  result.min = center - new_extents;
+  result.max = center + new_extents;
+  return result;
+}
+
+AxisAlignedBox AxisAlignedBox::FromVertices(
+    const std::vector<meshdata::Vertex>& vertices) {
+  AxisAlignedBox box;
+  for (const auto& vertex : vertices) {
+    box.Expand(vertex.position);
+  }
+  return box;
+}
+
+bool BoundingSphere::IsEmpty() const {
+  return radius < 0.0f;
+}
+
+BoundingSphere BoundingSphere::Transform(const glm::mat4& transform) const {
+  if (IsEmpty()) {
+    return *this;
+  }
+  BoundingSphere result;
+  result.center = glm::vec3(transform * glm::vec4(center, 1.0f));
+  glm::float32 max_scale_squared =
+      std::max({glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+                glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))});
+  result.radius = radius * glm::sqrt(max_scale_squared);
+  return result;
+}
+
+BoundingSphere BoundingSphere::FromVertices(
+    const std::vector<meshdata::Vertex>& vertices) {
+  return RitterSphere(vertices.size(), [&vertices](std::size_t i) {
+    return vertices[i].position;
+  });
+}
+
+BoundingSphere BoundingSphere::FromPoints(
+    const std::vector<glm::vec3>& points) {
+  return RitterSphere(points.size(),
+                      [&points](std::size_t i) { return points[i]; });
+}
+
+bool SkinnedBounds::IsEmpty() const {
+  if (!unskinned_box.IsEmpty()) {
+    return false;
+  }
+  return std::all_of(bone_boxes.begin(), bone_boxes.end(),
+                     [](const AxisAlignedBox& box) { return box.IsEmpty(); });
+}
+
+void SkinnedBounds::Expand(const SkinnedBounds& bounds) {
+  if (bounds.bone_boxes.size() > bone_boxes.size()) {
+    bone_boxes.resize(bounds.bone_boxes.size());
+  }
+  for (std::size_t i = 0; i < bounds.bone_boxes.size(); ++i) {
+    bone_boxes[i].Expand(bounds.bone_boxes[i]);
+  }
+  unskinned_box.Expand(bounds.unskinned_box);
+}
+
+AxisAlignedBox SkinnedBounds::Pose(
+    const std::vector<glm::mat4>& bone_matrices) const {
+  AxisAlignedBox box = unskinned_box;
+  std::size_t count = std::min(bone_boxes.size(), bone_matrices.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!bone_boxes[i].IsEmpty()) {
+      box.Expand(bone_boxes[i].Transform(bone_matrices[i]));
+    }
+  }
+  return box;
+}
+
+SkinnedBounds SkinnedBounds::FromVertices(
+    const std::vector<meshdata::Vertex>& vertices) {
+  SkinnedBounds bounds;
+  for (const auto& vertex : vertices) {
+    bool skinned = false;
+    for (int i = 0; i < meshdata::kMaxBoneInfluence; ++i) {
+      glm::int32 bone = vertex.bone_ids[i];
+      if (bone < 0 || vertex.weights[i] <= 0.0f) {
+        continue;
+      }
+      if (static_cast<std::size_t>(bone) >= bounds.bone_boxes.size()) {
+        bounds.bone_boxes.resize(bone + 1);
+      }
+      bounds.bone_boxes[bone].Expand(vertex.position);
+      skinned = true;
+    }
+    if (!skinned) {
+      bounds.unskinned_box.Expand(vertex.position);
+    }
+  }
+  return bounds;
+}
@@ -0,0 +1,51 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/ImportSession.h"
+
+using namespace model;
+
+ImportSession::ImportSession(const std::string& path, unsigned int flags)
+    : scene_(nullptr), path_(path) {
+  scene_ = importer_.ReadFile(path, flags);
+  if (scene_ == nullptr) {
+    error_ = importer_.GetErrorString();
+  }
+}
+
+const aiScene* ImportSession::GetScene() const {
+  return scene_;
+}
+
+const std::string& ImportSession::GetPath() const {
+  return path_;
+}
+
+const std::string& ImportSession::GetError() const {
+  return error_;
+}
+
+glm::uint32 ImportSession::GetAnimationCount() const {
+  return scene_ != nullptr ? scene_->mNumAnimations : 0;
+}
+
+std::vector<std::string> ImportSession::GetAnimationNames() const {
+  std::vector<std::string> names;
+  for (glm::uint32 i = 0; i < GetAnimationCount(); ++i) {
+    names.emplace_back(scene_->mAnimations[i]->mName.C_Str());
+  }
+  return names;
+}
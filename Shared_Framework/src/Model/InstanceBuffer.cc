@@ -0,0 +1,142 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/InstanceBuffer.h"
+
+using namespace model;
+
+InstanceBuffer::InstanceBuffer()
+    : buffer_(1, GL_ARRAY_BUFFER),
+      count_(0),
+      capacity_(0),
+      parameter_buffer_(1, GL_ARRAY_BUFFER),
+      parameter_count_(0),
+      parameter_capacity_(0) {}
+
+void InstanceBuffer::SetTransforms(const std::vector<glm::mat4>& transforms) {
+  Upload(transforms.data(), static_cast<GLsizei>(transforms.size()));
+  UploadParameters(nullptr, 0);
+}
+
+void InstanceBuffer::SetTransforms(const std::vector<glm::mat4>& transforms,
+                                   const std::vector<glm::vec4>& parameters) {
+  Upload(transforms.data(), static_cast<GLsizei>(transforms.size()));
+  UploadParameters(parameters.data(), static_cast<GLsizei>(parameters.size()));
+}
+
+GLsizei InstanceBuffer::SetVisibleTransforms(
+    const std::vector<glm::mat4>& transforms, const BoundingSphere& bounds,
+    const Frustum& frustum) {
+  return SetVisibleTransforms(transforms, {}, bounds, frustum);
+}
+
+GLsizei InstanceBuffer::SetVisibleTransforms(
+    const std::vector<glm::mat4>& transforms,
+    const std::vector<glm::vec4>& parameters, const BoundingSphere& bounds,
+    const Frustum& frustum) {
+  const bool has_parameters = !parameters.empty();
+  spheres_.resize(transforms.size());
+  visible_.resize(transforms.size());
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    BoundingSphere sphere = bounds.Transform(transforms[i]);
+    spheres_[i] = glm::vec4(sphere.center, sphere.radius);
+  }
+  frustum.CullSpheres(spheres_.data(), spheres_.size(), visible_.data());
+
+  compacted_.clear();
+  compacted_parameters_.clear();
+  for (std::size_t i = 0; i < transforms.size(); ++i) {
+    if (visible_[i]) {
+      compacted_.push_back(transforms[i]);
+      if (has_parameters) {
+        compacted_parameters_.push_back(parameters[i]);
+      }
+    }
+  }
+  Upload(compacted_.data(), static_cast<GLsizei>(compacted_.size()));
+  UploadParameters(compacted_parameters_.data(),
+                   static_cast<GLsizei>(compacted_parameters_.size()));
+  return count_;
+}
+
+void InstanceBuffer::AttachTo(const VertexArray& vao) const {
+  buffer_.Bind();
+  // A mat4 attribute takes four consecutive vec4 locations.
+  for (GLuint column = 0; column < 4; ++column) {
+    vao.AddBuffer(kFirstAttribute + column, 4, GL_FLOAT, GL_FALSE,
+                  sizeof(glm::mat4),
+                  (void*)(column * sizeof(glm::vec4)));
+    vao.SetAttribDivisor(kFirstAttribute + column, 1);
+  }
+  buffer_.UnBind();
+
+  if (parameter_count_ == 0) {
+    glDisableVertexAttribArray(kParameterAttribute);
+    return;
+  }
+  parameter_buffer_.Bind();
+  vao.AddBuffer(kParameterAttribute, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4),
+                (void*)0);
+  vao.SetAttribDivisor(kParameterAttribute, 1);
+  parameter_buffer_.UnBind();
+}
+
+GLsizei InstanceBuffer::GetCount() const {
+  return count_;
+}
+
+GLuint InstanceBuffer::GetBufferId() const {
+  return buffer_.GetBufferId();
+}
+
+void InstanceBuffer::Upload(const glm::mat4* data, GLsizei count) {
+  count_ = count;
+  if (count == 0) {
+    return;
+  }
+  auto size = static_cast<GLsizeiptr>(count * sizeof(glm::mat4));
+  if (count > capacity_) {
+    // Grow with headroom so a slowly growing set does not reallocate every
+    // frame.
+    capacity_ = count + count / 2;
+  }
+  buffer_.Bind();
+  // Respecifying the storage orphans the old one, so the driver does not
+  // wait for draws that still read it.
+  buffer_.SetData(nullptr,
+                  static_cast<GLsizeiptr>(capacity_ * sizeof(glm::mat4)),
+                  GL_STREAM_DRAW);
+  buffer_.SetSubData(0, size, data);
+  buffer_.UnBind();
+}
+
+void InstanceBuffer::UploadParameters(const glm::vec4* data, GLsizei count) {
+  parameter_count_ = count;
+  if (count == 0) {
+    return;
+  }
+  if (count > parameter_capacity_) {
+    parameter_capacity_ = count + count / 2;
+  }
+  parameter_buffer_.Bind();
+  parameter_buffer_.SetData(
+      nullptr,
+      static_cast<GLsizeiptr>(parameter_capacity_ * sizeof(glm::vec4)),
+      GL_STREAM_DRAW);
+  parameter_buffer_.SetSubData(
+      0, static_cast<GLsizeiptr>(count * sizeof(glm::vec4)), data);
+  parameter_buffer_.UnBind();
+}
@@ -0,0 +1,345 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/KeyframeCompression.h"
+#include <algorithm>
+
+using namespace model;
+
+namespace {
+// Largest value of the three smaller components of a unit quaternion.
+constexpr glm::float32 kSqrtHalf = 0.70710678f;
+constexpr glm::uint32 kRotationBits = 15;
+constexpr glm::float32 kRotationMax = (1u << kRotationBits) - 1;
+constexpr glm::float32 kVectorMax = 65535.0f;
+
+glm::float32 Distance(const glm::vec3& a, const glm::vec3& b) {
+  return glm::length(a - b);
+}
+
+// Angle between two rotations, q and -q being the same rotation. The half
+// angle between the quaternions is measured with atan2, as acos has no
+// precision left near 1.
+glm::float32 Distance(const glm::quat& a, const glm::quat& b) {
+  glm::vec4 u(a.x, a.y, a.z, a.w);
+  glm::vec4 v(b.x, b.y, b.z, b.w);
+  if (glm::dot(u, v) < 0.0f) {
+    v = -v;
+  }
+  return 4.0f * glm::atan(glm::length(u - v), glm::length(u + v));
+}
+
+glm::vec3 Interpolate(const glm::vec3& a, const glm::vec3& b,
+                      glm::float32 factor) {
+  return glm::mix(a, b, factor);
+}
+
+glm::quat Interpolate(const glm::quat& a, const glm::quat& b,
+                      glm::float32 factor) {
+  return glm::slerp(a, b, factor);
+}
+
+glm::float32 GetFactor(glm::float64 last_time, glm::float64 next_time,
+                       glm::float64 time) {
+  auto frames_diff = next_time - last_time;
+  if (frames_diff <= 0.0) {
+    return 0.0f;
+  }
+  return static_cast<glm::float32>(
+      glm::clamp((time - last_time) / frames_diff, 0.0, 1.0));
+}
+
+/**
+ * Picks the keys that interpolation cannot reproduce. Walking forward from
+ * the last kept key, a key is only kept once interpolating past it would
+ * move one of the skipped keys by more than the tolerance.
+ * @param times The key times.
+ * @param values The key values.
+ * @param tolerance The largest error of a dropped key, negative to keep
+ * every key.
+ * @return The indices of the kept keys, in ascending order.
+ */
+template <typename T>
+std::vector<glm::uint32> ReduceKeys(const std::vector<glm::float64>& times,
+                                    const std::vector<T>& values,
+                                    glm::float32 tolerance) {
+  auto count = static_cast<glm::uint32>(values.size());
+  std::vector<glm::uint32> kept;
+  if (count == 0) {
+    return kept;
+  }
+  kept.push_back(0);
+  if (tolerance < 0.0f) {
+    for (glm::uint32 i = 1; i < count; ++i) {
+      kept.push_back(i);
+    }
+    return kept;
+  }
+
+  // A track that never leaves its first value needs a single key.
+  bool constant = std::all_of(values.begin(), values.end(), [&](const T& v) {
+    return Distance(v, values.front()) <= tolerance;
+  });
+  if (constant) {
+    return kept;
+  }
+
+  glm::uint32 anchor = 0;
+  for (glm::uint32 candidate = 2; candidate < count; ++candidate) {
+    for (glm::uint32 skipped = anchor + 1; skipped < candidate; ++skipped) {
+      auto factor =
+          GetFactor(times[anchor], times[candidate], times[skipped]);
+      auto error =
+          Distance(Interpolate(values[anchor], values[candidate], factor),
+                   values[skipped]);
+      if (error > tolerance) {
+        anchor = candidate - 1;
+        kept.push_back(anchor);
+        break;
+      }
+    }
+  }
+  kept.push_back(count - 1);
+  return kept;
+}
+
+/**
+ * Measures the largest difference between a compressed track and its source
+ * keys.
+ */
+template <typename Track, typename T>
+glm::float32 MeasureError(const Track& track,
+                          const std::vector<glm::float64>& times,
+                          const std::vector<T>& values) {
+  if (track.times.empty()) {
+    return 0.0f;
+  }
+  glm::float32 error = 0.0f;
+  glm::uint32 cursor = 0;
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    error = glm::max(
+        error,
+        Distance(KeyframeCompression::Sample(track, times[i], cursor),
+                 values[i]));
+  }
+  return error;
+}
+}  // namespace
+
+void KeyframeCompression::Report::Merge(const Report& other) {
+  source_keys += other.source_keys;
+  stored_keys += other.stored_keys;
+  source_bytes += other.source_bytes;
+  compressed_bytes += other.compressed_bytes;
+  max_position_error = glm::max(max_position_error, other.max_position_error);
+  max_rotation_error = glm::max(max_rotation_error, other.max_rotation_error);
+  max_scale_error = glm::max(max_scale_error, other.max_scale_error);
+}
+
+glm::float32 KeyframeCompression::Report::GetRatio() const {
+  if (compressed_bytes == 0) {
+    return 1.0f;
+  }
+  return static_cast<glm::float32>(source_bytes) /
+         static_cast<glm::float32>(compressed_bytes);
+}
+
+glm::vec3 KeyframeCompression::VectorTrack::Decode(glm::uint32 index) const {
+  return minimum + glm::vec3(values[index]) / kVectorMax * extent;
+}
+
+glm::quat KeyframeCompression::RotationTrack::Decode(glm::uint32 index) const {
+  return UnpackRotation(values[index]);
+}
+
+KeyframeCompression::VectorTrack KeyframeCompression::CompressVectors(
+    const std::vector<glm::float64>& times,
+    const std::vector<glm::vec3>& values, glm::float32 tolerance,
+    Report* report, glm::float32* max_error) {
+  VectorTrack track;
+  auto kept = ReduceKeys(times, values, tolerance);
+  if (!kept.empty()) {
+    glm::vec3 maximum = values[kept.front()];
+    track.minimum = maximum;
+    for (auto index : kept) {
+      track.minimum = glm::min(track.minimum, values[index]);
+      maximum = glm::max(maximum, values[index]);
+    }
+    track.extent = maximum - track.minimum;
+  }
+
+  track.times.reserve(kept.size());
+  track.values.reserve(kept.size());
+  for (auto index : kept) {
+    glm::vec3 normalized(0.0f);
+    for (int axis = 0; axis < 3; ++axis) {
+      // A flat axis decodes to its minimum whatever is stored.
+      if (track.extent[axis] > 0.0f) {
+        normalized[axis] =
+            (values[index][axis] - track.minimum[axis]) / track.extent[axis];
+      }
+    }
+    track.times.push_back(static_cast<glm::float32>(times[index]));
+    track.values.emplace_back(
+        glm::round(glm::clamp(normalized, 0.0f, 1.0f) * kVectorMax));
+  }
+
+  if (report != nullptr) {
+    report->source_keys += static_cast<glm::uint32>(values.size());
+    report->stored_keys += static_cast<glm::uint32>(track.times.size());
+    report->source_bytes +=
+        values.size() * (sizeof(glm::vec3) + sizeof(glm::float64));
+    report->compressed_bytes += GetByteSize(track);
+  }
+  if (max_error != nullptr) {
+    *max_error = MeasureError(track, times, values);
+  }
+  return track;
+}
+
+KeyframeCompression::RotationTrack KeyframeCompression::CompressRotations(
+    const std::vector<glm::float64>& times,
+    const std::vector<glm::quat>& values, glm::float32 tolerance,
+    Report* report, glm::float32* max_error) {
+  RotationTrack track;
+  auto kept = ReduceKeys(times, values, tolerance);
+  track.times.reserve(kept.size());
+  track.values.reserve(kept.size());
+  for (auto index : kept) {
+    track.times.push_back(static_cast<glm::float32>(times[index]));
+    track.values.push_back(PackRotation(values[index]));
+  }
+
+  if (report != nullptr) {
+    report->source_keys += static_cast<glm::uint32>(values.size());
+    report->stored_keys += static_cast<glm::uint32>(track.times.size());
+    report->source_bytes +=
+        values.size() * (sizeof(glm::quat) + sizeof(glm::float64));
+    report->compressed_bytes += GetByteSize(track);
+  }
+  if (max_error != nullptr) {
+    *max_error = MeasureError(track, times, values);
+  }
+  return track;
+}
+
+glm::vec3 KeyframeCompression::Sample(const VectorTrack& track,
+                                      glm::float64 time, glm::uint32& cursor) {
+  if (track.times.size() == 1) {
+    return track.Decode(0);
+  }
+  auto index = FindKey(track.times, time, cursor);
+  auto factor = GetFactor(track.times[index], track.times[index + 1], time);
+  return glm::mix(track.Decode(index), track.Decode(index + 1), factor);
+}
+
+glm::quat KeyframeCompression::Sample(const RotationTrack& track,
+                                      glm::float64 time, glm::uint32& cursor) {
+  if (track.times.size() == 1) {
+    return track.Decode(0);
+  }
+  auto index = FindKey(track.times, time, cursor);
+  auto factor = GetFactor(track.times[index], track.times[index + 1], time);
+  return glm::slerp(track.Decode(index), track.Decode(index + 1), factor);
+}
+
+glm::uint32 KeyframeCompression::FindKey(
+    const std::vector<glm::float32>& times, glm::float64 time,
+    glm::uint32& cursor) {
+  if (times.size() < 2 || time <= times.front()) {
+    cursor = 0;
+    return cursor;
+  }
+  auto last = static_cast<glm::uint32>(times.size()) - 2;
+  if (time >= times.back()) {
+    cursor = last;
+    return cursor;
+  }
+
+  cursor = std::min(cursor, last);
+  // Playback moves forward, so the answer is nearly always here or next.
+  for (glm::uint32 step = 0; step < 2 && cursor + step <= last; ++step) {
+    glm::uint32 index = cursor + step;
+    if (times[index] <= time && time < times[index + 1]) {
+      cursor = index;
+      return cursor;
+    }
+  }
+
+  auto next = std::upper_bound(
+      times.begin() + 1, times.end(), time,
+      [](glm::float64 value, glm::float32 key) { return value < key; });
+  cursor = static_cast<glm::uint32>(next - times.begin()) - 1;
+  return cursor;
+}
+
+glm::u16vec3 KeyframeCompression::PackRotation(const glm::quat& rotation) {
+  glm::quat q = glm::normalize(rotation);
+  int largest = 0;
+  for (int i = 1; i < 4; ++i) {
+    if (glm::abs(q[i]) > glm::abs(q[largest])) {
+      largest = i;
+    }
+  }
+  // q and -q are the same rotation, so the dropped component can always be
+  // made positive.
+  glm::float32 sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+  glm::uint64 bits = static_cast<glm::uint64>(largest);
+  for (int i = 0; i < 4; ++i) {
+    if (i == largest) {
+      continue;
+    }
+    glm::float32 normalized = (sign * q[i] / kSqrtHalf) * 0.5f + 0.5f;
+    auto value = static_cast<glm::uint64>(
+        glm::round(glm::clamp(normalized, 0.0f, 1.0f) * kRotationMax));
+    bits = bits << kRotationBits | value;
+  }
+  return glm::u16vec3(bits & 0xffff, (bits >> 16) & 0xffff,
+                      (bits >> 32) & 0xffff);
+}
+
+glm::quat KeyframeCompression::UnpackRotation(const glm::u16vec3& packed) {
+  glm::uint64 bits = static_cast<glm::uint64>(packed.x) |
+                     static_cast<glm::uint64>(packed.y) << 16 |
+                     static_cast<glm::uint64>(packed.z) << 32;
+  auto largest = static_cast<int>((bits >> (3 * kRotationBits)) & 0x3);
+
+  glm::quat q;
+  glm::float32 sum = 0.0f;
+  // The components were packed first to last, so they unpack last to first.
+  for (int i = 3; i >= 0; --i) {
+    if (i == largest) {
+      continue;
+    }
+    auto value = static_cast<glm::float32>(bits & ((1u << kRotationBits) - 1));
+    bits >>= kRotationBits;
+    q[i] = (value / kRotationMax * 2.0f - 1.0f) * kSqrtHalf;
+    sum += q[i] * q[i];
+  }
+  q[largest] = glm::sqrt(glm::max(0.0f, 1.0f - sum));
+  return q;
+}
+
+std::size_t KeyframeCompression::GetByteSize(const VectorTrack& track) {
+  return track.times.size() * sizeof(glm::float32) +
+         track.values.size() * sizeof(glm::u16vec3) + 2 * sizeof(glm::vec3);
+}
+
+std::size_t KeyframeCompression::GetByteSize(const RotationTrack& track) {
+  return track.times.size() * sizeof(glm::float32) +
+         track.values.size() * sizeof(glm::u16vec3);
+}
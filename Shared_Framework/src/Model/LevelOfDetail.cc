@@ -0,0 +1,48 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/LevelOfDetail.h"
+#include <algorithm>
+
+using namespace model;
+
+glm::uint32 LodSettings::SelectLevel(glm::uint32 current_level,
+                                     glm::uint32 level_count,
+                                     glm::float32 screen_diameter) const {
+  if (level_count <= 1) {
+    return 0;
+  }
+  glm::uint32 last_level = level_count - 1;
+  glm::uint32 level = std::min(current_level, last_level);
+
+  // Threshold below which a level hands over to the next, coarser one.
+  auto threshold = [this](glm::uint32 level_index) {
+    return full_detail_pixels / static_cast<glm::float32>(1u << level_index);
+  };
+
+  // Move to coarser levels only once the size is clearly below the threshold.
+  while (level < last_level &&
+         screen_diameter < threshold(level) * (1.0f - hysteresis)) {
+    ++level;
+  }
+  // Move back to finer levels only once the size is clearly above it.
+  while (level > 0 &&
+         screen_diameter > threshold(level - 1) * (1.0f + hysteresis)) {
+    --level;
+  }
+
+  return std::max(level, std::min(min_level, last_level));
+}
@@ -0,0 +1,155 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/LocalPose.h"
+#include "Model/Bone.h"
+
+#if defined(__SSE__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define LOCAL_POSE_USE_SSE 1
+#endif
+
+using namespace model;
+
+namespace {
+glm::float32 GetNodeWeight(glm::float32 weight,
+                           const std::vector<glm::float32>& mask,
+                           std::size_t node) {
+  return mask.empty() ? weight : weight * mask[node];
+}
+
+#ifdef LOCAL_POSE_USE_SSE
+// The dot product of two four lane vectors, in every lane.
+__m128 Dot4(__m128 a, __m128 b) {
+  __m128 product = _mm_mul_ps(a, b);
+  __m128 sums = _mm_add_ps(
+      product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_add_ps(sums,
+                    _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+
+__m128 Lerp(__m128 a, __m128 b, __m128 weight) {
+  return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), weight));
+}
+#endif
+}  // namespace
+
+void LocalPose::Resize(std::size_t count) {
+  translations.resize(count, glm::vec4(0.0f));
+  rotations.resize(count, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+  scales.resize(count, glm::vec4(1.0f, 1.0f, 1.0f, 0.0f));
+}
+
+std::size_t LocalPose::GetSize() const {
+  return rotations.size();
+}
+
+void LocalPose::SetMatrix(std::size_t node, const glm::mat4& matrix) {
+  glm::vec3 scale(glm::length(glm::vec3(matrix[0])),
+                  glm::length(glm::vec3(matrix[1])),
+                  glm::length(glm::vec3(matrix[2])));
+  glm::mat3 rotation(matrix);
+  for (int axis = 0; axis < 3; ++axis) {
+    if (scale[axis] > 0.0f) {
+      rotation[axis] /= scale[axis];
+    }
+  }
+  translations[node] = glm::vec4(glm::vec3(matrix[3]), 0.0f);
+  rotations[node] = glm::normalize(glm::quat_cast(rotation));
+  scales[node] = glm::vec4(scale, 0.0f);
+}
+
+glm::mat4 LocalPose::GetMatrix(std::size_t node) const {
+  return Bone::Compose(glm::vec3(translations[node]), rotations[node],
+                       glm::vec3(scales[node]));
+}
+
+void LocalPose::Blend(const LocalPose& from, const LocalPose& to,
+                      glm::float32 weight,
+                      const std::vector<glm::float32>& mask,
+                      LocalPose& result) {
+  std::size_t count = from.GetSize();
+  result.Resize(count);
+#ifdef LOCAL_POSE_USE_SSE
+  const __m128 sign_bits = _mm_set1_ps(-0.0f);
+  for (std::size_t i = 0; i < count; ++i) {
+    __m128 w = _mm_set1_ps(GetNodeWeight(weight, mask, i));
+    _mm_storeu_ps(&result.translations[i].x,
+                  Lerp(_mm_loadu_ps(&from.translations[i].x),
+                       _mm_loadu_ps(&to.translations[i].x), w));
+    _mm_storeu_ps(&result.scales[i].x,
+                  Lerp(_mm_loadu_ps(&from.scales[i].x),
+                       _mm_loadu_ps(&to.scales[i].x), w));
+
+    // q and -q are the same rotation, flip b onto the shorter arc.
+    auto* rotation = reinterpret_cast<float*>(&result.rotations[i]);
+    __m128 a = _mm_loadu_ps(reinterpret_cast<const float*>(&from.rotations[i]));
+    __m128 b = _mm_loadu_ps(reinterpret_cast<const float*>(&to.rotations[i]));
+    __m128 flip = _mm_and_ps(_mm_cmplt_ps(Dot4(a, b), _mm_setzero_ps()),
+                             sign_bits);
+    __m128 q = Lerp(a, _mm_xor_ps(b, flip), w);
+    _mm_storeu_ps(rotation, _mm_div_ps(q, _mm_sqrt_ps(Dot4(q, q))));
+  }
+#else
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::float32 w = GetNodeWeight(weight, mask, i);
+    result.translations[i] =
+        glm::mix(from.translations[i], to.translations[i], w);
+    result.scales[i] = glm::mix(from.scales[i], to.scales[i], w);
+    glm::quat b = to.rotations[i];
+    if (glm::dot(from.rotations[i], b) < 0.0f) {
+      b = -b;
+    }
+    result.rotations[i] =
+        glm::normalize(from.rotations[i] * (1.0f - w) + b * w);
+  }
+#endif
+}
+
+void LocalPose::Add(const LocalPose& base, const LocalPose& additive,
+                    const LocalPose& reference, glm::float32 weight,
+                    const std::vector<glm::float32>& mask,
+                    LocalPose& result) {
+  std::size_t count = base.GetSize();
+  result.Resize(count);
+  const glm::quat identity(1.0f, 0.0f, 0.0f, 0.0f);
+  for (std::size_t i = 0; i < count; ++i) {
+    glm::float32 w = GetNodeWeight(weight, mask, i);
+    if (w == 0.0f) {
+      result.translations[i] = base.translations[i];
+      result.rotations[i] = base.rotations[i];
+      result.scales[i] = base.scales[i];
+      continue;
+    }
+    result.translations[i] =
+        base.translations[i] +
+        (additive.translations[i] - reference.translations[i]) * w;
+    glm::vec4 scale_ratio = additive.scales[i] /
+                            glm::max(reference.scales[i], glm::vec4(1e-6f));
+    result.scales[i] =
+        base.scales[i] * glm::mix(glm::vec4(1.0f), scale_ratio, w);
+
+    // additive = reference * delta, so delta is applied after the base.
+    glm::quat delta = glm::inverse(reference.rotations[i]) *
+                      additive.rotations[i];
+    if (delta.w < 0.0f) {
+      delta = -delta;
+    }
+    delta = glm::normalize(identity * (1.0f - w) + delta * w);
+    result.rotations[i] = glm::normalize(base.rotations[i] * delta);
+  }
+}
@@ -0,0 +1,110 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/Material.h"
+#include "LoggerSystem.h"
+#include "OpenGLStateManager.h"
+
+using namespace model;
+
+Material::Material(const std::vector<meshdata::Texture>& textures)
+    : textures_(textures) {
+  glm::uint32 counts[static_cast<int>(meshdata::TextureType::kCount)] = {};
+  for (const auto& texture : textures_) {
+    auto type = static_cast<glm::uint32>(texture.type);
+    if (counts[type] == kMaxTexturesPerType) {
+      LoggerSystem::GetInstance().Log(
+          LoggerSystem::Level::kWarning,
+          "Too many textures of one type in a material, the rest are "
+          "ignored: " +
+              texture.path);
+      continue;
+    }
+    glm::uint32 number = ++counts[type];
+    bindings_.push_back(
+        {texture.id,
+         static_cast<GLint>(type * kMaxTexturesPerType + number - 1),
+         GetSamplerName(texture.type, number)});
+  }
+}
+
+void Material::Bind(const Shader& shader) {
+  GLuint program = shader.GetID();
+  const ProgramSamplers* samplers = nullptr;
+  for (const auto& prepared : programs_) {
+    if (prepared.program == program) {
+      samplers = &prepared;
+      break;
+    }
+  }
+  if (samplers == nullptr) {
+    samplers = &PrepareProgram(program);
+  }
+
+  for (std::size_t i = 0; i < bindings_.size(); ++i) {
+    // Skip textures the shader never samples.
+    if (samplers->locations[i] < 0) {
+      continue;
+    }
+    glActiveTexture(GL_TEXTURE0 + bindings_[i].unit);
+    glBindTexture(GL_TEXTURE_2D, bindings_[i].texture_id);
+  }
+}
+
+const Material::ProgramSamplers& Material::PrepareProgram(GLuint program) {
+  ProgramSamplers samplers;
+  samplers.program = program;
+  samplers.locations.reserve(bindings_.size());
+  for (const auto& binding : bindings_) {
+    GLint location =
+        glGetUniformLocation(program, binding.sampler_name.c_str());
+    samplers.locations.push_back(location);
+    if (location >= 0) {
+      if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 1)) {
+        glProgramUniform1i(program, location, binding.unit);
+      } else {
+        glUniform1i(location, binding.unit);
+      }
+    }
+  }
+  programs_.push_back(std::move(samplers));
+  return programs_.back();
+}
+
+const std::vector<meshdata::Texture>& Material::GetTextures() const {
+  return textures_;
+}
+
+std::string Material::GetSamplerName(meshdata::TextureType type,
+                                     glm::uint32 number) {
+  /*
+   * we assume a convention for sampler names in the shaders. Each diffuse
+   * texture should be named as 'texture_diffuseN' where N is a sequential
+   * number ranging from 1 to kMaxTexturesPerType.
+   */
+  switch (type) {
+    case meshdata::TextureType::kDiffuse:
+      return "texture_diffuse" + std::to_string(number);
+    case meshdata::TextureType::kSpecular:
+      return "texture_specular" + std::to_string(number);
+    case meshdata::TextureType::kNormal:
+      return "texture_normal" + std::to_string(number);
+    case meshdata::TextureType::kHeight:
+      return "texture_height" + std::to_string(number);
+    default:
+      return "";
+  }
+}
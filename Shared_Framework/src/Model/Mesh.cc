@@ -15,48 +15,94 @@
  ******************************************************************************/
 
 #include "Model/Mesh.h"
+#include <algorithm>
 #include <utility>
-#include "LoggerSystem.h"
+#include "OpenGLStateManager.h"
 
 using namespace model;
 const std::vector<meshdata::Vertex>& Mesh::GetVertices() const {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
+  RestoreVertices();
   return vertices_;
 }
 void Mesh::SetVertices(const std::vector<meshdata::Vertex>& vertices) {
-  std::lock_guard<std::mutex> lock(mesh_mutex_);
-  vertices_ = vertices;
+  {
+    std::lock_guard<std::mutex> lock(mesh_mutex_);
+    // The element buffer is uploaded again, so it needs every level.
+    RestoreIndices();
+    vertices_ = vertices;
+    vertex_count_ = static_cast<glm::uint32>(vertices_.size());
+    positions_.clear();
+    cpu_data_policy_ = CpuDataPolicy::kKeepAll;
+    bounding_sphere_ = BoundingSphere::FromVertices(vertices_);
+    bounding_box_ = AxisAlignedBox::FromVertices(vertices_);
+    skinned_bounds_ = SkinnedBounds::FromVertices(vertices_);
+  }
   SetupMesh();
 }
 const std::vector<glm::uint32>& Mesh::GetIndices() const {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
+  RestoreIndices();
   return indices_;
 }
 void Mesh::SetIndices(const std::vector<glm::uint32>& indices) {
-  std::lock_guard<std::mutex> lock(mesh_mutex_);
-  indices_ = indices;
+  {
+    std::lock_guard<std::mutex> lock(mesh_mutex_);
+    RestoreVertices();
+    indices_ = indices;
+    cpu_data_policy_ = CpuDataPolicy::kKeepAll;
+    meshlets_.clear();
+    BuildLodLevels({}, {});
+  }
   SetupMesh();
 }
 const std::vector<meshdata::Texture>& Mesh::GetTextures() const {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
-  return textures_;
+  return material_.GetTextures();
 }
 void Mesh::SetTextures(const std::vector<meshdata::Texture>& textures) {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
-  textures_ = textures;
+  material_ = Material(textures);
 }
 Mesh::Mesh(const std::vector<meshdata::Vertex>& vertices,
            const std::vector<glm::uint32>& indices,
-           const std::vector<meshdata::Texture>& texture)
+           const std::vector<meshdata::Texture>& texture,
+           const std::vector<std::vector<glm::uint32>>& lod_indices,
+           const std::vector<glm::float32>& lod_errors)
     : vertices_(vertices),
       indices_(indices),
-      textures_(texture),
+      material_(texture),
+      vertex_count_(static_cast<glm::uint32>(vertices.size())),
+      buffer_index_count_(0),
+      cpu_data_policy_(CpuDataPolicy::kKeepAll),
+      bounding_sphere_(BoundingSphere::FromVertices(vertices)),
+      bounding_box_(AxisAlignedBox::FromVertices(vertices)),
+      skinned_bounds_(SkinnedBounds::FromVertices(vertices)),
       ebo_(1, GL_ELEMENT_ARRAY_BUFFER),
       vbo_(1) {
+  BuildLodLevels(lod_indices, lod_errors);
   // Now that we have all the required data, set the vertex buffers and its
   // attribute pointers.
   SetupMesh();
 }
+void Mesh::BuildLodLevels(
+    const std::vector<std::vector<glm::uint32>>& lod_indices,
+    const std::vector<glm::float32>& lod_errors) {
+  lod_indices_.clear();
+  lod_levels_.clear();
+  lod_levels_.push_back({0, static_cast<glm::uint32>(indices_.size()), 0.0f});
+  // Simplified levels follow the full detail indices in the element buffer.
+  auto offset = static_cast<glm::uint32>(indices_.size());
+  for (std::size_t i = 0; i < lod_indices.size(); ++i) {
+    auto count = static_cast<glm::uint32>(lod_indices[i].size());
+    glm::float32 error = i < lod_errors.size() ? lod_errors[i] : 0.0f;
+    lod_levels_.push_back({offset, count, error});
+    lod_indices_.insert(lod_indices_.end(), lod_indices[i].begin(),
+                        lod_indices[i].end());
+    offset += count;
+  }
+  buffer_index_count_ = offset;
+}
 void Mesh::SetupMesh() {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
   vao_.Bind();
@@ -67,7 +113,19 @@ void Mesh::SetupMesh() {
   vbo_.Bind();
   vbo_.SetData(vertices_, GL_STATIC_DRAW);
   ebo_.Bind();
-  ebo_.SetData(indices_, GL_STATIC_DRAW);
+  if (lod_indices_.empty()) {
+    ebo_.SetData(indices_, GL_STATIC_DRAW);
+  } else {
+    // All levels share one element buffer: full detail first, then each
+    // simplified level in order.
+    auto full_size =
+        static_cast<GLsizeiptr>(indices_.size() * sizeof(glm::uint32));
+    auto lod_size =
+        static_cast<GLsizeiptr>(lod_indices_.size() * sizeof(glm::uint32));
+    ebo_.SetData(nullptr, full_size + lod_size, GL_STATIC_DRAW);
+    ebo_.SetSubData(0, full_size, indices_.data());
+    ebo_.SetSubData(full_size, lod_size, lod_indices_.data());
+  }
 
   /**
    * Set the vertex attribute pointers
@@ -100,63 +158,326 @@ void Mesh::SetupMesh() {
 }
 
 void Mesh::Draw(Shader& shader) {
+  Draw(shader, 0);
+}
+
+void Mesh::Draw(Shader& shader, glm::uint32 lod_level) {
   std::lock_guard<std::mutex> lock(mesh_mutex_);
-  GLuint diffuser_nr = 1, specular_nr = 1, normal_nr = 1, height_nr = 1;
   shader.Use();
-  for (GLuint i = 0; i < this->textures_.size(); i++) {
-    glActiveTexture(GL_TEXTURE0 +
-                    i);  // Active proper texture unit before binding
-    // Retrieve texture number (the N in diffuse_textureN)
-    std::string number;
-    std::string name = this->textures_[i].type;
-    if (name == "texture_diffuse")
-      number = std::to_string(diffuser_nr++);
-    else if (name == "texture_specular")
-      number =
-          std::to_string(specular_nr++);  // transfer unsigned int to string
-    else if (name == "texture_normal")
-      number = std::to_string(normal_nr++);  // transfer unsigned int to
-                                             // string
-    else if (name == "texture_height")
-      number = std::to_string(height_nr++);  // transfer unsigned int to
-                                             // string
-    else {
-      LoggerSystem::GetInstance().Log(
-          LoggerSystem::Level::kWarning,
-          "Looking for uniform texture error, no texture appears!");
+  material_.Bind(shader);
+  BindMorphTargets(shader);
+
+  // Draw mesh
+  const LodLevel& level =
+      lod_levels_[std::min<std::size_t>(lod_level, lod_levels_.size() - 1)];
+  this->vao_.Bind();
+  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(level.index_count),
+                 GL_UNSIGNED_INT,
+                 (void*)(level.index_offset * sizeof(glm::uint32)));
+  this->vao_.UnBind();
+
+  // Always good practice to set everything back to defaults once configured.
+  glActiveTexture(GL_TEXTURE0);
+  shader.UnUse();
+}
+
+void Mesh::DrawInstanced(Shader& shader, const InstanceBuffer& instance_buffer,
+                         GLsizei count, glm::uint32 lod_level) {
+  if (count <= 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  shader.Use();
+  material_.Bind(shader);
+  BindMorphTargets(shader);
+
+  const LodLevel& level =
+      lod_levels_[std::min<std::size_t>(lod_level, lod_levels_.size() - 1)];
+  this->vao_.Bind();
+  instance_buffer.AttachTo(vao_);
+  glDrawElementsInstanced(GL_TRIANGLES,
+                          static_cast<GLsizei>(level.index_count),
+                          GL_UNSIGNED_INT,
+                          (void*)(level.index_offset * sizeof(glm::uint32)),
+                          count);
+  this->vao_.UnBind();
+
+  glActiveTexture(GL_TEXTURE0);
+  shader.UnUse();
+}
+
+void Mesh::DrawElements(glm::uint32 lod_level) const {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  const LodLevel& level =
+      lod_levels_[std::min<std::size_t>(lod_level, lod_levels_.size() - 1)];
+  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(level.index_count),
+                 GL_UNSIGNED_INT,
+                 (void*)(level.index_offset * sizeof(glm::uint32)));
+}
+
+glm::uint32 Mesh::DrawMeshlets(Shader& shader, const Frustum& frustum,
+                               const glm::vec3& camera_position,
+                               glm::uint32* index_count) {
+  // Meshlet bounds and cones hold the base shape, not the morphed one.
+  if (GetMeshlets().empty() || GetMorphTargets() != nullptr) {
+    Draw(shader, 0);
+    if (index_count != nullptr) {
+      *index_count = GetIndexCount();
+    }
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  draw_commands_.clear();
+  glm::uint32 drawn = 0;
+  glm::uint32 drawn_indices = 0;
+  for (const auto& meshlet : meshlets_) {
+    if (!frustum.IntersectsSphere(meshlet.center, meshlet.radius) ||
+        meshlet.IsBackFacing(camera_position)) {
       continue;
     }
-    // Now set the sampler to the correct texture unit
-    shader.SetInt(name + number, static_cast<int>(i));
-    // And finally bind the texture
-    glBindTexture(GL_TEXTURE_2D, textures_[i].id);
+    ++drawn;
+    drawn_indices += meshlet.index_count;
+    // Merge with the previous command when the ranges are adjacent.
+    if (!draw_commands_.empty() &&
+        draw_commands_.back().first_index + draw_commands_.back().count ==
+            meshlet.index_offset) {
+      draw_commands_.back().count += meshlet.index_count;
+    } else {
+      draw_commands_.push_back(
+          {meshlet.index_count, 1, meshlet.index_offset, 0, 0});
+    }
+  }
+  if (index_count != nullptr) {
+    *index_count = drawn_indices;
+  }
+  if (draw_commands_.empty()) {
+    return 0;
   }
 
-  // Draw mesh
+  shader.Use();
+  material_.Bind(shader);
+  BindMorphTargets(shader);
   this->vao_.Bind();
-  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()),
-                 GL_UNSIGNED_INT, nullptr);
+  if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 3)) {
+    if (!indirect_buffer_) {
+      indirect_buffer_ =
+          std::make_unique<Buffers>(1, GL_DRAW_INDIRECT_BUFFER);
+    }
+    indirect_buffer_->Bind();
+    indirect_buffer_->SetData(draw_commands_, GL_STREAM_DRAW);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                                static_cast<GLsizei>(draw_commands_.size()),
+                                0);
+    indirect_buffer_->UnBind();
+  } else {
+    for (const auto& command : draw_commands_) {
+      glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(command.count),
+                     GL_UNSIGNED_INT,
+                     (void*)(command.first_index * sizeof(glm::uint32)));
+    }
+  }
   this->vao_.UnBind();
 
-  // Always good practice to set everything back to defaults once configured.
   glActiveTexture(GL_TEXTURE0);
   shader.UnUse();
+  return drawn;
+}
+
+const std::vector<glm::vec3>& Mesh::GetPositions() const {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  ExtractPositions();
+  return positions_;
+}
+
+glm::uint32 Mesh::GetVertexCount() const {
+  return vertex_count_;
+}
+
+glm::uint32 Mesh::GetIndexCount() const {
+  return lod_levels_.front().index_count;
+}
+
+void Mesh::SetCpuDataPolicy(CpuDataPolicy policy) {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  switch (policy) {
+    case CpuDataPolicy::kKeepAll:
+      RestoreVertices();
+      RestoreIndices();
+      break;
+    case CpuDataPolicy::kKeepPositions:
+      RestoreIndices();
+      ExtractPositions();
+      std::vector<meshdata::Vertex>().swap(vertices_);
+      // Only needed to upload the element buffer again.
+      std::vector<glm::uint32>().swap(lod_indices_);
+      break;
+    case CpuDataPolicy::kRelease:
+      // Swapping with empty vectors frees the memory, clear() would keep it.
+      std::vector<meshdata::Vertex>().swap(vertices_);
+      std::vector<glm::uint32>().swap(indices_);
+      std::vector<glm::uint32>().swap(lod_indices_);
+      std::vector<glm::vec3>().swap(positions_);
+      break;
+  }
+  cpu_data_policy_ = policy;
+}
+
+Mesh::CpuDataPolicy Mesh::GetCpuDataPolicy() const {
+  return cpu_data_policy_;
+}
+
+Mesh::MemoryUsage Mesh::GetMemoryUsage() const {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  MemoryUsage usage;
+  usage.cpu_bytes = vertices_.capacity() * sizeof(meshdata::Vertex) +
+                    (indices_.capacity() + lod_indices_.capacity()) *
+                        sizeof(glm::uint32) +
+                    positions_.capacity() * sizeof(glm::vec3);
+  usage.gpu_bytes =
+      static_cast<glm::uint64>(vertex_count_) * sizeof(meshdata::Vertex) +
+      static_cast<glm::uint64>(buffer_index_count_) * sizeof(glm::uint32);
+  if (morph_targets_ != nullptr) {
+    usage.gpu_bytes += morph_targets_->GetByteSize();
+  }
+  return usage;
+}
+
+void Mesh::RestoreVertices() const {
+  if (vertices_.size() == vertex_count_) {
+    return;
+  }
+  vertices_.resize(vertex_count_);
+  vbo_.Bind();
+  vbo_.GetSubData(
+      0, static_cast<GLsizeiptr>(vertex_count_ * sizeof(meshdata::Vertex)),
+      vertices_.data());
+  vbo_.UnBind();
+}
+
+void Mesh::RestoreIndices() const {
+  if (indices_.size() + lod_indices_.size() == buffer_index_count_) {
+    return;
+  }
+  std::vector<glm::uint32> buffer_indices(buffer_index_count_);
+  // The element buffer binding belongs to the vertex array, so read through
+  // it instead of rebinding the element buffer of another vertex array.
+  vao_.Bind();
+  ebo_.GetSubData(
+      0, static_cast<GLsizeiptr>(buffer_index_count_ * sizeof(glm::uint32)),
+      buffer_indices.data());
+  vao_.UnBind();
+  auto full_count =
+      static_cast<std::ptrdiff_t>(lod_levels_.front().index_count);
+  indices_.assign(buffer_indices.begin(), buffer_indices.begin() + full_count);
+  lod_indices_.assign(buffer_indices.begin() + full_count,
+                      buffer_indices.end());
+}
+
+void Mesh::ExtractPositions() const {
+  if (positions_.size() == vertex_count_) {
+    return;
+  }
+  RestoreVertices();
+  positions_.resize(vertices_.size());
+  for (std::size_t i = 0; i < vertices_.size(); ++i) {
+    positions_[i] = vertices_[i].position;
+  }
+}
+
+void Mesh::BindMorphTargets(Shader& shader) const {
+  if (morph_targets_ != nullptr) {
+    morph_targets_->Bind(shader);
+  } else {
+    MorphTargets::Unbind(shader);
+  }
 }
 
 const VertexArray& Mesh::GetVao() const {
   return vao_;
 }
 
+GLuint Mesh::GetVertexBufferId() const {
+  return vbo_.GetBufferId();
+}
+
+GLuint Mesh::GetIndexBufferId() const {
+  return ebo_.GetBufferId();
+}
+
+Material& Mesh::GetMaterial() {
+  return material_;
+}
+
+glm::uint32 Mesh::SelectLod(glm::float32 screen_diameter,
+                            const LodSettings& settings,
+                            glm::uint32 current_level) const {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  return settings.SelectLevel(current_level,
+                              static_cast<glm::uint32>(lod_levels_.size()),
+                              screen_diameter);
+}
+
+const std::vector<LodLevel>& Mesh::GetLodLevels() const {
+  return lod_levels_;
+}
+
+const BoundingSphere& Mesh::GetBoundingSphere() const {
+  return bounding_sphere_;
+}
+
+const AxisAlignedBox& Mesh::GetBoundingBox() const {
+  return bounding_box_;
+}
+
+const SkinnedBounds& Mesh::GetSkinnedBounds() const {
+  return skinned_bounds_;
+}
+
+const std::vector<Meshlet>& Mesh::GetMeshlets() const {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  return meshlets_;
+}
+
+void Mesh::SetMeshlets(const std::vector<Meshlet>& meshlets) {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  meshlets_ = meshlets;
+}
+
+const MorphTargets* Mesh::GetMorphTargets() const {
+  return morph_targets_.get();
+}
+
+void Mesh::SetMorphTargets(std::unique_ptr<MorphTargets> morph_targets) {
+  std::lock_guard<std::mutex> lock(mesh_mutex_);
+  morph_targets_ = std::move(morph_targets);
+}
+
 Mesh::Mesh(Mesh&& other) noexcept
     : vertices_(std::move(other.vertices_)),
       indices_(std::move(other.indices_)),
-      textures_(std::move(other.textures_)),
+      positions_(std::move(other.positions_)),
+      material_(std::move(other.material_)),
+      lod_indices_(std::move(other.lod_indices_)),
+      vertex_count_(other.vertex_count_),
+      buffer_index_count_(other.buffer_index_count_),
+      cpu_data_policy_(other.cpu_data_policy_),
+      lod_levels_(std::move(other.lod_levels_)),
+      bounding_sphere_(other.bounding_sphere_),
+      bounding_box_(other.bounding_box_),
+      skinned_bounds_(std::move(other.skinned_bounds_)),
+      meshlets_(std::move(other.meshlets_)),
+      morph_targets_(std::move(other.morph_targets_)),
       vao_(),
       vbo_(other.vbo_),
-      ebo_(other.ebo_) {
+      ebo_(other.ebo_),
+      indirect_buffer_(std::move(other.indirect_buffer_)) {
   other.vertices_.clear();
-  other.textures_.clear();
+  other.material_ = Material();
   other.indices_.clear();
+  other.positions_.clear();
+  other.vertex_count_ = 0;
+  other.buffer_index_count_ = 0;
   other.vao_.ResetVertexArrays();
   other.vbo_.ResetBuffers(other.vbo_.GetN(), other.vbo_.GetType());
   other.ebo_.ResetBuffers(other.ebo_.GetN(), other.ebo_.GetType());
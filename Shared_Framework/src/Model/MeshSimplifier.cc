@@ -0,0 +1,358 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/MeshSimplifier.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+
+using namespace model;
+
+namespace {
+/**
+ * Symmetric 4x4 error quadric. Evaluating it at a point returns the sum of 
+ * squared distances from the point to all planes accumulated into it.
+ */
+struct Quadric {
+  glm::float64 a00 = 0.0, a01 = 0.0, a02 = 0.0, a03 = 0.0;
+  glm::float64 a11 = 0.0, a12 = 0.0, a13 = 0.0;
+  glm::float64 a22 = 0.0, a23 = 0.0;
+  glm::float64 a33 = 0.0;
+
+  void AddPlane(const glm::dvec3& normal, glm::float64 distance) {
+    a00 += normal.x * normal.x;
+    a01 += normal.x * normal.y;
+    a02 += normal.x * normal.z;
+    a03 += normal.x * distance;
+    a11 += normal.y * normal.y;
+    a12 += normal.y * normal.z;
+    a13 += normal.y * distance;
+    a22 += normal.z * normal.z;
+    a23 += normal.z * distance;
+    a33 += distance * distance;
+  }
+
+  void Add(const Quadric& other) {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a03 += other.a03;
+    a11 += other.a11;
+    a12 += other.a12;
+    a13 += other.a13;
+    a22 += other.a22;
+    a23 += other.a23;
+    a33 += other.a33;
+  }
+
+  glm::float64 Evaluate(const glm::dvec3& p) const {
+    return a00 * p.x * p.x + 2.0 * a01 * p.x * p.y + 2.0 * a02 * p.x * p.z +
+           2.0 * a03 * p.x + a11 * p.y * p.y + 2.0 * a12 * p.y * p.z +
+           2.0 * a13 * p.y + a22 * p.z * p.z + 2.0 * a23 * p.z + a33;
+  }
+};
+
+// Moves vertex `from` onto vertex `to`.
+struct Collapse {
+  glm::uint32 from;
+  glm::uint32 to;
+  glm::float64 cost;
+};
+
+// Smallest cosine between a face normal before and after a collapse.
+constexpr glm::float64 kMinNormalCosine = 0.2;
+
+glm::uint64 EdgeKey(glm::uint32 a, glm::uint32 b) {
+  return a < b ? (static_cast<glm::uint64>(a) << 32) | b
+               : (static_cast<glm::uint64>(b) << 32) | a;
+}
+
+/**
+ * Marks every vertex that must stay in place: vertices on open or 
+ * non-manifold edges, and vertices that share their position with another 
+ * vertex (attribute seams).
+ */
+std::vector<bool> FindLockedVertices(
+    const std::vector<meshdata::Vertex>& vertices,
+    const std::vector<glm::uint32>& indices) {
+  std::vector<bool> locked(vertices.size(), false);
+
+  std::vector<glm::uint32> order(vertices.size());
+  std::iota(order.begin(), order.end(), 0u);
+  auto less = [&vertices](glm::uint32 a, glm::uint32 b) {
+    const glm::vec3& pa = vertices[a].position;
+    const glm::vec3& pb = vertices[b].position;
+    if (pa.x != pb.x)
+      return pa.x < pb.x;
+    if (pa.y != pb.y)
+      return pa.y < pb.y;
+    return pa.z < pb.z;
+  };
+  std::sort(order.begin(), order.end(), less);
+  for (std::size_t i = 1; i < order.size(); ++i) {
+    if (vertices[order[i]].position == vertices[order[i - 1]].position) {
+      locked[order[i]] = true;
+      locked[order[i - 1]] = true;
+    }
+  }
+
+  std::unordered_map<glm::uint64, glm::uint32> edge_use;
+  edge_use.reserve(indices.size());
+  for (std::size_t i = 0; i < indices.size(); i += 3) {
+    for (int e = 0; e < 3; ++e) {
+      ++edge_use[EdgeKey(indices[i + e], indices[i + (e + 1) % 3])];
+    }
+  }
+  for (const auto& edge : edge_use) {
+    if (edge.second != 2) {
+      locked[static_cast<glm::uint32>(edge.first >> 32)] = true;
+      locked[static_cast<glm::uint32>(edge.first & 0xffffffffu)] = true;
+    }
+  }
+  return locked;
+}
+
+glm::dvec3 FaceNormal(const glm::dvec3& a, const glm::dvec3& b,
+                      const glm::dvec3& c) {
+  return glm::cross(b - a, c - a);
+}
+}  // namespace
+
+std::vector<glm::uint32> MeshSimplifier::Simplify(
+    const std::vector<meshdata::Vertex>& vertices,
+    const std::vector<glm::uint32>& indices, std::size_t target_index_count,
+    glm::float32 target_error, glm::float32* result_error) {
+  if (result_error) {
+    *result_error = 0.0f;
+  }
+  if (indices.size() <= target_index_count || vertices.empty()) {
+    return indices;
+  }
+
+  glm::vec3 min_position = vertices[0].position;
+  glm::vec3 max_position = vertices[0].position;
+  for (const auto& vertex : vertices) {
+    min_position = glm::min(min_position, vertex.position);
+    max_position = glm::max(max_position, vertex.position);
+  }
+  glm::vec3 size = max_position - min_position;
+  glm::float64 extent = std::max({size.x, size.y, size.z});
+  if (extent <= 0.0) {
+    return indices;
+  }
+
+  const std::size_t vertex_count = vertices.size();
+  auto position = [&vertices](glm::uint32 index) {
+    return glm::dvec3(vertices[index].position);
+  };
+
+  std::vector<bool> locked = FindLockedVertices(vertices, indices);
+
+  std::vector<Quadric> quadrics(vertex_count);
+  for (std::size_t i = 0; i < indices.size(); i += 3) {
+    glm::dvec3 a = position(indices[i]);
+    glm::dvec3 normal =
+        FaceNormal(a, position(indices[i + 1]), position(indices[i + 2]));
+    glm::float64 length = glm::length(normal);
+    if (length <= 0.0) {
+      continue;
+    }
+    normal /= length;
+    glm::float64 distance = -glm::dot(normal, a);
+    for (int corner = 0; corner < 3; ++corner) {
+      quadrics[indices[i + corner]].AddPlane(normal, distance);
+    }
+  }
+
+  const glm::float64 max_cost =
+      (static_cast<glm::float64>(target_error) * extent) *
+      (static_cast<glm::float64>(target_error) * extent);
+  glm::float64 applied_cost = 0.0;
+
+  std::vector<glm::uint32> result = indices;
+  std::vector<glm::uint32> remap(vertex_count);
+  std::vector<glm::uint32> adjacency_offsets(vertex_count + 1);
+  std::vector<glm::uint32> adjacency;
+  std::vector<bool> dirty(vertex_count);
+  std::vector<Collapse> candidates;
+
+  while (result.size() > target_index_count) {
+    // Triangles around every vertex, stored contiguously.
+    std::fill(adjacency_offsets.begin(), adjacency_offsets.end(), 0u);
+    for (auto index : result) {
+      ++adjacency_offsets[index + 1];
+    }
+    std::partial_sum(adjacency_offsets.begin(), adjacency_offsets.end(),
+                     adjacency_offsets.begin());
+    adjacency.resize(result.size());
+    {
+      std::vector<glm::uint32> cursor(adjacency_offsets.begin(),
+                                      adjacency_offsets.end() - 1);
+      for (std::size_t i = 0; i < result.size(); ++i) {
+        adjacency[cursor[result[i]]++] = static_cast<glm::uint32>(i / 3);
+      }
+    }
+
+    candidates.clear();
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      for (int e = 0; e < 3; ++e) {
+        glm::uint32 a = result[i + e];
+        glm::uint32 b = result[i + (e + 1) % 3];
+        auto cost = [&](glm::uint32 from, glm::uint32 to) {
+          Quadric quadric = quadrics[from];
+          quadric.Add(quadrics[to]);
+          return std::max(0.0, quadric.Evaluate(position(to)));
+        };
+        if (!locked[a]) {
+          candidates.push_back({a, b, cost(a, b)});
+        }
+        if (!locked[b]) {
+          candidates.push_back({b, a, cost(b, a)});
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Collapse& lhs, const Collapse& rhs) {
+                return lhs.cost < rhs.cost;
+              });
+
+    std::iota(remap.begin(), remap.end(), 0u);
+    std::fill(dirty.begin(), dirty.end(), false);
+    const std::size_t triangles_to_remove =
+        (result.size() - target_index_count + 2) / 3;
+    std::size_t triangles_removed = 0;
+    std::size_t collapses = 0;
+
+    for (const auto& candidate : candidates) {
+      if (candidate.cost > max_cost ||
+          triangles_removed >= triangles_to_remove) {
+        break;
+      }
+      if (dirty[candidate.from] || dirty[candidate.to]) {
+        continue;
+      }
+
+      // Reject collapses that flip or degenerate any surviving triangle.
+      bool valid = true;
+      std::size_t removes = 0;
+      for (auto k = adjacency_offsets[candidate.from];
+           k < adjacency_offsets[candidate.from + 1] && valid; ++k) {
+        const glm::uint32* triangle = &result[adjacency[k] * 3];
+        if (triangle[0] == candidate.to || triangle[1] == candidate.to ||
+            triangle[2] == candidate.to) {
+          ++removes;
+          continue;
+        }
+        glm::dvec3 corners[3], moved[3];
+        for (int corner = 0; corner < 3; ++corner) {
+          corners[corner] = position(triangle[corner]);
+          moved[corner] = triangle[corner] == candidate.from
+                              ? position(candidate.to)
+                              : corners[corner];
+        }
+        glm::dvec3 before = FaceNormal(corners[0], corners[1], corners[2]);
+        glm::dvec3 after = FaceNormal(moved[0], moved[1], moved[2]);
+        glm::float64 lengths = glm::length(before) * glm::length(after);
+        valid = lengths > 0.0 &&
+                glm::dot(before, after) >= kMinNormalCosine * lengths;
+      }
+      if (!valid) {
+        continue;
+      }
+
+      remap[candidate.from] = candidate.to;
+      quadrics[candidate.to].Add(quadrics[candidate.from]);
+      applied_cost = std::max(applied_cost, candidate.cost);
+      triangles_removed += removes;
+      ++collapses;
+
+      // Triangles around the collapsed vertex changed, so everything touching
+      // them waits for the next pass.
+      dirty[candidate.from] = true;
+      dirty[candidate.to] = true;
+      for (auto k = adjacency_offsets[candidate.from];
+           k < adjacency_offsets[candidate.from + 1]; ++k) {
+        const glm::uint32* triangle = &result[adjacency[k] * 3];
+        dirty[triangle[0]] = true;
+        dirty[triangle[1]] = true;
+        dirty[triangle[2]] = true;
+      }
+    }
+
+    if (collapses == 0) {
+      break;
+    }
+
+    std::size_t write = 0;
+    for (std::size_t i = 0; i < result.size(); i += 3) {
+      glm::uint32 a = remap[result[i]];
+      glm::uint32 b = remap[result[i + 1]];
+      glm::uint32 c = remap[result[i + 2]];
+      if (a == b || b == c || a == c) {
+        continue;
+      }
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = c;
+    }
+    result.resize(write);
+  }
+
+  if (result_error) {
+    *result_error =
+        static_cast<glm::float32>(glm::sqrt(applied_cost) / extent);
+  }
+  return result;
+}
+
+void MeshSimplifier::GenerateLods(
+    const std::vector<meshdata::Vertex>& vertices,
+    const std::vector<glm::uint32>& indices, glm::uint32 lod_count,
+    glm::float32 reduction, glm::float32 target_error,
+    std::vector<std::vector<glm::uint32>>& lods,
+    std::vector<glm::float32>& errors) {
+  lods.clear();
+  errors.clear();
+  if (lod_count <= 1 || indices.empty()) {
+    return;
+  }
+  reduction = glm::clamp(reduction, 0.05f, 0.95f);
+
+  glm::float32 accumulated_error = 0.0f;
+  for (glm::uint32 level = 1; level < lod_count; ++level) {
+    const std::vector<glm::uint32>& source =
+        lods.empty() ? indices : lods.back();
+    std::size_t target =
+        static_cast<std::size_t>(static_cast<glm::float32>(source.size()) *
+                                 reduction) /
+        3 * 3;
+    // Finer levels get a proportionally smaller error budget.
+    glm::float32 level_error = target_error * static_cast<glm::float32>(level) /
+                               static_cast<glm::float32>(lod_count - 1);
+
+    glm::float32 error = 0.0f;
+    std::vector<glm::uint32> lod =
+        Simplify(vertices, source, target, level_error, &error);
+    if (lod.empty() ||
+        static_cast<glm::float32>(lod.size()) >
+            static_cast<glm::float32>(source.size()) * 0.9f) {
+      break;
+    }
+    accumulated_error += error;
+    lods.push_back(std::move(lod));
+    errors.push_back(accumulated_error);
+  }
+}
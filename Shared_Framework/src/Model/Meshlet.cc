@@ -0,0 +1,209 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/Meshlet.h"
+#include <algorithm>
+#include <limits>
+
+#include "Model/BoundingVolume.h"
+
+using namespace model;
+
+namespace {
+constexpr glm::uint32 kNoMeshlet = std::numeric_limits<glm::uint32>::max();
+
+// Cone spreads wider than this (about 84 degrees) are not worth testing.
+constexpr glm::float32 kMinConeDot = 0.1f;
+
+/**
+ * Fills the bounding sphere and normal cone of a finished meshlet.
+ */
+void ComputeBounds(const std::vector<meshdata::Vertex>& vertices,
+                   const std::vector<glm::uint32>& meshlet_vertices,
+                   const glm::uint32* triangle_indices,
+                   glm::uint32 triangle_count, Meshlet& meshlet) {
+  std::vector<glm::vec3> points;
+  points.reserve(meshlet_vertices.size());
+  for (auto vertex : meshlet_vertices) {
+    points.push_back(vertices[vertex].position);
+  }
+  BoundingSphere sphere = BoundingSphere::FromPoints(points);
+  meshlet.center = sphere.center;
+  meshlet.radius = sphere.radius;
+
+  std::vector<glm::vec3> normals;
+  normals.reserve(triangle_count);
+  glm::vec3 normal_sum(0.0f);
+  for (glm::uint32 i = 0; i < triangle_count; ++i) {
+    const glm::vec3& a = vertices[triangle_indices[i * 3]].position;
+    const glm::vec3& b = vertices[triangle_indices[i * 3 + 1]].position;
+    const glm::vec3& c = vertices[triangle_indices[i * 3 + 2]].position;
+    glm::vec3 normal = glm::cross(b - a, c - a);
+    glm::float32 length = glm::length(normal);
+    if (length > 0.0f) {
+      normals.push_back(normal / length);
+      normal_sum += normals.back();
+    }
+  }
+
+  meshlet.cone_axis = glm::vec3(0.0f, 0.0f, 1.0f);
+  meshlet.cone_cutoff = 1.0f;
+  glm::float32 sum_length = glm::length(normal_sum);
+  if (normals.empty() || sum_length <= 0.0f) {
+    return;
+  }
+  glm::vec3 axis = normal_sum / sum_length;
+  glm::float32 min_dot = 1.0f;
+  for (const auto& normal : normals) {
+    min_dot = std::min(min_dot, glm::dot(axis, normal));
+  }
+  meshlet.cone_axis = axis;
+  if (min_dot > kMinConeDot) {
+    meshlet.cone_cutoff = glm::sqrt(1.0f - min_dot * min_dot);
+  }
+}
+}  // namespace
+
+bool Meshlet::IsBackFacing(const glm::vec3& camera_position) const {
+  glm::vec3 offset = center - camera_position;
+  return glm::dot(offset, cone_axis) >=
+         cone_cutoff * glm::length(offset) + radius;
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(
+    const std::vector<meshdata::Vertex>& vertices,
+    const std::vector<glm::uint32>& indices,
+    std::vector<glm::uint32>& meshlet_indices) {
+  std::vector<Meshlet> meshlets;
+  meshlet_indices.clear();
+  meshlet_indices.reserve(indices.size());
+  auto triangle_count = static_cast<glm::uint32>(indices.size() / 3);
+  if (triangle_count == 0) {
+    return meshlets;
+  }
+
+  // Triangles around each vertex, stored as offsets into one array.
+  std::vector<glm::uint32> adjacency_offsets(vertices.size() + 1, 0);
+  for (glm::uint32 i = 0; i < triangle_count * 3; ++i) {
+    ++adjacency_offsets[indices[i] + 1];
+  }
+  for (std::size_t v = 0; v < vertices.size(); ++v) {
+    adjacency_offsets[v + 1] += adjacency_offsets[v];
+  }
+  std::vector<glm::uint32> adjacency(triangle_count * 3);
+  std::vector<glm::uint32> fill(adjacency_offsets.begin(),
+                                adjacency_offsets.end() - 1);
+  for (glm::uint32 i = 0; i < triangle_count * 3; ++i) {
+    adjacency[fill[indices[i]]++] = i / 3;
+  }
+
+  std::vector<bool> triangle_used(triangle_count, false);
+  // The meshlet each vertex was last added to.
+  std::vector<glm::uint32> vertex_meshlet(vertices.size(), kNoMeshlet);
+  std::vector<glm::uint32> meshlet_vertices;
+  std::vector<glm::uint32> candidates;
+  glm::uint32 next_seed = 0;
+
+  auto new_vertex_count = [&](glm::uint32 triangle, glm::uint32 meshlet) {
+    glm::uint32 count = 0;
+    for (int k = 0; k < 3; ++k) {
+      count += vertex_meshlet[indices[triangle * 3 + k]] != meshlet ? 1 : 0;
+    }
+    return count;
+  };
+
+  while (true) {
+    while (next_seed < triangle_count && triangle_used[next_seed]) {
+      ++next_seed;
+    }
+    if (next_seed == triangle_count) {
+      break;
+    }
+
+    auto meshlet_id = static_cast<glm::uint32>(meshlets.size());
+    Meshlet meshlet{};
+    meshlet.index_offset = static_cast<glm::uint32>(meshlet_indices.size());
+    meshlet_vertices.clear();
+    candidates.clear();
+    glm::uint32 meshlet_triangles = 0;
+    glm::uint32 triangle = next_seed;
+
+    while (true) {
+      // Add the triangle and queue its unused neighbours.
+      triangle_used[triangle] = true;
+      ++meshlet_triangles;
+      for (int k = 0; k < 3; ++k) {
+        glm::uint32 vertex = indices[triangle * 3 + k];
+        meshlet_indices.push_back(vertex);
+        if (vertex_meshlet[vertex] != meshlet_id) {
+          vertex_meshlet[vertex] = meshlet_id;
+          meshlet_vertices.push_back(vertex);
+        }
+        for (glm::uint32 a = adjacency_offsets[vertex];
+             a < adjacency_offsets[vertex + 1]; ++a) {
+          if (!triangle_used[adjacency[a]]) {
+            candidates.push_back(adjacency[a]);
+          }
+        }
+      }
+      if (meshlet_triangles == kMaxTriangles) {
+        break;
+      }
+
+      // Pick the neighbour adding the fewest vertices, dropping stale ones.
+      glm::uint32 best = kNoMeshlet;
+      glm::uint32 best_cost = 4;
+      std::size_t kept = 0;
+      for (std::size_t c = 0; c < candidates.size(); ++c) {
+        glm::uint32 candidate = candidates[c];
+        if (triangle_used[candidate]) {
+          continue;
+        }
+        candidates[kept++] = candidate;
+        glm::uint32 cost = new_vertex_count(candidate, meshlet_id);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best = candidate;
+        }
+      }
+      candidates.resize(kept);
+
+      // Disconnected pieces continue with the next triangle in index order,
+      // which keeps small islands from each getting their own meshlet.
+      if (best == kNoMeshlet) {
+        while (next_seed < triangle_count && triangle_used[next_seed]) {
+          ++next_seed;
+        }
+        if (next_seed == triangle_count) {
+          break;
+        }
+        best = next_seed;
+        best_cost = new_vertex_count(best, meshlet_id);
+      }
+      if (meshlet_vertices.size() + best_cost > kMaxVertices) {
+        break;
+      }
+      triangle = best;
+    }
+
+    meshlet.index_count = meshlet_triangles * 3;
+    ComputeBounds(vertices, meshlet_vertices,
+                  meshlet_indices.data() + meshlet.index_offset,
+                  meshlet_triangles, meshlet);
+    meshlets.push_back(meshlet);
+  }
+  return meshlets;
+}
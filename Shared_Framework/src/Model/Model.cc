@@ -14,23 +14,65 @@
  * limitations under the License.
  ******************************************************************************/
 
+#include <algorithm>
+#include <limits>
+#include <set>
 #include <utility>
 
 #include "Model/Model.h"
 #include "FilePathSystem.h"
+#include "Frustum.h"
 #include "LoadImage.h"
 #include "LoggerSystem.h"
 #include "Model/AssimpGLMHelpers.h"
+#include "Model/MeshSimplifier.h"
 #include "Model/ModelException.h"
+#include "Model/ModelLoadTask.h"
 #include "ImGui/OpenGLLogMessage.h"
 
 using namespace std;
 using namespace model;
 
+namespace {
+// The texture types the import reads from each material.
+const aiTextureType kMaterialTextureTypes[] = {
+    aiTextureType_DIFFUSE, aiTextureType_SPECULAR, aiTextureType_NORMALS,
+    aiTextureType_HEIGHT};
+
+glm::uint32 CountNodeMeshes(const aiNode* node) {
+  glm::uint32 count = node->mNumMeshes;
+  for (unsigned int i = 0; i < node->mNumChildren; ++i) {
+    count += CountNodeMeshes(node->mChildren[i]);
+  }
+  return count;
+}
+
+glm::uint32 CountSceneTextures(const aiScene* scene) {
+  std::set<std::string> paths;
+  for (unsigned int i = 0; i < scene->mNumMaterials; ++i) {
+    for (auto type : kMaterialTextureTypes) {
+      for (unsigned int j = 0; j < scene->mMaterials[i]->GetTextureCount(type);
+           ++j) {
+        aiString str;
+        scene->mMaterials[i]->GetTexture(type, j, &str);
+        paths.insert(str.C_Str());
+      }
+    }
+  }
+  return static_cast<glm::uint32>(paths.size());
+}
+}  // namespace
+
 Model::Model(const std::string& path, bool gamma)
-    : gamma_correction_(gamma), bone_counter_(0) {
+    : Model(path, LoadOptions{gamma}) {}
+
+Model::Model(const std::string& path, const LoadOptions& options)
+    : gamma_correction_(options.gamma_correction),
+      load_options_(options),
+      bone_counter_(0) {
   try {
-    LoadModel(path);
+    ImportSession session(path, GetImportFlags(options));
+    LoadModel(session);
   } catch (ModelException& e) {
     OpenGLLogMessage::GetInstance().AddLog(
         std::string(
@@ -39,17 +81,231 @@ Model::Model(const std::string& path, bool gamma)
   }
 }
 
+Model::Model(const ImportSession& session, const LoadOptions& options)
+    : gamma_correction_(options.gamma_correction),
+      load_options_(options),
+      bone_counter_(0) {
+  try {
+    LoadModel(session);
+  } catch (ModelException& e) {
+    OpenGLLogMessage::GetInstance().AddLog(
+        std::string(
+            "The model is incorrectly loaded for the following reasons: ") +
+        e.what());
+  }
+}
+
+Model::Model(const LoadOptions& options)
+    : gamma_correction_(options.gamma_correction),
+      load_options_(options),
+      bone_counter_(0) {}
+
+std::shared_ptr<ModelLoadTask> Model::LoadAsync(const std::string& path,
+                                                const LoadOptions& options) {
+  return std::make_shared<ModelLoadTask>(path, options);
+}
+
+std::shared_ptr<ModelLoadTask> Model::LoadAsync(const std::string& path) {
+  return LoadAsync(path, LoadOptions());
+}
+
+unsigned int Model::GetImportFlags(const LoadOptions& options) {
+  unsigned int flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+                       aiProcess_FlipUVs | aiProcess_CalcTangentSpace;
+  if (options.lod_count > 1) {
+    // The simplifier collapses edges between shared vertices, so duplicated
+    // vertices have to be welded first.
+    flags |= aiProcess_JoinIdenticalVertices;
+  }
+  return flags;
+}
+
 void Model::Draw(Shader& shader) {
+  draw_statistics_ = DrawStatistics();
   for (auto& meshes : meshes_) {
     meshes->Draw(shader);
+    ++draw_statistics_.meshes_drawn;
+    draw_statistics_.triangles_drawn += meshes->GetIndexCount() / 3;
   }
 }
 
-void Model::LoadModel(const std::string& path) {
-  Assimp::Importer importer;
-  const aiScene* scene = importer.ReadFile(
-      path, aiProcess_Triangulate | aiProcess_GenSmoothNormals |
-                aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+void Model::Draw(Shader& shader, const glm::mat4& model_matrix,
+                 const glm::mat4& view_projection) {
+  draw_statistics_ = DrawStatistics();
+  CullMeshes(view_projection * model_matrix);
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    if (!mesh_visibility_[i]) {
+      continue;
+    }
+    meshes_[i]->Draw(shader);
+    ++draw_statistics_.meshes_drawn;
+    draw_statistics_.triangles_drawn += meshes_[i]->GetIndexCount() / 3;
+  }
+}
+
+void Model::Draw(Shader& shader, const glm::mat4& model_matrix,
+                 const glm::mat4& view_projection,
+                 const std::vector<glm::mat4>& bone_matrices) {
+  draw_statistics_ = DrawStatistics();
+  CullPosedMeshes(view_projection * model_matrix, bone_matrices);
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    if (!mesh_visibility_[i]) {
+      continue;
+    }
+    meshes_[i]->Draw(shader);
+    ++draw_statistics_.meshes_drawn;
+    draw_statistics_.triangles_drawn += meshes_[i]->GetIndexCount() / 3;
+  }
+}
+
+void Model::Draw(Shader& shader, const glm::mat4& model_matrix,
+                 const glm::mat4& view, const glm::mat4& projection,
+                 glm::float32 viewport_height,
+                 std::vector<glm::uint32>& mesh_lods) {
+  draw_statistics_ = DrawStatistics();
+  const glm::mat4 model_view = view * model_matrix;
+  CullMeshes(projection * model_view);
+  SelectMeshLods(model_view, projection, viewport_height, mesh_lods);
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    if (!mesh_visibility_[i]) {
+      continue;
+    }
+    meshes_[i]->Draw(shader, mesh_lods[i]);
+    CountDrawnLevel(*meshes_[i], mesh_lods[i]);
+  }
+}
+
+void Model::DrawMeshlets(Shader& shader, const glm::mat4& model_matrix,
+                         const glm::mat4& view_projection,
+                         const glm::vec3& camera_position) {
+  draw_statistics_ = DrawStatistics();
+  glm::mat4 model_view_projection = view_projection * model_matrix;
+  CullMeshes(model_view_projection);
+
+  // Meshlet bounds are in model space, so test them against model space
+  // planes and a model space camera.
+  Frustum frustum(model_view_projection);
+  glm::vec3 local_camera =
+      glm::vec3(glm::inverse(model_matrix) * glm::vec4(camera_position, 1.0f));
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    Mesh* mesh = meshes_[i];
+    glm::uint32 meshlet_count =
+        static_cast<glm::uint32>(mesh->GetMeshlets().size());
+    if (!mesh_visibility_[i]) {
+      draw_statistics_.meshlets_culled += meshlet_count;
+      continue;
+    }
+    glm::uint32 index_count = 0;
+    glm::uint32 drawn =
+        mesh->DrawMeshlets(shader, frustum, local_camera, &index_count);
+    ++draw_statistics_.meshes_drawn;
+    draw_statistics_.meshlets_drawn += drawn;
+    draw_statistics_.meshlets_culled += meshlet_count - drawn;
+    draw_statistics_.triangles_drawn += index_count / 3;
+  }
+}
+
+void Model::DrawInstanced(Shader& shader, const InstanceBuffer& instance_buffer,
+                          GLsizei count) {
+  draw_statistics_ = DrawStatistics();
+  if (count <= 0) {
+    return;
+  }
+  for (auto& meshes : meshes_) {
+    meshes->DrawInstanced(shader, instance_buffer, count);
+    ++draw_statistics_.meshes_drawn;
+    draw_statistics_.triangles_drawn +=
+        meshes->GetIndexCount() / 3 * static_cast<glm::uint64>(count);
+  }
+  draw_statistics_.instances_drawn = static_cast<glm::uint32>(count);
+}
+
+GLsizei Model::DrawInstanced(Shader& shader, InstanceBuffer& instance_buffer,
+                             const std::vector<glm::mat4>& transforms,
+                             const glm::mat4& view_projection) {
+  GLsizei visible = instance_buffer.SetVisibleTransforms(
+      transforms, bounding_sphere_, Frustum(view_projection));
+  DrawInstanced(shader, instance_buffer, visible);
+  draw_statistics_.instances_culled =
+      static_cast<glm::uint32>(transforms.size() - visible);
+  return visible;
+}
+
+void Model::Submit(RenderQueue& queue, Shader& shader,
+                   const glm::mat4& model_matrix, const glm::mat4& view,
+                   const glm::mat4& projection, glm::float32 viewport_height,
+                   std::vector<glm::uint32>& mesh_lods, RenderQueue::Pass pass,
+                   glm::int32 morph_weight_offset) {
+  draw_statistics_ = DrawStatistics();
+  const glm::mat4 model_view = view * model_matrix;
+  CullMeshes(projection * model_view);
+  SelectMeshLods(model_view, projection, viewport_height, mesh_lods);
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    if (!mesh_visibility_[i]) {
+      continue;
+    }
+    queue.Submit(pass, shader, *meshes_[i], model_matrix, mesh_lods[i],
+                 morph_weight_offset);
+    CountDrawnLevel(*meshes_[i], mesh_lods[i]);
+  }
+}
+
+void Model::SelectMeshLods(const glm::mat4& model_view,
+                           const glm::mat4& projection,
+                           glm::float32 viewport_height,
+                           std::vector<glm::uint32>& mesh_lods) const {
+  mesh_lods.resize(meshes_.size(), 0);
+  // projection[1][1] is the cotangent of half the vertical field of view for a
+  // perspective projection and 2 / height for an orthographic one.
+  const glm::float32 pixels_per_unit =
+      projection[1][1] * viewport_height * 0.5f;
+  const bool perspective = projection[3][3] == 0.0f;
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    const Mesh* mesh = meshes_[i];
+    if (!mesh_visibility_[i] || mesh->GetLodLevels().size() <= 1) {
+      continue;
+    }
+    BoundingSphere sphere = mesh->GetBoundingSphere().Transform(model_view);
+    glm::float32 screen_diameter = 2.0f * sphere.radius * pixels_per_unit;
+    if (perspective) {
+      glm::float32 distance = -sphere.center.z;
+      // Inside the sphere the mesh may fill the screen, keep full detail.
+      screen_diameter = distance > sphere.radius
+                            ? screen_diameter / distance
+                            : std::numeric_limits<glm::float32>::max();
+    }
+    mesh_lods[i] = mesh->SelectLod(screen_diameter, lod_settings_,
+                                   mesh_lods[i]);
+  }
+}
+
+void Model::CountDrawnLevel(const Mesh& mesh, glm::uint32 level) {
+  const auto& lod_levels = mesh.GetLodLevels();
+  glm::uint32 full_count = lod_levels.front().index_count;
+  glm::uint32 drawn_count =
+      lod_levels[std::min<std::size_t>(level, lod_levels.size() - 1)]
+          .index_count;
+  ++draw_statistics_.meshes_drawn;
+  draw_statistics_.triangles_drawn += drawn_count / 3;
+  draw_statistics_.triangles_saved += (full_count - drawn_count) / 3;
+}
+
+void Model::LoadModel(const ImportSession& session) {
+  DecodedScene decoded;
+  LoadProgress progress;
+  DecodeModel(session, decoded, progress);
+  for (auto& texture : decoded.textures) {
+    UploadTexture(texture);
+  }
+  for (auto& mesh : decoded.meshes) {
+    UploadMesh(mesh, decoded);
+  }
+  UpdateBounds();
+}
+
+bool Model::DecodeModel(const ImportSession& session, DecodedScene& decoded,
+                        LoadProgress& progress) {
+  const aiScene* scene = session.GetScene();
 
   // Check for errors
   if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE ||
@@ -57,15 +313,139 @@ void Model::LoadModel(const std::string& path) {
   {
     throw ModelException(
         LoggerSystem::Level::kError,
-        std::string("ERROR::ASSIMP:: ") + importer.GetErrorString());
+        std::string("ERROR::ASSIMP:: ") + session.GetError());
   }
 
+  const std::string& path = session.GetPath();
   directory_ = path.substr(0, path.find_last_of('/'));
+  progress.meshes_total = CountNodeMeshes(scene->mRootNode);
+  progress.textures_total = CountSceneTextures(scene);
   // Process ASSIMP's root_ node recursively
-  ProcessNode(scene->mRootNode, scene);
+  return ProcessNode(scene->mRootNode, scene, decoded, progress);
+}
+
+glm::uint64 Model::UploadTexture(DecodedTexture& texture) {
+  glm::uint64 size = texture.image.pixels.size();
+  if (texture.embedded) {
+    texture.texture.id = LoadImage::GetInstance().UploadTexture2D(
+        texture.image, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR);
+  } else {
+    texture.texture.id = LoadImage::GetInstance().UploadTexture2D(
+        texture.image, GL_REPEAT, GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR);
+  }
+  std::vector<unsigned char>().swap(texture.image.pixels);
+  /**
+   * Store it as texture loaded for entire model,to ensure we won't 
+   * unnecessarily load duplicate textures.
+   */
+  texture_loaded_.push_back(texture.texture);
+  return size;
+}
+
+glm::uint64 Model::UploadMesh(DecodedMesh& mesh, const DecodedScene& decoded) {
+  vector<meshdata::Texture> textures;
+  textures.reserve(mesh.textures.size());
+  for (const auto& used : mesh.textures) {
+    // The same image may serve another role in this material.
+    meshdata::Texture texture = decoded.textures[used.first].texture;
+    texture.type = used.second;
+    textures.push_back(texture);
+  }
+  glm::uint64 size = mesh.GetUploadSize();
+
+  // Create a mesh object from the extracted mesh data
+  auto* result = new Mesh(mesh.vertices, mesh.indices, textures,
+                          mesh.lod_indices, mesh.lod_errors);
+  if (!mesh.meshlets.empty()) {
+    result->SetMeshlets(mesh.meshlets);
+  }
+  if (!mesh.morph_targets.IsEmpty()) {
+    result->SetMorphTargets(std::make_unique<MorphTargets>(mesh.morph_targets));
+  }
+  if (load_options_.cpu_data != Mesh::CpuDataPolicy::kKeepAll) {
+    result->SetCpuDataPolicy(load_options_.cpu_data);
+  }
+  meshes_.push_back(result);
+  mesh = DecodedMesh();
+  return size;
 }
 
-void Model::ProcessNode(aiNode* node, const aiScene* scene) {
+glm::uint64 Model::DecodedMesh::GetUploadSize() const {
+  std::size_t index_count = indices.size();
+  for (const auto& level : lod_indices) {
+    index_count += level.size();
+  }
+  return vertices.size() * sizeof(meshdata::Vertex) +
+         index_count * sizeof(glm::uint32) + morph_targets.GetByteSize();
+}
+
+void Model::UpdateBounds() {
+  bounding_box_ = AxisAlignedBox();
+  skinned_bounds_ = SkinnedBounds();
+  for (auto& meshes : meshes_) {
+    bounding_box_.Expand(meshes->GetBoundingBox());
+    skinned_bounds_.Expand(meshes->GetSkinnedBounds());
+  }
+  bounding_sphere_ = BoundingSphere();
+  if (bounding_box_.IsEmpty()) {
+    return;
+  }
+  // Center the sphere on the box and grow it over every mesh sphere, which
+  // is usually tighter than the half diagonal of the box.
+  bounding_sphere_.center = bounding_box_.GetCenter();
+  bounding_sphere_.radius = 0.0f;
+  for (auto& meshes : meshes_) {
+    const BoundingSphere& sphere = meshes->GetBoundingSphere();
+    if (!sphere.IsEmpty()) {
+      bounding_sphere_.radius = std::max(
+          bounding_sphere_.radius,
+          glm::length(sphere.center - bounding_sphere_.center) +
+              sphere.radius);
+    }
+  }
+}
+
+void Model::CullMeshes(const glm::mat4& model_view_projection) {
+  // Planes taken from the full matrix live in model space, so the mesh
+  // bounds can be tested without transforming them.
+  Frustum frustum(model_view_projection);
+  mesh_visibility_.assign(meshes_.size(), 0);
+  if (bounding_sphere_.IsEmpty() ||
+      !frustum.IntersectsSphere(bounding_sphere_.center,
+                                bounding_sphere_.radius)) {
+    draw_statistics_.meshes_culled = static_cast<glm::uint32>(meshes_.size());
+    return;
+  }
+
+  mesh_spheres_.resize(meshes_.size());
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    const BoundingSphere& sphere = meshes_[i]->GetBoundingSphere();
+    mesh_spheres_[i] = glm::vec4(sphere.center, sphere.radius);
+  }
+  std::size_t visible_count = frustum.CullSpheres(
+      mesh_spheres_.data(), mesh_spheres_.size(), mesh_visibility_.data());
+  draw_statistics_.meshes_culled =
+      static_cast<glm::uint32>(meshes_.size() - visible_count);
+}
+
+void Model::CullPosedMeshes(const glm::mat4& model_view_projection,
+                            const std::vector<glm::mat4>& bone_matrices) {
+  Frustum frustum(model_view_projection);
+  mesh_visibility_.assign(meshes_.size(), 0);
+  glm::uint32 visible_count = 0;
+  for (std::size_t i = 0; i < meshes_.size(); ++i) {
+    AxisAlignedBox box = meshes_[i]->GetSkinnedBounds().Pose(bone_matrices);
+    if (!box.IsEmpty() && frustum.IntersectsBox(box.min, box.max)) {
+      mesh_visibility_[i] = 1;
+      ++visible_count;
+    }
+  }
+  draw_statistics_.meshes_culled =
+      static_cast<glm::uint32>(meshes_.size()) - visible_count;
+}
+
+bool Model::ProcessNode(aiNode* node, const aiScene* scene,
+                        DecodedScene& decoded, LoadProgress& progress) {
   // Process each mesh located at the current node
   for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
     /*
@@ -73,25 +453,39 @@ void Model::ProcessNode(aiNode* node, const aiScene* scene) {
 	 * The scene contains all the data, node is just to keep stuff organized 
 	 * (like relations between nodes). 
 	 */
+    if (progress.cancelled) {
+      return false;
+    }
     aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-    meshes_.push_back(ProcessMesh(mesh, scene));
+    DecodedMesh decoded_mesh = ProcessMesh(mesh, scene, decoded, progress);
+    // The mesh stops at the first texture decoded after a cancellation.
+    if (progress.cancelled) {
+      return false;
+    }
+    decoded.meshes.push_back(std::move(decoded_mesh));
+    ++progress.meshes_parsed;
   }
   /**
    * After we've processed all the meshes (if any) we then recursively process 
    * each of the children nodes
    */
   for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-    ProcessNode(node->mChildren[i], scene);
+    if (!ProcessNode(node->mChildren[i], scene, decoded, progress)) {
+      return false;
+    }
   }
+  return true;
 }
 
-Mesh* Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
+Model::DecodedMesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene,
+                                      DecodedScene& decoded,
+                                      LoadProgress& progress) {
   /*
    * Data to fill 
    */
-  vector<meshdata::Vertex> vertices;
-  vector<GLuint> indices;
-  vector<meshdata::Texture> textures;
+  DecodedMesh result;
+  vector<meshdata::Vertex>& vertices = result.vertices;
+  vector<glm::uint32>& indices = result.indices;
 
   // Walk through each of the mesh's vertices
   for (unsigned int i = 0; i < mesh->mNumVertices; ++i) {
@@ -145,6 +539,33 @@ Mesh* Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
     vertices.push_back(vertex);
   }
 
+  // Blend shapes, kept only for the vertices they move
+  if (mesh->mNumAnimMeshes > 0) {
+    vector<MorphTargets::Target> targets(mesh->mNumAnimMeshes);
+    for (unsigned int i = 0; i < mesh->mNumAnimMeshes; ++i) {
+      const aiAnimMesh* anim_mesh = mesh->mAnimMeshes[i];
+      targets[i].name = anim_mesh->mName.C_Str();
+      if (anim_mesh->mNumVertices != mesh->mNumVertices) {
+        continue;
+      }
+      if (anim_mesh->HasPositions()) {
+        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
+          targets[i].positions.push_back(
+              AssimpGLMHelpers::GetInstance().Assimp3DToGLMVec3(
+                  anim_mesh->mVertices[j]));
+        }
+      }
+      if (anim_mesh->HasNormals()) {
+        for (unsigned int j = 0; j < mesh->mNumVertices; ++j) {
+          targets[i].normals.push_back(
+              AssimpGLMHelpers::GetInstance().Assimp3DToGLMVec3(
+                  anim_mesh->mNormals[j]));
+        }
+      }
+    }
+    result.morph_targets = MorphTargets::Compress(vertices, targets);
+  }
+
   /**
    * Now wak through each of the mesh's faces (a face is a mesh its triangle) 
    * and retrieve the corresponding vertex indices.
@@ -161,8 +582,8 @@ Mesh* Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
   /*
    * we assume a convention for sampler names in the shaders. Each diffuse 
    * texture should be named as 'texture_diffuseN' where N is a sequential 
-   * number ranging from 1 to MAX_SAMPLER_NUMBER.Same applies to other texture 
-   * as the following list summarizes:
+   * number ranging from 1 to Material::kMaxTexturesPerType. Same applies to 
+   * other texture as the following list summarizes:
    * diffuse: texture_diffuseN,
    * specular: texture_specularN,
    * normal: texture_normalN,
@@ -170,77 +591,96 @@ Mesh* Model::ProcessMesh(aiMesh* mesh, const aiScene* scene) {
    */
 
   // Diffuse maps
-  vector<meshdata::Texture> diffuse_maps = LoadMaterialTexture(
-      material, aiTextureType_DIFFUSE, "texture_diffuse", scene);
-  textures.insert(textures.end(), diffuse_maps.begin(), diffuse_maps.end());
+  bool loaded = LoadMaterialTexture(material, aiTextureType_DIFFUSE,
+                                    meshdata::TextureType::kDiffuse, scene,
+                                    decoded, result, progress);
   // Specular maps
-  vector<meshdata::Texture> specular_maps = LoadMaterialTexture(
-      material, aiTextureType_SPECULAR, "texture_specular", scene);
-  textures.insert(textures.end(), specular_maps.begin(), specular_maps.end());
+  loaded = loaded && LoadMaterialTexture(material, aiTextureType_SPECULAR,
+                                         meshdata::TextureType::kSpecular,
+                                         scene, decoded, result, progress);
   // Normal maps
-  std::vector<meshdata::Texture> normal_maps = LoadMaterialTexture(
-      material, aiTextureType_NORMALS, "texture_normal", scene);
-  textures.insert(textures.end(), normal_maps.begin(), normal_maps.end());
+  loaded = loaded && LoadMaterialTexture(material, aiTextureType_NORMALS,
+                                         meshdata::TextureType::kNormal,
+                                         scene, decoded, result, progress);
   // Height maps
-  std::vector<meshdata::Texture> height_maps = LoadMaterialTexture(
-      material, aiTextureType_HEIGHT, "texture_height", scene);
-  textures.insert(textures.end(), height_maps.begin(), height_maps.end());
+  loaded = loaded && LoadMaterialTexture(material, aiTextureType_HEIGHT,
+                                         meshdata::TextureType::kHeight,
+                                         scene, decoded, result, progress);
+  // Cancelled, ProcessNode drops the mesh, so skip the rest of the work.
+  if (!loaded) {
+    return result;
+  }
 
   if (scene->HasAnimations() || scene->mMeshes[0]->HasBones()) {
     ExtractBoneWeightForVertices(vertices, mesh, scene);
   }
 
-  // Return a mesh object created from the extracted mesh data
-  return new Mesh(vertices, indices, textures);
+  // Generate the simplified levels of detail
+  if (load_options_.lod_count > 1) {
+    MeshSimplifier::GenerateLods(vertices, indices, load_options_.lod_count,
+                                 load_options_.lod_reduction,
+                                 load_options_.lod_target_error,
+                                 result.lod_indices, result.lod_errors);
+  }
+
+  // Split the full detail level into meshlets, which reorders its triangles
+  if (load_options_.build_meshlets) {
+    vector<glm::uint32> meshlet_indices;
+    result.meshlets = MeshletBuilder::Build(vertices, indices, meshlet_indices);
+    indices.swap(meshlet_indices);
+  }
+
+  progress.bytes_total += result.GetUploadSize();
+  return result;
 }
 
-std::vector<meshdata::Texture> Model::LoadMaterialTexture(
-    aiMaterial* mat, aiTextureType type, const std::string& type_name,
-    const aiScene* scene) {
-  vector<meshdata::Texture> textures;
+bool Model::LoadMaterialTexture(aiMaterial* mat, aiTextureType type,
+                                meshdata::TextureType texture_type,
+                                const aiScene* scene, DecodedScene& decoded,
+                                DecodedMesh& mesh, LoadProgress& progress) {
   for (unsigned int i = 0; i < mat->GetTextureCount(type); ++i) {
     aiString str;
     mat->GetTexture(type, i, &str);
     // Check if texture was loaded before and if so, continue to next iteration:
     // skip loading a new texture
     auto item_path =
-        std::find_if(texture_loaded_.begin(), texture_loaded_.end(),
-                     [&str](const meshdata::Texture& texture) {
-                       return texture.path == str.C_Str();
+        std::find_if(decoded.textures.begin(), decoded.textures.end(),
+                     [&str](const DecodedTexture& texture) {
+                       return texture.texture.path == str.C_Str();
                      });
+    if (item_path != decoded.textures.end()) {
+      mesh.textures.emplace_back(item_path - decoded.textures.begin(),
+                                 texture_type);
+      continue;
+    }
 
-    if (item_path != texture_loaded_.end()) {
-      textures.push_back((*item_path));
+    /*
+     * If texture hasn't been loaded already, decode it, unless the import
+     * was cancelled: decoding is the slow part of a load
+     */
+    if (progress.cancelled) {
+      return false;
+    }
+    DecodedTexture texture;
+    texture.texture.type = texture_type;
+    texture.texture.path = str.C_Str();
+    auto ai_texture = scene->GetEmbeddedTexture(str.C_Str());
+    texture.embedded = ai_texture != nullptr;
+    if (texture.embedded) {
+      texture.image = LoadImage::GetInstance().DecodeImage2DFromAssimp(
+          ai_texture, gamma_correction_);
     } else {
-      /*
-	   * If texture hasn't been loaded already, load it
-	   */
-      meshdata::Texture texture;
       auto file_path = FilePathSystem::GetInstance().SplicePath(
           "%s/%s", directory_.c_str(), str.C_Str());
-
-      auto ai_texture = scene->GetEmbeddedTexture(str.C_Str());
-      if (ai_texture != nullptr) {
-        texture.id = LoadImage::GetInstance().LoadTexture2DFromAssimp(
-            ai_texture, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR,
-            gamma_correction_);
-      } else {
-        texture.id = LoadImage::GetInstance().LoadTexture2D(
-            file_path, GL_REPEAT, GL_LINEAR, GL_LINEAR_MIPMAP_LINEAR,
-            gamma_correction_);
-      }
-      texture.type = type_name;
-      texture.path = str.C_Str();
-      textures.push_back(texture);
-      /**
-     * Store it as texture loaded for entire model,to ensure we won't 
-     * unnecessarily load duplicate textures.
-     */
-      texture_loaded_.push_back(texture);
+      texture.image = LoadImage::GetInstance().DecodeImage2D(
+          file_path, gamma_correction_);
     }
+    progress.bytes_total += texture.image.pixels.size();
+    ++progress.textures_decoded;
+    mesh.textures.emplace_back(decoded.textures.size(), texture_type);
+    decoded.textures.push_back(std::move(texture));
   }
-
-  return textures;
+  return true;
 }
 
 void Model::SetVertexBoneDataToDefault(meshdata::Vertex& vertex) {
@@ -342,6 +782,7 @@ vector<Mesh*> Model::GetMeshes() const {
 
 void Model::SetMeshes(vector<Mesh*> meshes) {
   meshes_ = std::move(meshes);
+  UpdateBounds();
 }
 
 bool Model::IsGammaCorrection() const {
@@ -350,4 +791,58 @@ bool Model::IsGammaCorrection() const {
 
 void Model::SetGammaCorrection(bool gamma_correction) {
   gamma_correction_ = gamma_correction;
+}
+
+const LodSettings& Model::GetLodSettings() const {
+  return lod_settings_;
+}
+
+void Model::SetLodSettings(const LodSettings& lod_settings) {
+  lod_settings_ = lod_settings;
+}
+
+const AxisAlignedBox& Model::GetBoundingBox() const {
+  return bounding_box_;
+}
+
+const SkinnedBounds& Model::GetSkinnedBounds() const {
+  return skinned_bounds_;
+}
+
+glm::uint32 Model::GetMorphTargetCount() const {
+  glm::uint32 count = 0;
+  for (const auto* mesh : meshes_) {
+    if (mesh->GetMorphTargets() != nullptr) {
+      count = std::max(count, mesh->GetMorphTargets()->GetTargetCount());
+    }
+  }
+  return count;
+}
+
+const BoundingSphere& Model::GetBoundingSphere() const {
+  return bounding_sphere_;
+}
+
+void Model::SetCpuDataPolicy(Mesh::CpuDataPolicy policy) {
+  for (auto& mesh : meshes_) {
+    mesh->SetCpuDataPolicy(policy);
+  }
+}
+
+Model::MemoryReport Model::GetMemoryReport() const {
+  MemoryReport report;
+  for (const auto& mesh : meshes_) {
+    auto usage = mesh->GetMemoryUsage();
+    ++report.mesh_count;
+    report.vertex_count += mesh->GetVertexCount();
+    report.index_count += mesh->GetIndexCount();
+    report.cpu_bytes += usage.cpu_bytes;
+    report.gpu_bytes += usage.gpu_bytes;
+  }
+  report.texture_count = static_cast<glm::uint32>(texture_loaded_.size());
+  return report;
+}
+
+const Model::DrawStatistics& Model::GetDrawStatistics() const {
+  return draw_statistics_;
 }
\ No newline at end of file
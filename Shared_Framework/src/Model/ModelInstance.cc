@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/ModelInstance.h"
+#include "Model/MorphTargets.h"
+#include <utility>
+
+using namespace model;
+
+ModelInstance::ModelInstance(std::shared_ptr<Model> model)
+    : model_(std::move(model)), transform_(1.0f) {}
+
+void ModelInstance::Draw(Shader& shader, const glm::mat4& view_projection) {
+  SetUniforms(shader);
+  if (animator_ != nullptr) {
+    model_->Draw(shader, transform_, view_projection,
+                 animator_->GetFinalBoneMatrices());
+  } else {
+    model_->Draw(shader, transform_, view_projection);
+  }
+}
+
+void ModelInstance::Draw(Shader& shader, const glm::mat4& view,
+                         const glm::mat4& projection,
+                         glm::float32 viewport_height) {
+  if (animator_ != nullptr) {
+    Draw(shader, projection * view);
+    return;
+  }
+  SetUniforms(shader);
+  model_->Draw(shader, transform_, view, projection, viewport_height,
+               mesh_lods_);
+}
+
+void ModelInstance::SetUniforms(Shader& shader) const {
+  if (animator_ != nullptr) {
+    shader.SetInt("bone_offset", static_cast<GLint>(palette_offset_));
+  }
+  if (morph_weight_offset_ >= 0) {
+    MorphTargets::SetWeightOffset(shader, morph_weight_offset_);
+  }
+  shader.SetMat4("model", transform_);
+}
+
+void ModelInstance::SetAnimation(
+    std::shared_ptr<const Animation> animation) {
+  if (animator_ == nullptr) {
+    animator_ = std::make_unique<Animator>(std::move(animation));
+  } else {
+    animator_->ResetAnimation(std::move(animation));
+  }
+}
+
+void ModelInstance::SetPaletteOffset(glm::uint32 offset) {
+  palette_offset_ = offset;
+}
+
+void ModelInstance::SetMorphWeight(glm::uint32 target, glm::float32 weight) {
+  if (target >= morph_weights_.size()) {
+    morph_weights_.resize(target + 1, 0.0f);
+  }
+  morph_weights_[target] = weight;
+}
+
+const std::vector<glm::float32>& ModelInstance::GetMorphWeights() const {
+  return morph_weights_;
+}
+
+void ModelInstance::SetMorphWeightOffset(glm::uint32 offset) {
+  morph_weight_offset_ = static_cast<glm::int32>(offset);
+}
+
+glm::int32 ModelInstance::GetMorphWeightOffset() const {
+  return morph_weight_offset_;
+}
+
+void ModelInstance::UpdateAnimation(glm::float64 delta_time) {
+  if (animator_ != nullptr) {
+    animator_->UpdateAnimation(delta_time);
+  }
+}
+
+Animator* ModelInstance::GetAnimator() const {
+  return animator_.get();
+}
+
+AxisAlignedBox ModelInstance::GetBounds() const {
+  if (animator_ != nullptr) {
+    return model_->GetSkinnedBounds()
+        .Pose(animator_->GetFinalBoneMatrices())
+        .Transform(transform_);
+  }
+  return model_->GetBoundingBox().Transform(transform_);
+}
+
+const std::shared_ptr<Model>& ModelInstance::GetModel() const {
+  return model_;
+}
+
+const glm::mat4& ModelInstance::GetTransform() const {
+  return transform_;
+}
+
+void ModelInstance::SetTransform(const glm::mat4& transform) {
+  transform_ = transform;
+}
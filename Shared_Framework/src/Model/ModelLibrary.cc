@@ -0,0 +1,126 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/ModelLibrary.h"
+
+using namespace model;
+
+std::once_flag ModelLibrary::initialized_;
+ModelLibrary* ModelLibrary::instance_ = nullptr;
+
+ModelLibrary& ModelLibrary::GetInstance() {
+  if (instance_ == nullptr) {
+    std::call_once(initialized_, []() { instance_ = new ModelLibrary(); });
+  }
+  return *instance_;
+}
+
+std::shared_ptr<Model> ModelLibrary::Load(const std::string& path,
+                                          const Model::LoadOptions& options) {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  auto& model = models_[MakeKey(path, options)];
+  if (model == nullptr) {
+    model = std::make_shared<Model>(path, options);
+  }
+  return model;
+}
+
+std::shared_ptr<Model> ModelLibrary::LoadAnimated(
+    const std::string& path, const Model::LoadOptions& options) {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  auto& model = models_[MakeKey(path, options)];
+  if (model != nullptr) {
+    return model;
+  }
+  auto session =
+      std::make_shared<ImportSession>(path, Model::GetImportFlags(options));
+  model = std::make_shared<Model>(*session, options);
+  // The set keeps the import, so no clip needs the file parsed again.
+  if (session->GetAnimationCount() > 0) {
+    animation_sets_[std::make_pair(path, model.get())] = {
+        model, std::make_shared<AnimationSet>(session, model)};
+  }
+  return model;
+}
+
+std::shared_ptr<AnimationSet> ModelLibrary::LoadAnimationSet(
+    const std::string& path, const std::shared_ptr<Model>& model) {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  auto& entry = animation_sets_[std::make_pair(path, model.get())];
+  if (entry.set == nullptr || entry.model.lock() != model) {
+    entry.model = model;
+    entry.set = std::make_shared<AnimationSet>(
+        std::make_shared<ImportSession>(path, aiProcess_Triangulate), model);
+  }
+  return entry.set;
+}
+
+std::shared_ptr<const Animation> ModelLibrary::LoadAnimation(
+    const std::string& path, const std::shared_ptr<Model>& model,
+    glm::uint32 clip_index) {
+  return LoadAnimationSet(path, model)->Get(clip_index);
+}
+
+std::size_t ModelLibrary::ReleaseUnused() {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  std::size_t released = 0;
+  // Models go first, so the sets of the models released here go with them.
+  for (auto it = models_.begin(); it != models_.end();) {
+    if (it->second.use_count() == 1) {
+      it = models_.erase(it);
+      ++released;
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = animation_sets_.begin(); it != animation_sets_.end();) {
+    auto& set = it->second.set;
+    if (it->second.model.expired()) {
+      released += set->GetDecodedCount();
+      it = animation_sets_.erase(it);
+      continue;
+    }
+    released += set->ReleaseUnused();
+    // An unused set with nothing decoded only holds the parsed file.
+    if (set.use_count() == 1 && set->GetDecodedCount() == 0) {
+      it = animation_sets_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return released;
+}
+
+void ModelLibrary::Clear() {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  animation_sets_.clear();
+  models_.clear();
+}
+
+std::size_t ModelLibrary::GetModelCount() const {
+  std::lock_guard<std::mutex> lock(library_mutex_);
+  return models_.size();
+}
+
+std::string ModelLibrary::MakeKey(const std::string& path,
+                                  const Model::LoadOptions& options) {
+  return path + '|' + std::to_string(options.gamma_correction) + '|' +
+         std::to_string(options.lod_count) + '|' +
+         std::to_string(options.lod_reduction) + '|' +
+         std::to_string(options.lod_target_error) + '|' +
+         std::to_string(options.build_meshlets) + '|' +
+         std::to_string(static_cast<int>(options.cpu_data));
+}
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include <exception>
+
+#include "Model/ModelLoadTask.h"
+#include "LoggerSystem.h"
+#include "Model/ModelException.h"
+#include "ImGui/OpenGLLogMessage.h"
+
+using namespace model;
+
+ModelLoadTask::ModelLoadTask(const std::string& path,
+                             const Model::LoadOptions& options)
+    : model_(new Model(options)),
+      state_(State::kDecoding),
+      next_texture_(0),
+      next_mesh_(0) {
+  worker_ = std::thread(&ModelLoadTask::Decode, this, path);
+}
+
+ModelLoadTask::~ModelLoadTask() {
+  Cancel();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  // A ready model owns what it uploaded; anything else was left mid-upload.
+  if (state_ != State::kReady) {
+    Discard();
+  }
+}
+
+void ModelLoadTask::Decode(const std::string& path) {
+  try {
+    ImportSession session(path, Model::GetImportFlags(model_->load_options_));
+    if (model_->DecodeModel(session, decoded_, progress_)) {
+      state_ = State::kUploading;
+    } else {
+      state_ = State::kCancelled;
+    }
+  } catch (ModelException& e) {
+    error_ = e.what();
+    state_ = State::kFailed;
+  } catch (std::exception& e) {
+    error_ = e.what();
+    state_ = State::kFailed;
+  } catch (...) {
+    error_ = "unknown error while decoding " + path;
+    state_ = State::kFailed;
+  }
+}
+
+bool ModelLoadTask::Update(glm::uint64 upload_budget) {
+  State state = state_;
+  if (state == State::kDecoding) {
+    return false;
+  }
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  if (state == State::kReady) {
+    return true;
+  }
+  if (state == State::kFailed || state == State::kCancelled) {
+    if (!error_.empty()) {
+      OpenGLLogMessage::GetInstance().AddLog(
+          std::string(
+              "The model is incorrectly loaded for the following reasons: ") +
+          error_);
+      error_.clear();
+    }
+    Discard();
+    return true;
+  }
+  if (progress_.cancelled) {
+    Discard();
+    state_ = State::kCancelled;
+    return true;
+  }
+
+  // Textures first, every mesh needs its texture ids.
+  glm::uint64 uploaded = 0;
+  while (uploaded < upload_budget &&
+         next_texture_ < decoded_.textures.size()) {
+    uploaded += model_->UploadTexture(decoded_.textures[next_texture_++]);
+  }
+  while (uploaded < upload_budget && next_mesh_ < decoded_.meshes.size()) {
+    uploaded += model_->UploadMesh(decoded_.meshes[next_mesh_++], decoded_);
+  }
+  progress_.bytes_uploaded += uploaded;
+  if (next_mesh_ < decoded_.meshes.size()) {
+    return false;
+  }
+
+  model_->UpdateBounds();
+  decoded_ = Model::DecodedScene();
+  state_ = State::kReady;
+  return true;
+}
+
+void ModelLoadTask::Cancel() {
+  progress_.cancelled = true;
+}
+
+void ModelLoadTask::Discard() {
+  if (model_ == nullptr) {
+    return;
+  }
+  // The model does not own its textures, so delete the ones uploaded so far.
+  for (const auto& texture : model_->GetTextureLoaded()) {
+    glDeleteTextures(1, &texture.id);
+  }
+  model_.reset();
+  decoded_ = Model::DecodedScene();
+}
+
+ModelLoadTask::State ModelLoadTask::GetState() const {
+  return state_;
+}
+
+ModelLoadTask::Progress ModelLoadTask::GetProgress() const {
+  Progress progress;
+  progress.meshes_parsed = progress_.meshes_parsed;
+  progress.meshes_total = progress_.meshes_total;
+  progress.textures_decoded = progress_.textures_decoded;
+  progress.textures_total = progress_.textures_total;
+  progress.bytes_uploaded = progress_.bytes_uploaded;
+  progress.bytes_total = progress_.bytes_total;
+  return progress;
+}
+
+std::shared_ptr<Model> ModelLoadTask::GetModel() const {
+  return state_ == State::kReady ? model_ : nullptr;
+}
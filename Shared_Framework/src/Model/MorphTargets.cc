@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/MorphTargets.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace model;
+
+std::vector<MorphTargets::ProgramUniforms> MorphTargets::programs_;
+
+namespace {
+glm::float32 MaxComponent(const glm::vec3& value) {
+  glm::vec3 magnitude = glm::abs(value);
+  return std::max({magnitude.x, magnitude.y, magnitude.z});
+}
+
+glm::i16vec3 Quantize(const glm::vec3& value, glm::float32 scale) {
+  if (scale <= 0.0f) {
+    return glm::i16vec3(0);
+  }
+  return glm::i16vec3(glm::clamp(glm::round(value / scale),
+                                 glm::vec3(-32767.0f), glm::vec3(32767.0f)));
+}
+}  // namespace
+
+bool MorphTargets::SparseData::IsEmpty() const {
+  return deltas.empty();
+}
+
+glm::uint32 MorphTargets::SparseData::GetEntryCount() const {
+  return static_cast<glm::uint32>(deltas.size() / kTexelsPerEntry);
+}
+
+glm::uint64 MorphTargets::SparseData::GetByteSize() const {
+  return row_starts.size() * sizeof(glm::uint32) +
+         deltas.size() * sizeof(glm::i16vec4);
+}
+
+void MorphTargets::SparseData::Apply(
+    const std::vector<glm::float32>& weights,
+    std::vector<meshdata::Vertex>& vertices) const {
+  std::size_t vertex_count =
+      std::min(vertices.size(), row_starts.empty() ? 0 : row_starts.size() - 1);
+  for (std::size_t v = 0; v < vertex_count; ++v) {
+    for (glm::uint32 entry = row_starts[v]; entry < row_starts[v + 1];
+         ++entry) {
+      const glm::i16vec4& position = deltas[entry * kTexelsPerEntry];
+      const glm::i16vec4& normal = deltas[entry * kTexelsPerEntry + 1];
+      auto target = static_cast<std::size_t>(position.w);
+      glm::float32 weight = target < weights.size() ? weights[target] : 0.0f;
+      vertices[v].position +=
+          glm::vec3(position) * (weight * position_scale);
+      vertices[v].normal += glm::vec3(normal) * (weight * normal_scale);
+    }
+  }
+}
+
+MorphTargets::SparseData MorphTargets::Compress(
+    const std::vector<meshdata::Vertex>& vertices,
+    const std::vector<Target>& targets, glm::float32 tolerance) {
+  SparseData data;
+  data.row_starts.reserve(vertices.size() + 1);
+  for (const auto& target : targets) {
+    data.names.push_back(target.name);
+  }
+
+  // The deltas kept, in row order, before the scales are known.
+  struct Entry {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::int16 target;
+  };
+  std::vector<Entry> entries;
+  glm::float32 max_position = 0.0f;
+  glm::float32 max_normal = 0.0f;
+  for (std::size_t v = 0; v < vertices.size(); ++v) {
+    data.row_starts.push_back(static_cast<glm::uint32>(entries.size()));
+    for (std::size_t t = 0; t < targets.size(); ++t) {
+      Entry entry{glm::vec3(0.0f), glm::vec3(0.0f),
+                  static_cast<glm::int16>(t)};
+      if (v < targets[t].positions.size()) {
+        entry.position = targets[t].positions[v] - vertices[v].position;
+      }
+      if (v < targets[t].normals.size()) {
+        entry.normal = targets[t].normals[v] - vertices[v].normal;
+      }
+      glm::float32 position = MaxComponent(entry.position);
+      glm::float32 normal = MaxComponent(entry.normal);
+      if (position <= tolerance && normal <= tolerance) {
+        continue;
+      }
+      max_position = std::max(max_position, position);
+      max_normal = std::max(max_normal, normal);
+      entries.push_back(entry);
+    }
+  }
+  data.row_starts.push_back(static_cast<glm::uint32>(entries.size()));
+
+  data.position_scale = max_position / 32767.0f;
+  data.normal_scale = max_normal / 32767.0f;
+  data.deltas.reserve(entries.size() * kTexelsPerEntry);
+  for (const auto& entry : entries) {
+    data.deltas.emplace_back(Quantize(entry.position, data.position_scale),
+                             entry.target);
+    data.deltas.emplace_back(Quantize(entry.normal, data.normal_scale), 0);
+  }
+  return data;
+}
+
+void MorphTargets::Prepare(Shader& shader) {
+  GetProgram(shader.GetID());
+}
+
+void MorphTargets::Unbind(Shader& shader) {
+  ProgramUniforms& uniforms = GetProgram(shader.GetID());
+  if (uniforms.morphing) {
+    glUniform1i(uniforms.enabled, GL_FALSE);
+    uniforms.morphing = false;
+  }
+}
+
+void MorphTargets::SetWeightOffset(Shader& shader, glm::int32 offset) {
+  ProgramUniforms& uniforms = GetProgram(shader.GetID());
+  if (uniforms.weight_offset >= 0 && uniforms.weight_offset_value != offset) {
+    glUniform1i(uniforms.weight_offset, offset);
+    uniforms.weight_offset_value = offset;
+  }
+}
+
+MorphTargets::ProgramUniforms& MorphTargets::GetProgram(GLuint program) {
+  for (auto& prepared : programs_) {
+    if (prepared.program == program) {
+      return prepared;
+    }
+  }
+  ProgramUniforms uniforms;
+  uniforms.program = program;
+  uniforms.enabled = glGetUniformLocation(program, "morph_enabled");
+  uniforms.position_scale =
+      glGetUniformLocation(program, "morph_position_scale");
+  // Unlit shaders only morph the positions.
+  uniforms.normal_scale = glGetUniformLocation(program, "morph_normal_scale");
+  uniforms.weight_offset =
+      glGetUniformLocation(program, "morph_weight_offset");
+  uniforms.morphing = false;
+  uniforms.position_scale_value = -1.0f;
+  uniforms.normal_scale_value = -1.0f;
+  uniforms.weight_offset_value = -1;
+  if (uniforms.enabled >= 0) {
+    // The units never change, so the samplers are only set here.
+    glUniform1i(glGetUniformLocation(program, "morph_rows"),
+                static_cast<GLint>(kRowTextureUnit));
+    glUniform1i(glGetUniformLocation(program, "morph_deltas"),
+                static_cast<GLint>(kDeltaTextureUnit));
+    glUniform1i(uniforms.enabled, GL_FALSE);
+  }
+  programs_.push_back(uniforms);
+  return programs_.back();
+}
+
+MorphTargets::MorphTargets(const SparseData& data)
+    : row_buffer_(1, GL_TEXTURE_BUFFER),
+      delta_buffer_(1, GL_TEXTURE_BUFFER),
+      textures_{0, 0},
+      names_(data.names),
+      position_scale_(data.position_scale),
+      normal_scale_(data.normal_scale),
+      byte_size_(data.GetByteSize()) {
+  row_buffer_.Bind();
+  row_buffer_.SetData(data.row_starts.data(),
+                      data.row_starts.size() * sizeof(glm::uint32),
+                      GL_STATIC_DRAW);
+  delta_buffer_.Bind();
+  delta_buffer_.SetData(data.deltas.data(),
+                        data.deltas.size() * sizeof(glm::i16vec4),
+                        GL_STATIC_DRAW);
+  delta_buffer_.UnBind();
+
+  glGenTextures(2, textures_);
+  glBindTexture(GL_TEXTURE_BUFFER, textures_[0]);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, row_buffer_.GetBufferId());
+  glBindTexture(GL_TEXTURE_BUFFER, textures_[1]);
+  glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA16I, delta_buffer_.GetBufferId());
+  glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+MorphTargets::~MorphTargets() {
+  glDeleteTextures(2, textures_);
+}
+
+void MorphTargets::Bind(Shader& shader) const {
+  ProgramUniforms& uniforms = GetProgram(shader.GetID());
+  // Lit and unlit shaders without morphing draw the same meshes.
+  if (uniforms.enabled < 0) {
+    return;
+  }
+  glActiveTexture(GL_TEXTURE0 + kRowTextureUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, textures_[0]);
+  glActiveTexture(GL_TEXTURE0 + kDeltaTextureUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, textures_[1]);
+  glActiveTexture(GL_TEXTURE0);
+  if (!uniforms.morphing) {
+    glUniform1i(uniforms.enabled, GL_TRUE);
+    uniforms.morphing = true;
+  }
+  if (uniforms.position_scale_value != position_scale_) {
+    glUniform1f(uniforms.position_scale, position_scale_);
+    uniforms.position_scale_value = position_scale_;
+  }
+  if (uniforms.normal_scale >= 0 &&
+      uniforms.normal_scale_value != normal_scale_) {
+    glUniform1f(uniforms.normal_scale, normal_scale_);
+    uniforms.normal_scale_value = normal_scale_;
+  }
+}
+
+glm::uint32 MorphTargets::GetTargetCount() const {
+  return static_cast<glm::uint32>(names_.size());
+}
+
+const std::vector<std::string>& MorphTargets::GetTargetNames() const {
+  return names_;
+}
+
+glm::int32 MorphTargets::FindTarget(const std::string& name) const {
+  auto target = std::find(names_.begin(), names_.end(), name);
+  if (target == names_.end()) {
+    return -1;
+  }
+  return static_cast<glm::int32>(target - names_.begin());
+}
+
+glm::uint64 MorphTargets::GetByteSize() const {
+  return byte_size_;
+}
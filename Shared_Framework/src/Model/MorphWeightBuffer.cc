@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/MorphWeightBuffer.h"
+#include <algorithm>
+
+using namespace model;
+
+MorphWeightBuffer::MorphWeightBuffer()
+    : buffer_(1, GL_TEXTURE_BUFFER), texture_(0), capacity_(0) {
+  glGenTextures(1, &texture_);
+}
+
+MorphWeightBuffer::~MorphWeightBuffer() {
+  glDeleteTextures(1, &texture_);
+}
+
+void MorphWeightBuffer::Clear() {
+  weights_.clear();
+}
+
+glm::uint32 MorphWeightBuffer::Add(const std::vector<glm::float32>& weights,
+                                   glm::uint32 count) {
+  auto offset = static_cast<glm::uint32>(weights_.size());
+  auto copied = std::min<std::size_t>(weights.size(), count);
+  weights_.insert(weights_.end(), weights.begin(), weights.begin() + copied);
+  weights_.resize(offset + count, 0.0f);
+  return offset;
+}
+
+void MorphWeightBuffer::Upload() {
+  if (weights_.empty()) {
+    return;
+  }
+  auto count = static_cast<glm::uint32>(weights_.size());
+  bool grown = count > capacity_;
+  if (grown) {
+    // Grow with headroom, as BonePaletteBuffer does.
+    capacity_ = count + count / 2;
+  }
+  buffer_.Bind();
+  // Orphaning hands out fresh memory instead of waiting for draws that still
+  // read last frame's weights.
+  buffer_.SetData(nullptr, capacity_ * sizeof(glm::float32), GL_STREAM_DRAW);
+  if (grown) {
+    glBindTexture(GL_TEXTURE_BUFFER, texture_);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, buffer_.GetBufferId());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+  }
+  buffer_.SetSubData(0, count * sizeof(glm::float32), weights_.data());
+  buffer_.UnBind();
+}
+
+void MorphWeightBuffer::Bind(Shader& shader) const {
+  glActiveTexture(GL_TEXTURE0 + kTextureUnit);
+  glBindTexture(GL_TEXTURE_BUFFER, texture_);
+  glActiveTexture(GL_TEXTURE0);
+  shader.SetInt("morph_weights", static_cast<GLint>(kTextureUnit));
+}
+
+glm::uint32 MorphWeightBuffer::GetWeightCount() const {
+  return static_cast<glm::uint32>(weights_.size());
+}
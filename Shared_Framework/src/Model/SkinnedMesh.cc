@@ -0,0 +1,73 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/SkinnedMesh.h"
+#include <cstddef>
+
+using namespace model;
+
+SkinnedMesh::SkinnedMesh(Mesh& source)
+    : source_(&source), vbo_(1, GL_ARRAY_BUFFER) {
+  vao_.Bind();
+  vbo_.Bind();
+  // Written by the GPU every frame and only read by the GPU.
+  vbo_.SetData(nullptr,
+               static_cast<GLsizeiptr>(source.GetVertexCount() *
+                                       sizeof(SkinnedMesh::Vertex)),
+               GL_DYNAMIC_COPY);
+  // The indices do not change with the pose, so they are shared.
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, source.GetIndexBufferId());
+  vao_.AddBuffer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedMesh::Vertex),
+                 (void*)offsetof(SkinnedMesh::Vertex, position));
+  vao_.AddBuffer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedMesh::Vertex),
+                 (void*)offsetof(SkinnedMesh::Vertex, normal));
+  vao_.AddBuffer(2, 2, GL_FLOAT, GL_FALSE, sizeof(SkinnedMesh::Vertex),
+                 (void*)offsetof(SkinnedMesh::Vertex, tex_coords));
+  vao_.AddBuffer(3, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedMesh::Vertex),
+                 (void*)offsetof(SkinnedMesh::Vertex, tangent));
+  vao_.AddBuffer(4, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedMesh::Vertex),
+                 (void*)offsetof(SkinnedMesh::Vertex, bitangent));
+  vao_.UnBind();
+  vbo_.UnBind();
+}
+
+void SkinnedMesh::Draw(Shader& shader, glm::uint32 lod_level) {
+  shader.Use();
+  source_->GetMaterial().Bind(shader);
+  DrawElements(lod_level);
+
+  // Always good practice to set everything back to defaults once configured.
+  glActiveTexture(GL_TEXTURE0);
+  shader.UnUse();
+}
+
+void SkinnedMesh::DrawElements(glm::uint32 lod_level) const {
+  vao_.Bind();
+  source_->DrawElements(lod_level);
+  vao_.UnBind();
+}
+
+Mesh& SkinnedMesh::GetSource() const {
+  return *source_;
+}
+
+GLuint SkinnedMesh::GetVertexBufferId() const {
+  return vbo_.GetBufferId();
+}
+
+const VertexArray& SkinnedMesh::GetVao() const {
+  return vao_;
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "Model/SkinningPass.h"
+#include "FilePathSystem.h"
+#include "OpenGLStateManager.h"
+
+using namespace model;
+
+SkinningPass::SkinningPass() : pending_(false) {
+  if (OpenGLStateManager::GetInstance().CheckOpenGLVersion(4, 3)) {
+    shader_ = std::make_unique<Shader>(
+        FilePathSystem::GetInstance().GetResourcesPath("glsl/skinning.comp"));
+  }
+}
+
+bool SkinningPass::IsSupported() const {
+  return shader_ != nullptr && !shader_->IsEmpty();
+}
+
+void SkinningPass::Skin(SkinnedMesh& target, const BonePaletteBuffer& palettes,
+                        glm::uint32 palette_offset,
+                        const MorphWeightBuffer* morph_weights,
+                        glm::int32 morph_weight_offset) {
+  if (!IsSupported()) {
+    return;
+  }
+  const Mesh& source = target.GetSource();
+  glm::uint32 vertex_count = source.GetVertexCount();
+  if (vertex_count == 0) {
+    return;
+  }
+  shader_->Use();
+  palettes.Bind(*shader_);
+  shader_->SetInt("bone_offset", static_cast<GLint>(palette_offset));
+  shader_->SetInt("palette_format", static_cast<GLint>(palettes.GetFormat()));
+  shader_->SetInt("vertex_count", static_cast<GLint>(vertex_count));
+  const MorphTargets* morph_targets = source.GetMorphTargets();
+  if (morph_targets != nullptr && morph_weights != nullptr &&
+      morph_weight_offset >= 0) {
+    morph_targets->Bind(*shader_);
+    morph_weights->Bind(*shader_);
+    MorphTargets::SetWeightOffset(*shader_, morph_weight_offset);
+  } else {
+    MorphTargets::Unbind(*shader_);
+  }
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, source.GetVertexBufferId());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, target.GetVertexBufferId());
+  shader_->SetDispatchCompute((vertex_count + kGroupSize - 1) / kGroupSize, 1,
+                              1);
+  pending_ = true;
+}
+
+void SkinningPass::Finish() {
+  if (!pending_) {
+    return;
+  }
+  shader_->SetMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, 0);
+  shader_->UnUse();
+  pending_ = false;
+}
@@ -17,6 +17,7 @@
 #include "OpenGLWindow.h"
 #include "LoggerSystem.h"
 #include "OpenGLException.h"
+#include "FrameArena.h"
 #include <cstdlib>
 #include "ImGui/OpenGLLogMessage.h"
 
@@ -218,6 +219,8 @@ void OpenGLWindow::MainLoop() {
     glfwPollEvents();
     render_timer_.StopTimer();
     render_timer_.FrameEnd();
+    // Nothing allocated for this frame is used past this point.
+    FrameArena::GetInstance().Reset();
   }
 }
 
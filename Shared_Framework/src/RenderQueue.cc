@@ -0,0 +1,207 @@
+/*******************************************************************************
+ * Copyright 2024 QuiMir
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ******************************************************************************/
+
+#include "RenderQueue.h"
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+namespace {
+constexpr glm::uint64 kProgramBits = 12;
+constexpr glm::uint64 kMaterialBits = 14;
+constexpr glm::uint64 kVaoBits = 12;
+constexpr glm::uint64 kDepthBits = 24;
+constexpr glm::uint64 kPassShift = 62;
+
+constexpr glm::uint64 Mask(glm::uint64 bits) {
+  return (glm::uint64(1) << bits) - 1;
+}
+}  // namespace
+
+void RenderQueue::Begin(const glm::mat4& view, glm::float32 far_plane) {
+  view_ = view;
+  far_plane_ = far_plane;
+  items_.clear();
+  keys_.clear();
+  material_ids_.clear();
+}
+
+void RenderQueue::Submit(Pass pass, Shader& shader, model::Mesh& mesh,
+                         const glm::mat4& model_matrix,
+                         glm::uint32 lod_level,
+                         glm::int32 morph_weight_offset) {
+  GLuint vao = mesh.GetVao().GetVaoId();
+  keys_.push_back(MakeKey(pass, shader.GetID(), &mesh.GetMaterial(), vao,
+                          model_matrix));
+  items_.push_back({&shader, &mesh, vao, lod_level, morph_weight_offset, pass,
+                    model_matrix, nullptr});
+}
+
+void RenderQueue::Submit(Pass pass, Shader& shader, GLuint vao,
+                         const glm::mat4& model_matrix,
+                         std::function<void(Shader&)> draw) {
+  keys_.push_back(MakeKey(pass, shader.GetID(), nullptr, vao, model_matrix));
+  items_.push_back(
+      {&shader, nullptr, vao, 0, -1, pass, model_matrix, std::move(draw)});
+}
+
+glm::uint64 RenderQueue::MakeKey(Pass pass, GLuint program,
+                                 const void* material, GLuint vao,
+                                 const glm::mat4& model_matrix) {
+  // Quantize the view space distance of the item origin.
+  glm::float32 distance = -(view_ * model_matrix[3]).z;
+  glm::float32 normalized =
+      far_plane_ > 0.0f ? glm::clamp(distance / far_plane_, 0.0f, 1.0f) : 0.0f;
+  auto depth = static_cast<glm::uint64>(
+      normalized * static_cast<glm::float32>(Mask(kDepthBits)));
+
+  glm::uint64 material_id = 0;
+  if (material != nullptr) {
+    auto inserted = material_ids_.emplace(
+        material, static_cast<glm::uint32>(material_ids_.size() + 1));
+    material_id = inserted.first->second & Mask(kMaterialBits);
+  }
+  glm::uint64 program_id = program & Mask(kProgramBits);
+  glm::uint64 vao_id = vao & Mask(kVaoBits);
+  auto pass_id = static_cast<glm::uint64>(pass);
+
+  if (pass == Pass::kBlended) {
+    // Farthest first, state only breaks ties.
+    return pass_id << kPassShift |
+           (Mask(kDepthBits) - depth) << (kProgramBits + kMaterialBits +
+                                          kVaoBits) |
+           program_id << (kMaterialBits + kVaoBits) |
+           material_id << kVaoBits | vao_id;
+  }
+  return pass_id << kPassShift |
+         program_id << (kMaterialBits + kVaoBits + kDepthBits) |
+         material_id << (kVaoBits + kDepthBits) | vao_id << kDepthBits |
+         depth;
+}
+
+void RenderQueue::Flush() {
+  statistics_ = Statistics();
+  statistics_.items = static_cast<glm::uint32>(items_.size());
+  RadixSort(keys_, order_, scratch_);
+
+  Shader* current_shader = nullptr;
+  model::Material* current_material = nullptr;
+  GLuint current_vao = 0;
+  bool vao_bound = false;
+  bool blending = false;
+
+  for (auto index : order_) {
+    Item& item = items_[index];
+    if (item.pass == Pass::kBlended && !blending) {
+      glEnable(GL_BLEND);
+      glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+      glDepthMask(GL_FALSE);
+      blending = true;
+    }
+    if (item.shader != current_shader) {
+      item.shader->Use();
+      current_shader = item.shader;
+      // A new program may not have its samplers set up yet.
+      current_material = nullptr;
+      ++statistics_.program_changes;
+    }
+    if (item.mesh != nullptr && &item.mesh->GetMaterial() != current_material) {
+      current_material = &item.mesh->GetMaterial();
+      current_material->Bind(*current_shader);
+      ++statistics_.material_changes;
+    }
+    if (!vao_bound || item.vao != current_vao) {
+      glBindVertexArray(item.vao);
+      current_vao = item.vao;
+      vao_bound = true;
+      ++statistics_.vao_changes;
+    }
+
+    current_shader->SetMat4("model", item.model_matrix);
+    if (item.mesh != nullptr) {
+      item.mesh->BindMorphTargets(*current_shader);
+      if (item.morph_weight_offset >= 0) {
+        model::MorphTargets::SetWeightOffset(*current_shader,
+                                             item.morph_weight_offset);
+      }
+      item.mesh->DrawElements(item.lod_level);
+    } else if (item.draw) {
+      item.draw(*current_shader);
+      // The callback may have bound its own textures on the material units.
+      current_material = nullptr;
+    }
+    ++statistics_.draw_calls;
+  }
+
+  // Always good practice to set everything back to defaults once configured.
+  if (vao_bound) {
+    glBindVertexArray(0);
+  }
+  if (blending) {
+    glDepthMask(GL_TRUE);
+    glDisable(GL_BLEND);
+  }
+  if (current_shader != nullptr) {
+    glActiveTexture(GL_TEXTURE0);
+    current_shader->UnUse();
+  }
+  items_.clear();
+  keys_.clear();
+  material_ids_.clear();
+}
+
+const RenderQueue::Statistics& RenderQueue::GetStatistics() const {
+  return statistics_;
+}
+
+void RenderQueue::RadixSort(const std::vector<glm::uint64>& keys,
+                            std::vector<glm::uint32>& order,
+                            std::vector<glm::uint32>& scratch) {
+  const std::size_t count = keys.size();
+  order.resize(count);
+  scratch.resize(count);
+  std::iota(order.begin(), order.end(), 0u);
+  if (count < 2) {
+    return;
+  }
+
+  // One read of the keys builds the histograms of all eight digits.
+  constexpr int kDigits = 8;
+  glm::uint32 histograms[kDigits][256] = {};
+  for (auto key : keys) {
+    for (int digit = 0; digit < kDigits; ++digit) {
+      ++histograms[digit][(key >> (digit * 8)) & 0xff];
+    }
+  }
+
+  for (int digit = 0; digit < kDigits; ++digit) {
+    glm::uint32* histogram = histograms[digit];
+    // Every key shares this digit, the pass would not move anything.
+    if (histogram[(keys[0] >> (digit * 8)) & 0xff] == count) {
+      continue;
+    }
+    glm::uint32 offset = 0;
+    for (int bucket = 0; bucket < 256; ++bucket) {
+      glm::uint32 bucket_count = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucket_count;
+    }
+    for (auto index : order) {
+      scratch[histogram[(keys[index] >> (digit * 8)) & 0xff]++] = index;
+    }
+    order.swap(scratch);
+  }
+}
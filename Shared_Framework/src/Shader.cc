@@ -103,6 +103,10 @@ Shader::Shader(const std::string& vertex_path, const std::string& fragment_path,
               tess_evaluation_path, compute_path);
 }
 
+Shader::Shader(const std::string& compute_path) : id_(0) {
+  Initialized(string(), string(), string(), string(), string(), compute_path);
+}
+
 void Shader::Use() const {
   if (this->IsEmpty()) {
     OpenGLLogMessage::GetInstance().AddLog(
@@ -390,8 +394,13 @@ void Shader::Initialized(const string& vertex_path, const string& fragment_path,
     string tess_evaluation_code = ReadShaderFile(tess_evaluation_path);
 
     // 2. compile shaders
-    GLuint vertex = CompileShader(vertex_code, GL_VERTEX_SHADER);
-    GLuint fragment = CompileShader(fragment_code, GL_FRAGMENT_SHADER);
+    // A compute program has neither of them.
+    GLuint vertex = vertex_path.empty()
+                        ? 0
+                        : CompileShader(vertex_code, GL_VERTEX_SHADER);
+    GLuint fragment = fragment_path.empty()
+                          ? 0
+                          : CompileShader(fragment_code, GL_FRAGMENT_SHADER);
     GLuint geometry = geometry_path.empty()
                           ? 0
                           : CompileShader(geometry_code, GL_GEOMETRY_SHADER);
@@ -409,8 +418,12 @@ void Shader::Initialized(const string& vertex_path, const string& fragment_path,
 
     // shader Program
     this->id_ = glCreateProgram();
-    glAttachShader(this->id_, vertex);
-    glAttachShader(this->id_, fragment);
+    if (vertex) {
+      glAttachShader(this->id_, vertex);
+    }
+    if (fragment) {
+      glAttachShader(this->id_, fragment);
+    }
     if (geometry) {
       glAttachShader(this->id_, geometry);
     }
@@ -426,8 +439,12 @@ void Shader::Initialized(const string& vertex_path, const string& fragment_path,
     glLinkProgram(this->id_);
     Shader::CheckCompileErrors(this->id_, ShaderErrorType::kProgram);
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    if (vertex) {
+      glDeleteShader(vertex);
+    }
+    if (fragment) {
+      glDeleteShader(fragment);
+    }
     if (geometry) {
       glDeleteShader(geometry);
     }
@@ -43,7 +43,7 @@ VertexArray::~VertexArray() {
 void VertexArray::Bind() const {
   glBindVertexArray(vao_id_);
 }
-void VertexArray::UnBind() {
+void VertexArray::UnBind() const {
   glBindVertexArray(0);
 }
 void VertexArray::AddBuffer(GLuint index, GLint size, GLenum type,
@@ -58,6 +58,9 @@ void VertexArray::AddIntBuffer(GLuint index, GLint size, GLenum type,
   glVertexAttribIPointer(index, size, type, stride, pointer);
   glEnableVertexAttribArray(index);
 }
+void VertexArray::SetAttribDivisor(GLuint index, GLuint divisor) const {
+  glVertexAttribDivisor(index, divisor);
+}
 GLuint VertexArray::GetVaoId() const {
   return vao_id_;
 }
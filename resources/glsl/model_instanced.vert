@@ -0,0 +1,17 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// Per instance model matrix, see model::InstanceBuffer.
+layout (location = 7) in mat4 aInstanceMatrix;
+
+out vec2 TexCoords;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+  TexCoords = aTexCoords;
+  gl_Position = projection * view * aInstanceMatrix * vec4(aPos, 1.0);
+}
@@ -17,11 +17,12 @@
 #include "CascadedShadowMapping.h"
 
 using namespace std;
-std::vector<glm::vec4> CascadedShadowMapping::GetFrustumCornersWorldSpace(
+FrameVector<glm::vec4> CascadedShadowMapping::GetFrustumCornersWorldSpace(
     const glm::mat4& projection, const glm::mat4& view) {
   const auto inv = glm::inverse(projection * view);
 
-  vector<glm::vec4> frustum_corners;
+  FrameVector<glm::vec4> frustum_corners;
+  frustum_corners.reserve(8);
 
   for (unsigned int x = 0; x < 2; ++x) {
     for (unsigned int y = 0; y < 2; ++y) {
@@ -18,11 +18,12 @@
 #define CMAKE_OPEN_SRC_ADVANCED_LIGHTING_CASCADEDSHADOWMAPPING_H_
 
 #include <vector>
+#include "FrameArena.h"
 #include "Shader.h"
 
 class CascadedShadowMapping {
  public:
-  std::vector<glm::vec4> GetFrustumCornersWorldSpace(
+  FrameVector<glm::vec4> GetFrustumCornersWorldSpace(
       const glm::mat4& projection, const glm::mat4& view);
 
  private:
@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include "ImGuiMainWindow.h"
+#include "FrameArena.h"
 #include "OpenGLException.h"
 #include "ImGui/Fonts/Language.h"
 
@@ -69,6 +70,10 @@ void ImGuiMainWindow::ShowDashboardWindow(bool& is_open,
 
     ImGui::Text("FPS : %.1f (ds : %.3f ms/frame)", render_timer.GetFPS(),
                 render_timer.GetRenderDelay());
+    const auto& arena = FrameArena::GetInstance().GetLastFrameStats();
+    ImGui::Text("Frame arena : %zu allocations, %zu bytes, %zu on heap",
+                arena.allocation_count, arena.used_bytes,
+                arena.heap_allocation_count);
     if (ImGui::BeginPopupContextWindow()) {
       if (ImGui::MenuItem("Custom", nullptr, corner == -1))
         corner = -1;
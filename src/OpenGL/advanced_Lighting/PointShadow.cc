@@ -16,6 +16,15 @@
 
 #include "PointShadow.h"
 #include "FilePathSystem.h"
+#include "FrameArena.h"
+
+namespace {
+// Built once, so binding the faces does not format strings every frame.
+const std::string kShadowMatrixNames[6] = {
+    "shadow_matrices[0]", "shadow_matrices[1]", "shadow_matrices[2]",
+    "shadow_matrices[3]", "shadow_matrices[4]", "shadow_matrices[5]"};
+}  // namespace
+
 PointShadow::PointShadow(GLint window_width, GLint window_height,
                          GLint shadow_width, GLint shadow_height)
     : window_width_(window_width),
@@ -104,7 +113,8 @@ void PointShadow::Bind(float near_plane, float far_plane, glm::vec3& light_pos,
   glm::mat4 shadow_projection = glm::perspective(
       glm::radians(90.0f), (float)shadow_width_ / (float)shadow_height_,
       near_plane, far_plane);
-  std::vector<glm::mat4> shadow_transforms;
+  FrameVector<glm::mat4> shadow_transforms;
+  shadow_transforms.reserve(6);
   shadow_transforms.push_back(
       shadow_projection * glm::lookAt(light_pos,
                                       light_pos + glm::vec3(1.0f, 0.0f, 0.0f),
@@ -138,7 +148,7 @@ void PointShadow::Bind(float near_plane, float far_plane, glm::vec3& light_pos,
   glClear(GL_DEPTH_BUFFER_BIT);
   simple_depth_shader_->Use();
   for (unsigned int i = 0; i < 6; ++i) {
-    simple_depth_shader_->SetMat4("shadow_matrices[" + std::to_string(i) + "]",
+    simple_depth_shader_->SetMat4(kShadowMatrixNames[i],
                                   shadow_transforms[i]);
   }
   simple_depth_shader_->SetFloat("far_plane", far_plane);
@@ -18,6 +18,7 @@
 #include <thread>
 #include "FilePathSystem.h"
 #include "LoadImage.h"
+#include "LoggerSystem.h"
 #include "OpenGLMessage.h"
 
 bool OpenGLMainWindow::first_mouse_ = true;
@@ -36,8 +37,34 @@ void OpenGLMainWindow::InitializeGL() {
   this->shader_ =
       new Shader(FilePathSystem::GetInstance().GetExecutablePath("model.vert"),
                  FilePathSystem::GetInstance().GetExecutablePath("model.frag"));
-  this->model_ = new model::Model(FilePathSystem::GetInstance().GetPath(
-      "resources/objects/cyborg/cyborg.obj"));
+  model::Model::LoadOptions options;
+  options.lod_count = 4;
+  // Nothing reads the geometry back, so only the GPU copy is needed.
+  options.cpu_data = model::Mesh::CpuDataPolicy::kRelease;
+  // Import on a worker thread, the window keeps rendering meanwhile.
+  this->load_task_ = model::Model::LoadAsync(
+      FilePathSystem::GetInstance().GetPath(
+          "resources/objects/cyborg/cyborg.obj"),
+      options);
+
+  // The twelve edges of a unit cube, drawn as lines.
+  float placeholder_vertices[] = {
+      -0.5f, -0.5f, -0.5f, 0.5f,  -0.5f, -0.5f, 0.5f,  -0.5f, -0.5f,
+      0.5f,  0.5f,  -0.5f, 0.5f,  0.5f,  -0.5f, -0.5f, 0.5f,  -0.5f,
+      -0.5f, 0.5f,  -0.5f, -0.5f, -0.5f, -0.5f, -0.5f, -0.5f, 0.5f,
+      0.5f,  -0.5f, 0.5f,  0.5f,  -0.5f, 0.5f,  0.5f,  0.5f,  0.5f,
+      0.5f,  0.5f,  0.5f,  -0.5f, 0.5f,  0.5f,  -0.5f, 0.5f,  0.5f,
+      -0.5f, -0.5f, 0.5f,  -0.5f, -0.5f, -0.5f, -0.5f, -0.5f, 0.5f,
+      0.5f,  -0.5f, -0.5f, 0.5f,  -0.5f, 0.5f,  0.5f,  0.5f,  -0.5f,
+      0.5f,  0.5f,  0.5f,  -0.5f, 0.5f,  -0.5f, -0.5f, 0.5f,  0.5f};
+  placeholder_vao_.Bind();
+  placeholder_vbo_.Bind();
+  placeholder_vbo_.SetData(&placeholder_vertices, sizeof(placeholder_vertices),
+                           GL_STATIC_DRAW);
+  placeholder_vao_.AddBuffer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float),
+                             (void*)0);
+  placeholder_vao_.UnBind();
+  placeholder_vbo_.UnBind();
 }
 void OpenGLMainWindow::ResizeGL(int width, int height) {
   glViewport(0, 0, width, height);
@@ -56,6 +83,38 @@ void OpenGLMainWindow::PaintGL() {
   shader_->SetMat4("projection", projection);
   shader_->SetMat4("view", view);
 
+  if (model_ == nullptr && load_task_ != nullptr && load_task_->Update()) {
+    model_ = load_task_->GetModel();
+    load_task_.reset();
+    if (model_ != nullptr) {
+      auto report = model_->GetMemoryReport();
+      LoggerSystem::GetInstance().Log(
+          LoggerSystem::Level::kInfo,
+          "Model geometry: " + std::to_string(report.cpu_bytes) +
+              " bytes in system memory, " + std::to_string(report.gpu_bytes) +
+              " bytes on the GPU.");
+    }
+  }
+  if (model_ == nullptr) {
+    // Grow the placeholder with the share of the work done.
+    float done = 0.0f;
+    if (load_task_ != nullptr) {
+      auto progress = load_task_->GetProgress();
+      auto meshes = static_cast<float>(progress.meshes_total);
+      auto bytes = static_cast<float>(progress.bytes_total);
+      done = 0.5f * (meshes > 0.0f ? progress.meshes_parsed / meshes : 0.0f) +
+             0.5f * (bytes > 0.0f ? progress.bytes_uploaded / bytes : 0.0f);
+    }
+    auto placeholder = glm::scale(glm::mat4(1.0f),
+                                  glm::vec3(0.25f + 0.75f * done));
+    shader_->SetMat4("model", placeholder);
+    placeholder_vao_.Bind();
+    glDrawArrays(GL_LINES, 0, 24);
+    placeholder_vao_.UnBind();
+    shader_->UnUse();
+    return;
+  }
+
   // render the loaded model
   auto model = glm::mat4(1.0f);
   model = glm::translate(
@@ -66,8 +125,10 @@ void OpenGLMainWindow::PaintGL() {
       model,
       glm::vec3(1.0f, 1.0f,
                 1.0f));  // it's a bit too big for our scene, so scale it down
-  shader_->SetMat4("model", model);
-  model_->Draw(*shader_);
+  render_queue_.Begin(view, camera_.GetFarPlane());
+  model_->Submit(render_queue_, *shader_, model, view, projection,
+                 static_cast<glm::float32>(GetHeight()), mesh_lods_);
+  render_queue_.Flush();
   shader_->UnUse();
 }
 void OpenGLMainWindow::ProcessInput(GLFWwindow* window) {
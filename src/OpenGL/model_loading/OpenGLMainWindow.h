@@ -17,10 +17,17 @@
 #ifndef CMAKE_OPEN_SRC_MODEL_LOADING_OPENGLMAINWINDOW_H_
 #define CMAKE_OPEN_SRC_MODEL_LOADING_OPENGLMAINWINDOW_H_
 
+#include <memory>
+#include <vector>
+
+#include "Buffers.h"
 #include "Camera.h"
 #include "OpenGLWindow.h"
+#include "RenderQueue.h"
 #include "Shader.h"
+#include "VertexArray.h"
 #include "Model/Model.h"
+#include "Model/ModelLoadTask.h"
 
 class OpenGLMainWindow : public OpenGLWindow {
  public:
@@ -58,7 +65,16 @@ class OpenGLMainWindow : public OpenGLWindow {
   static GLdouble last_y_;
 
   Shader* shader_;
-  model::Model* model_;
+  std::shared_ptr<model::ModelLoadTask> load_task_;
+  std::shared_ptr<model::Model> model_;
+  // The level of detail each mesh of model_ was drawn at last.
+  std::vector<glm::uint32> mesh_lods_;
+  // Sorts the meshes of the frame by program, material and vertex array.
+  RenderQueue render_queue_;
+
+  // Wireframe cube drawn until the model is uploaded.
+  VertexArray placeholder_vao_;
+  Buffers placeholder_vbo_;
 };
 
 #endif  //CMAKE_OPEN_SRC_MODEL_LOADING_OPENGLMAINWINDOW_H_
@@ -17,6 +17,9 @@
 #include "SkeletalAnimation.h"
 #include "FilePathSystem.h"
 #include "LoadImage.h"
+#include "LoggerSystem.h"
+#include "Frustum.h"
+#include "Model/ModelLibrary.h"
 
 using namespace std;
 using namespace model;
@@ -61,16 +64,81 @@ void SkeletalAnimation::InitializeGL() {
   last_x = GetWidth() / 2.0f;
   last_y = GetHeight() / 2.0f;
 
+  // The skinning shader has to read the palette format of bone_palettes_.
+  const char* skinning_shader = "animation_model.vert";
+  if (kPaletteFormat == PaletteFormat::kMatrix3x4) {
+    skinning_shader = "animation_model_3x4.vert";
+  } else if (kPaletteFormat == PaletteFormat::kDualQuaternion) {
+    skinning_shader = "animation_model_dq.vert";
+  }
   shader_ = new Shader(
-      FilePathSystem::GetInstance().GetExecutablePath("animation_model.vert"),
+      FilePathSystem::GetInstance().GetExecutablePath(skinning_shader),
+      FilePathSystem::GetInstance().GetExecutablePath("animation_model.frag"));
+  shader_->Use();
+  MorphTargets::Prepare(*shader_);
+  shader_->UnUse();
+  auto model_path = FilePathSystem::GetInstance().GetPath(
+      "resources/objects/vampire/dancing_vampire.dae");
+  // One import provides both the meshes and the animation clips.
+  auto model = ModelLibrary::GetInstance().LoadAnimated(model_path);
+  auto animation =
+      ModelLibrary::GetInstance().LoadAnimation(model_path, model);
+  const auto& compression = animation->GetCompressionReport();
+  LoggerSystem::GetInstance().Log(
+      LoggerSystem::Level::kInfo,
+      "Animation keys: " + std::to_string(compression.stored_keys) + " of " +
+          std::to_string(compression.source_keys) + " kept, " +
+          std::to_string(compression.GetRatio()) +
+          "x smaller, max rotation error " +
+          std::to_string(compression.max_rotation_error) + " rad.");
+  for (int i = 0; i < 3; ++i) {
+    instances_.emplace_back(model);
+    auto& instance = instances_.back();
+    auto transform = glm::mat4(1.0f);
+    transform = glm::translate(
+        transform, glm::vec3(static_cast<float>(i - 1), -0.4f, 0.0f));
+    transform = glm::scale(transform, glm::vec3(0.5f, 0.5f, 0.5f));
+    instance.SetTransform(transform);
+    instance.SetAnimation(animation);
+    // Offset the dancers so they do not move in lockstep.
+    instance.UpdateAnimation(static_cast<double>(i) * 0.5);
+  }
+  skinned_shader_ = new Shader(
+      FilePathSystem::GetInstance().GetExecutablePath("skinned_model.vert"),
+      FilePathSystem::GetInstance().GetExecutablePath("animation_model.frag"));
+  if (skinning_.IsSupported()) {
+    for (const auto& instance : instances_) {
+      skinned_meshes_.emplace_back();
+      for (auto* mesh : instance.GetModel()->GetMeshes()) {
+        skinned_meshes_.back().push_back(std::make_unique<SkinnedMesh>(*mesh));
+      }
+    }
+  }
+
+  baked_shader_ = new Shader(
+      FilePathSystem::GetInstance().GetExecutablePath(
+          "animation_model_baked.vert"),
       FilePathSystem::GetInstance().GetExecutablePath("animation_model.frag"));
-  model_ = new Model(FilePathSystem::GetInstance().GetPath(
-      "resources/objects/vampire/dancing_vampire.dae"));
-  animation_ =
-      new Animation(FilePathSystem::GetInstance().GetPath(
-                        "resources/objects/vampire/dancing_vampire.dae"),
-                    model_);
-  animator_ = new Animator(animation_);
+  crowd_model_ = model;
+  baked_animation_ = std::make_unique<BakedAnimation>(animation, 30.0f);
+  vector<glm::mat4> crowd_transforms;
+  vector<glm::vec4> crowd_animations;
+  for (int row = 0; row < 10; ++row) {
+    for (int column = 0; column < 10; ++column) {
+      auto transform = glm::translate(
+          glm::mat4(1.0f),
+          glm::vec3(static_cast<float>(column) - 4.5f, -0.4f,
+                    -2.0f - static_cast<float>(row)));
+      transform = glm::scale(transform, glm::vec3(0.5f, 0.5f, 0.5f));
+      crowd_transforms.push_back(transform);
+      // A different start time and a slightly different speed each.
+      auto index = static_cast<float>(row * 10 + column);
+      crowd_animations.emplace_back(0.37f * index,
+                                    0.9f + 0.02f * static_cast<float>(column),
+                                    0.0f, 0.0f);
+    }
+  }
+  crowd_instances_.SetTransforms(crowd_transforms, crowd_animations);
   cube_map_shader_ = new Shader(
       FilePathSystem::GetInstance().GetResourcesPath("glsl/cube_maps.vert"),
       FilePathSystem::GetInstance().GetResourcesPath("glsl/cube_maps.frag"));
@@ -105,36 +173,87 @@ void SkeletalAnimation::PaintGL() {
   float current_time = glfwGetTime();
   delta_time = current_time - last_frame;
   last_frame = current_time;
-  animator_->UpdateAnimation(this->GetRenderTimer().ElapsedSeconds() * 10.0f);
+  auto projection = camera_.GetProjectionMatrix(GetWidth(), GetHeight());
+  auto view = camera_.GetViewMatrix();
+  // Distant dancers are sampled less often, hidden ones only keep time. The
+  // posed box of the last frame is used, so a dancer reaching into view
+  // wakes up.
+  Frustum frustum(projection * view);
+  animators_.clear();
+  for (auto& instance : instances_) {
+    AxisAlignedBox bounds = instance.GetBounds();
+    glm::float32 distance =
+        glm::length(bounds.GetCenter() - camera_.GetPosition());
+    instance.GetAnimator()->SetLod(animation_lod_.Select(
+        distance, frustum.IntersectsBox(bounds.min, bounds.max)));
+    animators_.push_back(instance.GetAnimator());
+  }
+  // Blend shapes, on models that have any, ease in and out.
+  morph_weights_.Clear();
+  for (std::size_t i = 0; i < instances_.size(); ++i) {
+    auto& instance = instances_[i];
+    glm::uint32 target_count = instance.GetModel()->GetMorphTargetCount();
+    if (target_count == 0) {
+      continue;
+    }
+    instance.SetMorphWeight(0, 0.5f + 0.5f * glm::sin(current_time + i));
+    instance.SetMorphWeightOffset(
+        morph_weights_.Add(instance.GetMorphWeights(), target_count));
+  }
+  morph_weights_.Upload();
+  bone_palettes_.Update(animators_,
+                        this->GetRenderTimer().ElapsedSeconds() * 10.0f);
+  for (std::size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i].SetPaletteOffset(bone_palettes_.GetOffset(i));
+  }
+  // Skinned once here, every later pass draws the posed vertices.
+  for (std::size_t i = 0; i < skinned_meshes_.size(); ++i) {
+    for (auto& posed : skinned_meshes_[i]) {
+      skinning_.Skin(*posed, bone_palettes_, bone_palettes_.GetOffset(i),
+                     &morph_weights_, instances_[i].GetMorphWeightOffset());
+    }
+  }
+  skinning_.Finish();
 
   glClearColor(0.05f, 0.05f, 0.05f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  shader_->Use();
+  if (!skinned_meshes_.empty()) {
+    skinned_shader_->Use();
+    skinned_shader_->SetMat4("projection", projection);
+    skinned_shader_->SetMat4("view", view);
+    for (std::size_t i = 0; i < skinned_meshes_.size(); ++i) {
+      skinned_shader_->Use();
+      skinned_shader_->SetMat4("model", instances_[i].GetTransform());
+      for (auto& posed : skinned_meshes_[i]) {
+        posed->Draw(*skinned_shader_);
+      }
+    }
+  } else {
+    shader_->Use();
+    shader_->SetMat4("projection", projection);
+    shader_->SetMat4("view", view);
+    bone_palettes_.Bind(*shader_);
+    morph_weights_.Bind(*shader_);
 
-  auto projection = camera_.GetProjectionMatrix(GetWidth(), GetHeight());
-  auto view = camera_.GetViewMatrix();
-  shader_->SetMat4("projection", projection);
-  shader_->SetMat4("view", view);
-
-  auto trans_forms = animator_->GetFinalBoneMatrices();
-  for (int i = 0; i < trans_forms.size(); ++i) {
-    shader_->SetMat4("final_bones_matrices[" + std::to_string(i) + "]",
-                     trans_forms[i]);
+    for (auto& instance : instances_) {
+      instance.Draw(*shader_, projection * view);
+    }
+    shader_->UnUse();
   }
 
-  auto model = glm::mat4(1.0f);
-  model = glm::translate(model, glm::vec3(0.0f, -0.4f, 0.0f));
-  model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
-  shader_->SetMat4("model", model);
-
-  model_->Draw(*shader_);
-  shader_->UnUse();
+  baked_shader_->Use();
+  baked_shader_->SetMat4("projection", projection);
+  baked_shader_->SetMat4("view", view);
+  baked_shader_->SetFloat("time", current_time);
+  baked_animation_->Bind(*baked_shader_);
+  crowd_model_->DrawInstanced(*baked_shader_, crowd_instances_,
+                              crowd_instances_.GetCount());
 
   cube_map_shader_->Use();
   cube_map_shader_->SetMat4("projection", projection);
   cube_map_shader_->SetMat4("view", view);
-  model = glm::mat4(1.0f);
+  auto model = glm::mat4(1.0f);
   model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
   cube_map_shader_->SetMat4("model", model);
   cube_map_vao_.Bind();
@@ -163,7 +282,8 @@ void SkeletalAnimation::ProcessInput(GLFWwindow* window) {
 }
 SkeletalAnimation::SkeletalAnimation(int width, int height, const char* title,
                                      GLFWmonitor* monitor, GLFWwindow* share)
-    : OpenGLWindow(width, height, title, monitor, share) {
+    : OpenGLWindow(width, height, title, monitor, share),
+      bone_palettes_(kPaletteFormat) {
   glfwSetWindowUserPointer(window_, this);
   glfwSetCursorPosCallback(window_, mouse_callback);
   glfwSetScrollCallback(window_, scroll_callback);
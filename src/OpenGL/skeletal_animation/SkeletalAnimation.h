@@ -20,8 +20,16 @@
 #include "Buffers.h"
 #include "Camera.h"
 #include "Experimental/SkyBox.h"
-#include "Model/Animator.h"
-#include "Model/Model.h"
+#include <memory>
+#include <vector>
+
+#include "Model/BakedAnimation.h"
+#include "Model/BonePaletteBuffer.h"
+#include "Model/InstanceBuffer.h"
+#include "Model/ModelInstance.h"
+#include "Model/MorphWeightBuffer.h"
+#include "Model/SkinnedMesh.h"
+#include "Model/SkinningPass.h"
 #include "OpenGLWindow.h"
 #include "Shader.h"
 #include "VertexArray.h"
@@ -47,9 +55,31 @@ class SkeletalAnimation : public OpenGLWindow {
  private:
   static Camera camera_;
   Shader *shader_, *cube_map_shader_;
-  model::Model* model_;
-  model::Animator* animator_;
-  model::Animation* animation_;
+  // Several dancers sharing one imported model and animation.
+  std::vector<model::ModelInstance> instances_;
+  // The layout of the bone palettes, 3x4 matrices take a quarter less
+  // bandwidth than mat4 and keep the scale dual quaternions drop.
+  static constexpr model::PaletteFormat kPaletteFormat =
+      model::PaletteFormat::kMatrix3x4;
+  // The poses of all dancers, uploaded with one buffer write per frame.
+  model::BonePaletteBuffer bone_palettes_;
+  std::vector<model::Animator*> animators_;
+  // Picks each dancer's animation level of detail from its distance.
+  model::AnimationLodPolicy animation_lod_;
+  // The blend shape weights of all dancers whose model has morph targets.
+  model::MorphWeightBuffer morph_weights_;
+  // Skins every dancer once per frame when compute shaders are available;
+  // the posed meshes are then drawn with a plain static shader.
+  model::SkinningPass skinning_;
+  Shader* skinned_shader_;
+  // The posed meshes of every dancer, in the order of instances_.
+  std::vector<std::vector<std::unique_ptr<model::SkinnedMesh>>> skinned_meshes_;
+  // A crowd playing the baked clip, one instanced draw per mesh and no
+  // animation work on the CPU.
+  Shader* baked_shader_;
+  std::shared_ptr<model::Model> crowd_model_;
+  std::unique_ptr<model::BakedAnimation> baked_animation_;
+  model::InstanceBuffer crowd_instances_;
   GLuint cube_map_texture_, sky_box_texture_;
   VertexArray sky_box_vao_, cube_map_vao_;
   Buffers sky_box_vbo_, cube_map_vbo_;
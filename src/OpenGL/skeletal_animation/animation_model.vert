@@ -12,27 +12,59 @@ uniform mat4 projection;
 uniform mat4 view;
 uniform mat4 model;
 
-const int kMaxBones = 100;
 const int kMaxBoneInfluence = 4;
-uniform mat4 final_bones_matrices[kMaxBones];
+// The bone matrices of all characters, four texels per matrix.
+uniform samplerBuffer bone_palette;
+// The first matrix of this character in bone_palette.
+uniform int bone_offset;
+
+// Sparse blend shape deltas of the drawn mesh, see MorphTargets.
+uniform bool morph_enabled;
+uniform usamplerBuffer morph_rows;
+uniform isamplerBuffer morph_deltas;
+uniform float morph_position_scale;
+// The blend shape weights of all characters.
+uniform samplerBuffer morph_weights;
+// The first weight of this character in morph_weights.
+uniform int morph_weight_offset;
 
 out vec2 tex_coords;
 
+// Adds the weighted deltas of the targets that move this vertex.
+vec3 GetMorphedPosition() {
+  vec3 morphed = position;
+  if (!morph_enabled) {
+    return morphed;
+  }
+  int first = int(texelFetch(morph_rows, gl_VertexID).r);
+  int last = int(texelFetch(morph_rows, gl_VertexID + 1).r);
+  for (int entry = first; entry < last; entry++) {
+    ivec4 delta = texelFetch(morph_deltas, entry * 2);
+    float weight = texelFetch(morph_weights, morph_weight_offset + delta.w).r;
+    morphed += vec3(delta.xyz) * (weight * morph_position_scale);
+  }
+  return morphed;
+}
+
+mat4 GetBoneMatrix(int bone) {
+  int texel = (bone_offset + bone) * 4;
+  return mat4(texelFetch(bone_palette, texel),
+              texelFetch(bone_palette, texel + 1),
+              texelFetch(bone_palette, texel + 2),
+              texelFetch(bone_palette, texel + 3));
+}
+
 void main() {
+  vec3 morphed_position = GetMorphedPosition();
   vec4 total_position = vec4(0.0f);
   for (int i = 0; i < kMaxBoneInfluence; i++)
   {
 	if (bone_ids[i] == -1)
 	continue;
-	if (bone_ids[i] >= kMaxBones)
-	{
-	  total_position = vec4(position, 1.0f);
-	  break;
-	}
 
-	vec4 local_position = final_bones_matrices[bone_ids[i]] * vec4(position, 1.0f);
+	vec4 local_position =
+	    GetBoneMatrix(bone_ids[i]) * vec4(morphed_position, 1.0f);
 	total_position += local_position * weights[i];
-	vec3 local_normal = mat3(final_bones_matrices[bone_ids[i]]) * normal;
   }
 
   mat4 view_model = view * model;
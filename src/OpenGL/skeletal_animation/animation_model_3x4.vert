@@ -0,0 +1,74 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 textures;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 bitangent;
+layout (location = 5) in ivec4 bone_ids;
+layout (location = 6) in vec4 weights;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+const int kMaxBoneInfluence = 4;
+// The bone matrices of all characters, the top three rows of each affine
+// matrix in three texels.
+uniform samplerBuffer bone_palette;
+// The first bone of this character in bone_palette.
+uniform int bone_offset;
+
+// Sparse blend shape deltas of the drawn mesh, see MorphTargets.
+uniform bool morph_enabled;
+uniform usamplerBuffer morph_rows;
+uniform isamplerBuffer morph_deltas;
+uniform float morph_position_scale;
+// The blend shape weights of all characters.
+uniform samplerBuffer morph_weights;
+// The first weight of this character in morph_weights.
+uniform int morph_weight_offset;
+
+out vec2 tex_coords;
+
+// Adds the weighted deltas of the targets that move this vertex.
+vec3 GetMorphedPosition() {
+  vec3 morphed = position;
+  if (!morph_enabled) {
+    return morphed;
+  }
+  int first = int(texelFetch(morph_rows, gl_VertexID).r);
+  int last = int(texelFetch(morph_rows, gl_VertexID + 1).r);
+  for (int entry = first; entry < last; entry++) {
+    ivec4 delta = texelFetch(morph_deltas, entry * 2);
+    float weight = texelFetch(morph_weights, morph_weight_offset + delta.w).r;
+    morphed += vec3(delta.xyz) * (weight * morph_position_scale);
+  }
+  return morphed;
+}
+
+void main() {
+  // Blends the rows of the influencing bones, then transforms once.
+  vec4 row0 = vec4(0.0f);
+  vec4 row1 = vec4(0.0f);
+  vec4 row2 = vec4(0.0f);
+  for (int i = 0; i < kMaxBoneInfluence; i++)
+  {
+	if (bone_ids[i] == -1)
+	continue;
+
+	int texel = (bone_offset + bone_ids[i]) * 3;
+	row0 += texelFetch(bone_palette, texel) * weights[i];
+	row1 += texelFetch(bone_palette, texel + 1) * weights[i];
+	row2 += texelFetch(bone_palette, texel + 2) * weights[i];
+  }
+
+  vec4 local_position = vec4(GetMorphedPosition(), 1.0f);
+  vec4 total_position = vec4(dot(row0, local_position),
+                             dot(row1, local_position),
+                             dot(row2, local_position), 1.0f);
+
+  mat4 view_model = view * model;
+  gl_Position = projection * view_model * total_position;
+  tex_coords = textures;
+}
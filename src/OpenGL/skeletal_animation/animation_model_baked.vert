@@ -0,0 +1,62 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 textures;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 bitangent;
+layout (location = 5) in ivec4 bone_ids;
+layout (location = 6) in vec4 weights;
+layout (location = 7) in mat4 instance_matrix;
+// x: time offset in seconds, y: playback speed.
+layout (location = 11) in vec4 instance_animation;
+
+uniform mat4 projection;
+uniform mat4 view;
+// Seconds since the crowd started playing.
+uniform float time;
+
+const int kMaxBoneInfluence = 4;
+// One row per frame, the top three rows of each bone matrix in three texels.
+uniform sampler2D baked_palette;
+uniform int baked_frame_count;
+uniform float baked_frame_rate;
+
+out vec2 tex_coords;
+
+void main() {
+  // The two frames around this instance's time, wrapping at the loop end.
+  float frame = (time * instance_animation.y + instance_animation.x) *
+                baked_frame_rate;
+  frame = mod(frame, float(baked_frame_count));
+  int current_frame = int(frame);
+  int next_frame = current_frame + 1 == baked_frame_count ? 0 : current_frame + 1;
+  float blend = fract(frame);
+
+  vec4 row0 = vec4(0.0f);
+  vec4 row1 = vec4(0.0f);
+  vec4 row2 = vec4(0.0f);
+  for (int i = 0; i < kMaxBoneInfluence; i++)
+  {
+	if (bone_ids[i] == -1)
+	continue;
+
+	int texel = bone_ids[i] * 3;
+	float current_weight = weights[i] * (1.0f - blend);
+	float next_weight = weights[i] * blend;
+	row0 += texelFetch(baked_palette, ivec2(texel, current_frame), 0) * current_weight +
+	        texelFetch(baked_palette, ivec2(texel, next_frame), 0) * next_weight;
+	row1 += texelFetch(baked_palette, ivec2(texel + 1, current_frame), 0) * current_weight +
+	        texelFetch(baked_palette, ivec2(texel + 1, next_frame), 0) * next_weight;
+	row2 += texelFetch(baked_palette, ivec2(texel + 2, current_frame), 0) * current_weight +
+	        texelFetch(baked_palette, ivec2(texel + 2, next_frame), 0) * next_weight;
+  }
+
+  vec4 local_position = vec4(position, 1.0f);
+  vec4 total_position = vec4(dot(row0, local_position),
+                             dot(row1, local_position),
+                             dot(row2, local_position), 1.0f);
+
+  gl_Position = projection * view * instance_matrix * total_position;
+  tex_coords = textures;
+}
@@ -0,0 +1,93 @@
+#version 330 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 textures;
+layout (location = 3) in vec3 tangent;
+layout (location = 4) in vec3 bitangent;
+layout (location = 5) in ivec4 bone_ids;
+layout (location = 6) in vec4 weights;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+const int kMaxBoneInfluence = 4;
+// The bone transforms of all characters, one unit dual quaternion in two
+// texels: the rotation, then the translation part.
+uniform samplerBuffer bone_palette;
+// The first bone of this character in bone_palette.
+uniform int bone_offset;
+
+// Sparse blend shape deltas of the drawn mesh, see MorphTargets.
+uniform bool morph_enabled;
+uniform usamplerBuffer morph_rows;
+uniform isamplerBuffer morph_deltas;
+uniform float morph_position_scale;
+// The blend shape weights of all characters.
+uniform samplerBuffer morph_weights;
+// The first weight of this character in morph_weights.
+uniform int morph_weight_offset;
+
+out vec2 tex_coords;
+
+// Adds the weighted deltas of the targets that move this vertex.
+vec3 GetMorphedPosition() {
+  vec3 morphed = position;
+  if (!morph_enabled) {
+    return morphed;
+  }
+  int first = int(texelFetch(morph_rows, gl_VertexID).r);
+  int last = int(texelFetch(morph_rows, gl_VertexID + 1).r);
+  for (int entry = first; entry < last; entry++) {
+    ivec4 delta = texelFetch(morph_deltas, entry * 2);
+    float weight = texelFetch(morph_weights, morph_weight_offset + delta.w).r;
+    morphed += vec3(delta.xyz) * (weight * morph_position_scale);
+  }
+  return morphed;
+}
+
+void main() {
+  // Dual quaternion linear blending, which does not collapse twisting joints
+  // like blended matrices do.
+  vec4 real = vec4(0.0f);
+  vec4 dual = vec4(0.0f);
+  vec4 first_real = vec4(0.0f);
+  bool first = true;
+  for (int i = 0; i < kMaxBoneInfluence; i++)
+  {
+	if (bone_ids[i] == -1)
+	continue;
+
+	int texel = (bone_offset + bone_ids[i]) * 2;
+	vec4 bone_real = texelFetch(bone_palette, texel);
+	vec4 bone_dual = texelFetch(bone_palette, texel + 1);
+	if (first) {
+	  first_real = bone_real;
+	  first = false;
+	}
+	// q and -q are the same rotation, blend along the shorter arc.
+	float weight = dot(first_real, bone_real) < 0.0f ? -weights[i] : weights[i];
+	real += bone_real * weight;
+	dual += bone_dual * weight;
+  }
+
+  // A vertex without bones stays where it is.
+  if (first) {
+    real = vec4(0.0f, 0.0f, 0.0f, 1.0f);
+  }
+  float norm = length(real);
+  real /= norm;
+  dual /= norm;
+  vec3 translation = 2.0f * (real.w * dual.xyz - dual.w * real.xyz +
+                             cross(real.xyz, dual.xyz));
+  vec3 morphed_position = GetMorphedPosition();
+  vec3 rotated = morphed_position +
+                 2.0f * cross(real.xyz, cross(real.xyz, morphed_position) +
+                              real.w * morphed_position);
+  vec4 total_position = vec4(rotated + translation, 1.0f);
+
+  mat4 view_model = view * model;
+  gl_Position = projection * view_model * total_position;
+  tex_coords = textures;
+}
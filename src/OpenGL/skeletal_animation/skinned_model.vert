@@ -0,0 +1,17 @@
+#version 330 core
+
+// Vertices posed by skinning.comp, drawn as static geometry.
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 textures;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+out vec2 tex_coords;
+
+void main() {
+  gl_Position = projection * view * model * vec4(position, 1.0f);
+  tex_coords = textures;
+}